@@ -26,6 +26,9 @@
 #include <boost/graph/transitive_reduction.hpp>
 #include <boost/graph/graph_utility.hpp>
 #include <boost/graph/graphviz.hpp>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
 
 #include "storage/Utils/Stopwatch.h"
 #include "storage/Utils/CallbacksImpl.h"
@@ -38,6 +41,7 @@
 #include "storage/Filesystems/BlkFilesystemImpl.h"
 #include "storage/Filesystems/BtrfsImpl.h"
 #include "storage/Filesystems/MountPointImpl.h"
+#include "storage/Filesystems/BtrfsSubvolumeImpl.h"
 #include "storage/Devicegraph.h"
 #include "storage/Utils/GraphUtils.h"
 #include "storage/Actiongraph.h"
@@ -54,7 +58,13 @@
 #include "storage/Actions/SetQuotaImpl.h"
 #include "storage/Actions/MountImpl.h"
 #include "storage/Actions/UnmountImpl.h"
+#include "storage/Actions/CreateImpl.h"
+#include "storage/Actions/DeleteImpl.h"
+#include "storage/Actions/SetNocowImpl.h"
 #include "storage/EnvironmentImpl.h"
+#include "storage/Utils/WorkerPool.h"
+#include "storage/Utils/Remote.h"
+#include "storage/Utils/Udev.h"
 
 
 namespace storage
@@ -114,6 +124,31 @@ namespace storage
     }
 
 
+    string
+    CommitData::get_btrfs_mount_point(const BtrfsSubvolume* top_level)
+    {
+	if (!btrfs_mount || btrfs_mount_sid != top_level->get_sid())
+	{
+	    release_btrfs_mount();
+
+	    btrfs_mount = make_unique<EnsureMounted>(top_level, false);
+	    btrfs_mount_sid = top_level->get_sid();
+	    btrfs_mount_point = btrfs_mount->get_any_mount_point();
+	}
+
+	return btrfs_mount_point;
+    }
+
+
+    void
+    CommitData::release_btrfs_mount()
+    {
+	btrfs_mount.reset();
+	btrfs_mount_sid = 0;
+	btrfs_mount_point.clear();
+    }
+
+
     class CheckCallbacksLogger : public CheckCallbacks
     {
     public:
@@ -243,7 +278,21 @@ namespace storage
     Actiongraph::Impl::vertex_descriptor
     Actiongraph::Impl::add_vertex(const shared_ptr<Action::Base>& action)
     {
-	return boost::add_vertex(action, graph);
+	vertex_descriptor vertex = boost::add_vertex(graph_t::vertex_property_type(0, action), graph);
+
+	dense_vertex_index.add(graph, vertex);
+
+	return vertex;
+    }
+
+
+    void
+    Actiongraph::Impl::remove_vertex(vertex_descriptor vertex)
+    {
+	dense_vertex_index.remove(graph, vertex);
+
+	boost::clear_vertex(vertex, graph);
+	boost::remove_vertex(vertex, graph);
     }
 
 
@@ -294,26 +343,27 @@ namespace storage
     void
     Actiongraph::Impl::add_chain(const vector<vector<vertex_descriptor>>& vert_vectors)
     {
-	vector<vector<vertex_descriptor>> non_empty_vectors;
-
-	for (const vector<vertex_descriptor>& vector : vert_vectors)
-	    if (!vector.empty())
-		non_empty_vectors.push_back(vector);
-
-	if (non_empty_vectors.size() > 1)
-	    for (size_t i = 1; i < non_empty_vectors.size(); ++i)
-		// As an alternative implementation, we could add sync actions
-		// here instead of creating all the edges right away
-		for (vertex_descriptor left : non_empty_vectors[i - 1])
-		    for (vertex_descriptor right : non_empty_vectors[i])
+	const vector<vertex_descriptor>* previous = nullptr;
+
+	for (const vector<vertex_descriptor>& current : vert_vectors)
+	{
+	    if (current.empty())
+		continue;
+
+	    if (previous)
+		for (vertex_descriptor left : *previous)
+		    for (vertex_descriptor right : current)
 			add_edge(left, right);
+
+	    previous = &current;
+	}
     }
 
 
     const vector<Actiongraph::Impl::vertex_descriptor>&
     Actiongraph::Impl::actions_with_sid(sid_t sid) const
     {
-	map<sid_t, vector<vertex_descriptor>>::const_iterator it = cache_for_actions_with_sid.find(sid);
+	std::unordered_map<sid_t, vector<vertex_descriptor>>::const_iterator it = cache_for_actions_with_sid.find(sid);
 	if (it != cache_for_actions_with_sid.end())
 	    return it->second;
 
@@ -495,25 +545,31 @@ namespace storage
     void
     Actiongraph::Impl::remove_duplicates()
     {
-	vector<pair<vertex_descriptor, vertex_descriptor>> duplicates;
+	// The first mount and unmount action for every sid is kept and later
+	// duplicates are merged into it.
 
-	boost::iterator_range<vertex_iterator> range = vertices();
+	std::unordered_map<sid_t, vertex_descriptor> first_mounts;
+	std::unordered_map<sid_t, vertex_descriptor> first_unmounts;
 
-	for (vertex_iterator it1 = range.begin(); it1 != range.end(); ++it1)
+	vector<pair<vertex_descriptor, vertex_descriptor>> duplicates;
+
+	for (vertex_descriptor vertex : vertices())
 	{
-	    const Action::Base* action1 = graph[*it1].get();
+	    const Action::Base* action = graph[vertex].get();
 
-	    for (vertex_iterator it2 = next(it1); it2 != range.end(); ++it2)
-	    {
-		const Action::Base* action2 = graph[*it2].get();
+	    std::unordered_map<sid_t, vertex_descriptor>* firsts = nullptr;
 
-		if (action1->sid == action2->sid)
-		{
-		    if ((is_mount(action1) && is_mount(action2)) ||
-			(is_unmount(action1) && is_unmount(action2)))
-			duplicates.push_back(make_pair(*it1, *it2));
-		}
-	    }
+	    if (is_mount(action))
+		firsts = &first_mounts;
+	    else if (is_unmount(action))
+		firsts = &first_unmounts;
+	    else
+		continue;
+
+	    pair<std::unordered_map<sid_t, vertex_descriptor>::iterator, bool> tmp =
+		firsts->emplace(action->sid, vertex);
+	    if (!tmp.second)
+		duplicates.push_back(make_pair(tmp.first->second, vertex));
 	}
 
 	for (pair<vertex_descriptor, vertex_descriptor> duplicate : duplicates)
@@ -524,8 +580,7 @@ namespace storage
 	    for (vertex_descriptor child : children(duplicate.second))
 		add_edge(duplicate.first, child);
 
-	    clear_vertex(duplicate.second, graph);
-	    remove_vertex(duplicate.second, graph);
+	    remove_vertex(duplicate.second);
 	}
     }
 
@@ -545,8 +600,16 @@ namespace storage
 		cache_for_actions_with_sid[action->sid].push_back(*it);
 
 	    const Action::Mount* mount = dynamic_cast<const Action::Mount*>(action);
-	    if (mount && mount->get_path(*this) == "/")
-		mount_root_filesystem = it;
+	    if (mount)
+	    {
+		mount_actions.push_back(*it);
+
+		if (mount->get_path(*this) == "/")
+		    mount_root_filesystem = it;
+	    }
+
+	    if (is_unmount(action))
+		unmount_actions.push_back(*it);
 
 	    const Action::SetQuota* set_quota_action = dynamic_cast<const Action::SetQuota*>(action);
 	    if (set_quota_action)
@@ -619,16 +682,17 @@ namespace storage
     {
 	mount_map_t mounts, unmounts;
 
-	for (vertex_descriptor vertex : vertices())
+	for (vertex_descriptor vertex : mount_actions)
 	{
-	    const Action::Base* action = graph[vertex].get();
-
-	    const Action::Mount* mount = dynamic_cast<const Action::Mount*>(action);
-	    if (mount && mount->get_fs_type(*this) != FsType::SWAP)
+	    const Action::Mount* mount = static_cast<const Action::Mount*>(graph[vertex].get());
+	    if (mount->get_fs_type(*this) != FsType::SWAP)
 		mounts[mount->get_rootprefixed_path(*this)] = vertex;
+	}
 
-	    const Action::Unmount* unmount = dynamic_cast<const Action::Unmount*>(action);
-	    if (unmount && unmount->get_fs_type(*this) != FsType::SWAP)
+	for (vertex_descriptor vertex : unmount_actions)
+	{
+	    const Action::Unmount* unmount = static_cast<const Action::Unmount*>(graph[vertex].get());
+	    if (unmount->get_fs_type(*this) != FsType::SWAP)
 		unmounts[unmount->get_rootprefixed_path(*this)] = vertex;
 	}
 
@@ -661,11 +725,9 @@ namespace storage
 	// TODO Equivalent for all actions that use/unuse a partition. Or find
 	// a better solution.
 
-	for (vertex_descriptor vertex : vertices())
+	for (vertex_descriptor vertex : mount_actions)
 	{
-	    const Action::Mount* mount = dynamic_cast<const Action::Mount*>(graph[vertex].get());
-	    if (!mount)
-		continue;
+	    const Action::Mount* mount = static_cast<const Action::Mount*>(graph[vertex].get());
 
 	    const MountPoint* mount_point = mount->get_mount_point(*this);
 	    if (!mount_point->has_mountable())
@@ -719,8 +781,7 @@ namespace storage
 		for (vertex_descriptor child : children(vertex))
 		    add_edge(parent, child);
 
-	    clear_vertex(vertex, graph);
-	    remove_vertex(vertex, graph);
+	    remove_vertex(vertex);
 	}
     }
 
@@ -728,6 +789,11 @@ namespace storage
     void
     Actiongraph::Impl::set_priorities()
     {
+	// Swap mount actions get priority 2 and all actions they depend on
+	// priority 1. Each action is visited at most once.
+
+	vector<vertex_descriptor> todo;
+
 	for (const vertex_descriptor v : vertices())
 	{
 	    Action::Base* action = graph[v].get();
@@ -736,23 +802,24 @@ namespace storage
 	    if (mount && mount->get_fs_type(*this) == FsType::SWAP)
 	    {
 		mount->priority = 2;
-		set_priorities_upward(v);
+		todo.push_back(v);
 	    }
 	}
-    }
 
-
-    void
-    Actiongraph::Impl::set_priorities_upward(vertex_descriptor v1)
-    {
-	for (const vertex_descriptor v2 : parents(v1))
+	while (!todo.empty())
 	{
-	    Action::Base* action = graph[v2].get();
+	    const vertex_descriptor v1 = todo.back();
+	    todo.pop_back();
 
-	    if (action->priority < 1)
+	    for (const vertex_descriptor v2 : parents(v1))
 	    {
-		action->priority = 1;
-		set_priorities_upward(v2);
+		Action::Base* action = graph[v2].get();
+
+		if (action->priority < 1)
+		{
+		    action->priority = 1;
+		    todo.push_back(v2);
+		}
 	    }
 	}
     }
@@ -761,16 +828,13 @@ namespace storage
     void
     Actiongraph::Impl::calculate_order()
     {
-	VertexIndexMapGenerator<graph_t> vertex_index_map_generator(graph);
-
 	switch (topological_sort_method())
 	{
 	    case 0:
 	    {
 		try
 		{
-		    boost::topological_sort(graph, front_inserter(order),
-					    vertex_index_map(vertex_index_map_generator.get()));
+		    boost::topological_sort(graph, front_inserter(order));
 		}
 		catch (const boost::not_a_dag&)
 		{
@@ -781,7 +845,7 @@ namespace storage
 
 	    case 1:
 	    {
-		order = prioritised_topological_sort(vertex_index_map_generator.get());
+		order = prioritised_topological_sort();
 	    }
 	    break;
 
@@ -795,6 +859,8 @@ namespace storage
     Actiongraph::Impl::check_taboos()
     {
 	const set<sid_t> taboos = get_storage().get_impl().get_taboos();
+	if (taboos.empty())
+	    return;
 
 	for (vertex_descriptor vertex : vertices())
 	{
@@ -817,59 +883,47 @@ namespace storage
     }
 
 
-    class Actiongraph::Impl::CompareByPriority
-    {
-    public:
-
-	CompareByPriority(const graph_t& graph) : graph(graph) {}
-
-	bool operator()(const vertex_descriptor lhs, const vertex_descriptor rhs) const
-	{
-	    return graph[lhs].get()->priority < graph[rhs].get()->priority;
-	}
-
-    private:
-
-	const graph_t& graph;
-
-    };
-
-
     Actiongraph::Impl::Order
-    Actiongraph::Impl::prioritised_topological_sort(const boost::associative_property_map<vertex_index_map_t>& idx) const
+    Actiongraph::Impl::prioritised_topological_sort() const
     {
 	// Based on Kahn's algorithm.
 
+	const boost::property_map<graph_t, boost::vertex_index_t>::const_type idx =
+	    boost::get(boost::vertex_index, graph);
+
 	vector<degree_size_type> in_degrees(num_actions());
 
-	// We use vector/deque instead of the obvious priority_queue since we have a few
-	// points below where we can tweak the result (to look more like the plain
-	// topological sort).
-	vector<vertex_descriptor> q;
+	// The actions ready to be committed are kept in one stack per
+	// priority. The next action is the one added last with the highest
+	// priority. This is the same order as sorting all ready actions
+	// stably by priority and taking the last one but without sorting
+	// again for every action.
+	map<int, vector<vertex_descriptor>> q;
 
 	for (const vertex_descriptor v : vertices())
 	{
 	    if ((in_degrees[idx[v]] = boost::in_degree(v, graph)) == 0)
-		q.push_back(v);						// arbitrary: push_front or push_back
+		q[graph[v]->priority].push_back(v);
 	}
 
-	const CompareByPriority compare_by_priority(graph);
-
 	Order order;
 
 	while (!q.empty())
 	{
-	    stable_sort(q.begin(), q.end(), compare_by_priority);	// arbitrary: stable_sort or sort
+	    map<int, vector<vertex_descriptor>>::iterator highest = prev(q.end());
 
-	    const vertex_descriptor v = q.back();
-	    q.pop_back();
+	    const vertex_descriptor v = highest->second.back();
+	    highest->second.pop_back();
+
+	    if (highest->second.empty())
+		q.erase(highest);
 
 	    order.push_back(v);
 
 	    for (const vertex_descriptor v2 : children(v))
 	    {
 		if (--in_degrees[idx[v2]] == 0)
-		    q.push_back(v2);					// arbitrary: push_front or push_back
+		    q[graph[v2]->priority].push_back(v2);
 	    }
 	}
 
@@ -923,10 +977,51 @@ namespace storage
 
 	CommitData commit_data(*this, Tense::PRESENT_CONTINUOUS);
 
+	// Subscribe to the uevents once for the whole commit so that the
+	// actions only wait for the events of the devices they touch.
+
+	unique_ptr<UdevMonitor> monitor;
+
+	if (udev_monitor() && native_access_possible())
+	{
+	    try
+	    {
+		monitor = make_unique<UdevMonitor>();
+	    }
+	    catch (const Exception& exception)
+	    {
+		ST_CAUGHT(exception);
+	    }
+	}
+
+	const int max_threads = commit_threads();
+
+	if (max_threads > 1 && !get_remote_callbacks())
+	    commit_parallel(commit_data, commit_options, commit_callbacks, max_threads);
+	else
+	    commit_sequential(commit_data, commit_options, commit_callbacks);
+
+	y2mil("commit end");
+    }
+
+
+    void
+    Actiongraph::Impl::commit_sequential(CommitData& commit_data, const CommitOptions& commit_options,
+					 const CommitCallbacks* commit_callbacks) const
+    {
+	// Consecutive actions creating btrfs subvolumes or setting their nocow
+	// attribute use one mount of the top-level subvolume. Any other action
+	// releases the mount since it may e.g. unmount or resize the btrfs.
+
+	commit_data.keep_btrfs_mount = btrfs_ioctl() && native_access_possible();
+
 	for (const vertex_descriptor vertex : order)
 	{
 	    const Action::Base* action = graph[vertex].get();
 
+	    if (commit_data.keep_btrfs_mount && !is_btrfs_subvolume_action(action))
+		commit_data.release_btrfs_mount();
+
 	    ActionCallbacksGuard action_callbacks_guard(commit_callbacks, action);
 
 	    Text text = action->text(commit_data);
@@ -950,7 +1045,287 @@ namespace storage
 	    }
 	}
 
-	y2mil("commit end");
+	commit_data.release_btrfs_mount();
+    }
+
+
+    bool
+    Actiongraph::Impl::is_btrfs_subvolume_action(const Action::Base* action) const
+    {
+	if (!action->affects_device())
+	    return false;
+
+	const Device* device = nullptr;
+
+	if (is_action_of_type<const Action::Create>(action))
+	    device = dynamic_cast<const Action::Create*>(action)->get_device(*this);
+	else if (is_action_of_type<const Action::SetNocow>(action))
+	    device = dynamic_cast<const Action::SetNocow*>(action)->get_device(*this, RHS);
+	else
+	    return false;
+
+	return is_btrfs_subvolume(device);
+    }
+
+
+    bool
+    Actiongraph::Impl::is_concurrent(const Action::Base* action) const
+    {
+	// Only actions creating or deleting a block device, a partition table or
+	// a block filesystem are known not to use global state, e.g. the
+	// /etc/fstab in the commit data or the mount points.
+
+	if (!action->affects_device())
+	    return false;
+
+	const Device* device = nullptr;
+
+	if (is_action_of_type<const Action::Create>(action))
+	    device = dynamic_cast<const Action::Create*>(action)->get_device(*this);
+	else if (is_action_of_type<const Action::Delete>(action))
+	    device = dynamic_cast<const Action::Delete*>(action)->get_device(*this);
+	else
+	    return false;
+
+	return is_blk_device(device) || is_partition_table(device) || is_blk_filesystem(device);
+    }
+
+
+    set<sid_t>
+    Actiongraph::Impl::exclusive_sids(const Action::Base* action) const
+    {
+	// An action on a device excludes other actions on the devices with the
+	// same roots, e.g. all actions on the partitions of a disk or on the
+	// logical volumes of a volume group are run one after another.
+
+	set<sid_t> ret;
+
+	vector<sid_t> sids;
+	if (action->affects_device())
+	    sids = { action->sid };
+	else
+	    sids = { action->sid_pair.first, action->sid_pair.second };
+
+	for (Side side : { LHS, RHS })
+	{
+	    const Devicegraph::Impl& devicegraph = get_devicegraph(side)->get_impl();
+
+	    for (sid_t sid : sids)
+	    {
+		if (!devicegraph.device_exists(sid))
+		    continue;
+
+		for (Devicegraph::Impl::vertex_descriptor root : devicegraph.roots(devicegraph.find_vertex(sid), true))
+		    ret.insert(devicegraph[root]->get_sid());
+	    }
+	}
+
+	return ret;
+    }
+
+
+    void
+    Actiongraph::Impl::commit_parallel(CommitData& commit_data, const CommitOptions& commit_options,
+				       const CommitCallbacks* commit_callbacks, int max_threads) const
+    {
+	// Actions are started as soon as all their parents have finished. Among
+	// the ready actions the one first in the order is started first.
+	// Actions that are not concurrent are only started when no other action
+	// is running and block other actions while running. Callbacks are never
+	// called concurrently. After an exception, e.g. when the user aborts in
+	// the error callback, no further actions are started and the exception
+	// is rethrown once all running actions have finished.
+
+	y2mil("parallel commit with " << max_threads << " threads");
+
+	// Making deferred copies reads the whole devicegraph, so make them
+	// before the actions can modify the devicegraphs concurrently.
+
+	lhs->get_impl().unshare();
+	rhs->get_impl().unshare();
+
+	const boost::property_map<graph_t, boost::vertex_index_t>::const_type idx =
+	    boost::get(boost::vertex_index, graph);
+
+	struct Info
+	{
+	    size_t position = 0;
+	    degree_size_type in_degree = 0;
+	    bool concurrent = false;
+	    set<sid_t> sids;
+	};
+
+	// Indexed by the vertex index.
+	vector<Info> infos(num_actions());
+
+	for (size_t i = 0; i < order.size(); ++i)
+	{
+	    const vertex_descriptor vertex = order[i];
+
+	    Info& info = infos[idx[vertex]];
+	    info.position = i;
+	    info.in_degree = boost::in_degree(vertex, graph);
+	    info.concurrent = is_concurrent(graph[vertex].get());
+	    if (info.concurrent)
+		info.sids = exclusive_sids(graph[vertex].get());
+	}
+
+	std::mutex mutex;
+	std::condition_variable condition;
+
+	// Protected by mutex. The ready actions are kept by their position in
+	// the order.
+	set<size_t> ready;
+	set<sid_t> busy_sids;
+	size_t running = 0;
+	bool exclusive_running = false;
+	std::exception_ptr exception_ptr;
+
+	// Serializes the callbacks.
+	std::mutex callbacks_mutex;
+
+	for (const Info& info : infos)
+	{
+	    if (info.in_degree == 0)
+		ready.insert(info.position);
+	}
+
+	auto startable = [&](size_t position) {
+	    const Info& info = infos[idx[order[position]]];
+
+	    if (!info.concurrent)
+		return running == 0;
+
+	    if (exclusive_running)
+		return false;
+
+	    for (sid_t sid : info.sids)
+		if (contains(busy_sids, sid))
+		    return false;
+
+	    return true;
+	};
+
+	auto run = [&](vertex_descriptor vertex) {
+	    const Action::Base* action = graph[vertex].get();
+
+	    unique_ptr<ActionCallbacksGuard> action_callbacks_guard;
+	    Text text;
+
+	    {
+		std::lock_guard<std::mutex> lock(callbacks_mutex);
+
+		action_callbacks_guard.reset(new ActionCallbacksGuard(commit_callbacks, action));
+
+		text = action->text(commit_data);
+
+		y2mil("Commit Action \"" << text.native << "\" [" << action->details() << "]");
+
+		message_callback(commit_callbacks, text);
+	    }
+
+	    try
+	    {
+		if (!action->nop)
+		{
+		    try
+		    {
+			action->commit(commit_data, commit_options);
+		    }
+		    catch (const Exception& exception)
+		    {
+			ST_CAUGHT(exception);
+
+			std::lock_guard<std::mutex> lock(callbacks_mutex);
+
+			error_callback(commit_callbacks, text, exception);
+		    }
+		}
+	    }
+	    catch (...)
+	    {
+		std::lock_guard<std::mutex> lock(callbacks_mutex);
+
+		action_callbacks_guard.reset();
+
+		throw;
+	    }
+
+	    std::lock_guard<std::mutex> lock(callbacks_mutex);
+
+	    action_callbacks_guard.reset();
+	};
+
+	auto worker = [&]() {
+	    std::unique_lock<std::mutex> lock(mutex);
+
+	    while (true)
+	    {
+		if (exception_ptr || ready.empty())
+		{
+		    if (running == 0)
+			break;
+
+		    condition.wait(lock);
+		    continue;
+		}
+
+		set<size_t>::const_iterator it = find_if(ready.begin(), ready.end(), startable);
+		if (it == ready.end())
+		{
+		    condition.wait(lock);
+		    continue;
+		}
+
+		const vertex_descriptor vertex = order[*it];
+		ready.erase(it);
+
+		const Info& info = infos[idx[vertex]];
+
+		++running;
+		if (!info.concurrent)
+		    exclusive_running = true;
+		busy_sids.insert(info.sids.begin(), info.sids.end());
+
+		lock.unlock();
+
+		std::exception_ptr tmp;
+
+		try
+		{
+		    run(vertex);
+		}
+		catch (...)
+		{
+		    tmp = std::current_exception();
+		}
+
+		lock.lock();
+
+		--running;
+		if (!info.concurrent)
+		    exclusive_running = false;
+		for (sid_t sid : info.sids)
+		    busy_sids.erase(sid);
+
+		if (tmp && !exception_ptr)
+		    exception_ptr = tmp;
+
+		for (const vertex_descriptor child : children(vertex))
+		{
+		    Info& child_info = infos[idx[child]];
+		    if (--child_info.in_degree == 0)
+			ready.insert(child_info.position);
+		}
+
+		condition.notify_all();
+	    }
+	};
+
+	run_in_worker_pool(vector<std::function<void()>>(max_threads, worker), max_threads);
+
+	if (exception_ptr)
+	    std::rethrow_exception(exception_ptr);
     }
 
 
@@ -1035,13 +1410,10 @@ namespace storage
 
 	fout << "// " << generated_string() << "\n\n";
 
-	VertexIndexMapGenerator<graph_t> vertex_index_map_generator(graph);
-
 	const CommitData commit_data(*this, Tense::SIMPLE_PRESENT);
 
 	const ActiongraphWriter actiongraph_writer(style_callbacks, commit_data);
-	boost::write_graphviz(fout, graph, actiongraph_writer, actiongraph_writer, actiongraph_writer,
-			      vertex_index_map_generator.get());
+	boost::write_graphviz(fout, graph, actiongraph_writer, actiongraph_writer, actiongraph_writer);
 
 	fout.close();
 
@@ -27,6 +27,7 @@
 
 #include <deque>
 #include <map>
+#include <unordered_map>
 #include <memory>
 #include <boost/noncopyable.hpp>
 #include <boost/graph/adjacency_list.hpp>
@@ -35,6 +36,7 @@
 #include "storage/Actiongraph.h"
 #include "storage/Utils/Text.h"
 #include "storage/CommitOptions.h"
+#include "storage/Utils/GraphUtils.h"
 
 
 namespace storage
@@ -51,6 +53,8 @@ namespace storage
     class EtcFstab;
     class EtcCrypttab;
     class EtcMdadm;
+    class EnsureMounted;
+    class BtrfsSubvolume;
 
 
     namespace Action
@@ -82,12 +86,31 @@ namespace storage
 	EtcCrypttab& get_etc_crypttab();
 	EtcMdadm& get_etc_mdadm();
 
+	/**
+	 * Whether consecutive actions on btrfs subvolumes share one mount of
+	 * the top-level subvolume, see get_btrfs_mount_point().
+	 */
+	bool keep_btrfs_mount = false;
+
+	/**
+	 * Returns a mount point of the top-level subvolume. A required
+	 * temporary mount is kept until release_btrfs_mount() is called or
+	 * the mount point of another top-level subvolume is requested.
+	 */
+	string get_btrfs_mount_point(const BtrfsSubvolume* top_level);
+
+	void release_btrfs_mount();
+
     private:
 
 	std::unique_ptr<EtcFstab> etc_fstab;
 	std::unique_ptr<EtcCrypttab> etc_crypttab;
 	std::unique_ptr<EtcMdadm> etc_mdadm;
 
+	std::unique_ptr<EnsureMounted> btrfs_mount;
+	sid_t btrfs_mount_sid = 0;
+	string btrfs_mount_point;
+
     };
 
 
@@ -96,8 +119,11 @@ namespace storage
 
     private:
 
+	// The interior vertex_index property is maintained by dense_vertex_index.
+
 	typedef boost::adjacency_list<boost::vecS, boost::listS, boost::bidirectionalS,
-				      std::shared_ptr<Action::Base>> graph_t;
+				      boost::property<boost::vertex_index_t, size_t,
+						      std::shared_ptr<Action::Base>>> graph_t;
 
     public:
 
@@ -113,8 +139,6 @@ namespace storage
 	typedef graph_t::vertices_size_type vertices_size_type;
 	typedef graph_t::degree_size_type degree_size_type;
 
-	typedef map<vertex_descriptor, vertices_size_type> vertex_index_map_t;
-
 	Impl(const Storage& storage, Devicegraph* lhs, Devicegraph* rhs);
 
 	const Storage& get_storage() const { return storage; }
@@ -153,9 +177,9 @@ namespace storage
 	 * actions in the given order. Thus, every action from the first vector
 	 * will have an edge to every action from the second vector and so on.
 	 *
-	 * By definition, the cost of this function is O(n^3). Although
-	 * creating edges is not an expensive operation, take that cost into
-	 * account when creating edges massively.
+	 * The cost is proportional to the number of added edges, i.e. the
+	 * sum of the products of the sizes of adjacent groups. Take that
+	 * into account when linking large groups.
 	 */
 	void add_chain(const vector<vector<vertex_descriptor>>& actions);
 
@@ -179,6 +203,23 @@ namespace storage
 	vector<const Action::Base*> get_commit_actions() const;
 	void commit(const CommitOptions& commit_options, const CommitCallbacks* commit_callbacks) const;
 
+	/**
+	 * Whether the action can be committed concurrently with other
+	 * actions.
+	 */
+	bool is_concurrent(const Action::Base* action) const;
+
+	/**
+	 * Sids used to prevent concurrent actions on the same device.
+	 */
+	set<sid_t> exclusive_sids(const Action::Base* action) const;
+
+	/**
+	 * Whether the action creates a btrfs subvolume or sets its nocow
+	 * attribute.
+	 */
+	bool is_btrfs_subvolume_action(const Action::Base* action) const;
+
 	void generate_compound_actions(const Actiongraph* actiongraph);
 	vector<const CompoundAction*> get_compound_actions() const;
 
@@ -205,10 +246,19 @@ namespace storage
 	void add_special_dasd_pt_dependencies();
 	void remove_only_syncs();
 	void set_priorities();
-	void set_priorities_upward(vertex_descriptor v1);
 	void calculate_order();
 	void check_taboos();
 
+	void commit_sequential(CommitData& commit_data, const CommitOptions& commit_options,
+			       const CommitCallbacks* commit_callbacks) const;
+
+	/**
+	 * Commit the actions on up to max_threads threads, see
+	 * commit_threads().
+	 */
+	void commit_parallel(CommitData& commit_data, const CommitOptions& commit_options,
+			     const CommitCallbacks* commit_callbacks, int max_threads) const;
+
 	const Storage& storage;
 
 	Devicegraph* lhs;
@@ -218,19 +268,25 @@ namespace storage
 
 	Order order;
 
-	class CompareByPriority;
-
-	Order prioritised_topological_sort(const boost::associative_property_map<vertex_index_map_t>& idx) const;
+	Order prioritised_topological_sort() const;
 
 	graph_t graph;
 
+	DenseVertexIndex<graph_t> dense_vertex_index;
+
+	void remove_vertex(vertex_descriptor vertex);
+
 	// map from path to mount/unmount action
 	using mount_map_t = map<string, vertex_descriptor>;
 
 	mount_map_t::const_iterator find_mount_parent(const mount_map_t& mount_map,
 						      mount_map_t::const_iterator child) const;
 
-	map<sid_t, vector<vertex_descriptor>> cache_for_actions_with_sid;
+	std::unordered_map<sid_t, vector<vertex_descriptor>> cache_for_actions_with_sid;
+
+	// all mount and unmount actions, set by set_special_actions()
+	vector<vertex_descriptor> mount_actions;
+	vector<vertex_descriptor> unmount_actions;
 
 	vector<shared_ptr<CompoundAction>> compound_actions;
 
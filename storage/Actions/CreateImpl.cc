@@ -24,6 +24,7 @@
 #include "storage/Actions/CreateImpl.h"
 #include "storage/Actions/Delete.h"
 #include "storage/Devices/DeviceImpl.h"
+#include "storage/Filesystems/BtrfsSubvolumeImpl.h"
 
 
 namespace storage
@@ -57,7 +58,11 @@ namespace storage
 		{
 		    Device* device = get_device(commit_data.actiongraph);
 
-		    device->get_impl().do_create();
+		    if (is_btrfs_subvolume(device))
+			to_btrfs_subvolume(device)->get_impl().do_create(commit_data);
+		    else
+			device->get_impl().do_create();
+
 		    device->get_impl().do_create_post_verify();
 		}
 		break;
@@ -42,7 +42,7 @@ namespace storage
 	SetNocow::commit(CommitData& commit_data, const CommitOptions& commit_options) const
 	{
 	    const BtrfsSubvolume* btrfs_subvolume = to_btrfs_subvolume(get_device(commit_data.actiongraph, RHS));
-	    btrfs_subvolume->get_impl().do_set_nocow();
+	    btrfs_subvolume->get_impl().do_set_nocow(commit_data);
 	}
 
 
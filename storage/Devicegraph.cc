@@ -122,7 +122,40 @@ namespace storage
     }
 
 
-    Devicegraph::~Devicegraph() = default;
+    Devicegraph::~Devicegraph()
+    {
+	impl->hand_over();
+	impl->detach();
+    }
+
+
+    Devicegraph::Impl&
+    Devicegraph::get_impl()
+    {
+	// Non-const access may modify the devicegraph, so the deferred copies
+	// of it must be made first.
+
+	if (impl->is_deferred())
+	    impl->materialize(*this);
+	else if (impl->is_shared())
+	    impl->unshare();
+
+	return *impl;
+    }
+
+
+    const Devicegraph::Impl&
+    Devicegraph::get_impl() const
+    {
+	// Devices and holders found through a devicegraph must belong to
+	// it, so even const access makes the deferred copy. That is
+	// serialized, so concurrent const access is fine.
+
+	if (impl->is_deferred())
+	    impl->materialize(const_cast<Devicegraph&>(*this));
+
+	return *impl;
+    }
 
 
     bool
@@ -170,7 +203,14 @@ namespace storage
     void
     Devicegraph::save(const string& filename) const
     {
-	get_impl().save(filename);
+	get_impl().save(filename, DevicegraphFormat::XML);
+    }
+
+
+    void
+    Devicegraph::save(const string& filename, DevicegraphFormat format) const
+    {
+	get_impl().save(filename, format);
     }
 
 
@@ -46,6 +46,20 @@ namespace storage
     class CheckCallbacks;
 
 
+    /**
+     * Enum with formats of devicegraph files.
+     */
+    enum class DevicegraphFormat {
+
+	/** XML, human readable. */
+	XML,
+
+	/** Compact binary format, faster to load. */
+	BINARY
+
+    };
+
+
     class DeviceNotFound : public Exception
     {
     public:
@@ -198,19 +212,27 @@ namespace storage
 	void load(const std::string& filename);
 
 	/**
-	 * Load the devicegraph from a file.
+	 * Load the devicegraph from a file. The format of the file is
+	 * detected.
 	 *
 	 * @throw Exception
 	 */
 	void load(const std::string& filename, bool keep_sids);
 
 	/**
-	 * Save the devicegraph to a file.
+	 * Save the devicegraph to a file in XML format.
 	 *
 	 * @throw Exception
 	 */
 	void save(const std::string& filename) const;
 
+	/**
+	 * Save the devicegraph to a file in the given format.
+	 *
+	 * @throw Exception
+	 */
+	void save(const std::string& filename, DevicegraphFormat format) const;
+
 	/**
 	 * Query whether the devicegraph is empty.
 	 */
@@ -430,8 +452,8 @@ namespace storage
 
 	class Impl;
 
-	Impl& get_impl() { return *impl; }
-	const Impl& get_impl() const { return *impl; }
+	Impl& get_impl();
+	const Impl& get_impl() const;
 
     private:
 
@@ -21,6 +21,7 @@
  */
 
 
+#include <algorithm>
 #include <boost/graph/copy.hpp>
 #include <boost/graph/reverse_graph.hpp>
 #include <boost/graph/graphviz.hpp>
@@ -29,6 +30,7 @@
 #include "storage/DevicegraphImpl.h"
 #include "storage/Utils/GraphUtils.h"
 #include "storage/Utils/XmlFile.h"
+#include "storage/Utils/BinaryXmlFile.h"
 #include "storage/Devices/DeviceImpl.h"
 #include "storage/Devices/Disk.h"
 #include "storage/Filesystems/Nfs.h"
@@ -172,14 +174,14 @@ namespace storage
 
 	public:
 
-	    CloneCopier(const Devicegraph::Impl& g_in, Devicegraph& g_out)
-		: g_in(g_in), g_out(g_out) {}
+	    CloneCopier(const Devicegraph::Impl& g_in, Devicegraph& g_out, Devicegraph::Impl& g_out_impl)
+		: g_in(g_in), g_out(g_out), g_out_impl(g_out_impl) {}
 
 	    void operator()(const Devicegraph::Impl::vertex_descriptor& v_in,
 			    Devicegraph::Impl::vertex_descriptor& v_out)
 	    {
 		shared_ptr<Device> device = g_in.graph[v_in]->clone_v2();
-		g_out.get_impl().graph[v_out] = device;
+		g_out_impl.graph[v_out] = device;
 		device->get_impl().set_devicegraph_and_vertex(&g_out, v_out);
 	    }
 
@@ -187,7 +189,7 @@ namespace storage
 			    Devicegraph::Impl::edge_descriptor& e_out)
 	    {
 		shared_ptr<Holder> holder = g_in.graph[e_in]->clone_v2();
-		g_out.get_impl().graph[e_out] = holder;
+		g_out_impl.graph[e_out] = holder;
 		holder->get_impl().set_devicegraph_and_edge(&g_out, e_out);
 	    }
 
@@ -195,24 +197,170 @@ namespace storage
 
 	    const Devicegraph::Impl& g_in;
 	    Devicegraph& g_out;
+	    Devicegraph::Impl& g_out_impl;
 
 	};
 
     }
 
 
+    std::recursive_mutex Devicegraph::Impl::share_mutex;
+
+
     void
     Devicegraph::Impl::copy(Devicegraph& dest) const
     {
-	dest.get_impl().clear();
+	std::lock_guard<std::recursive_mutex> lock(share_mutex);
+
+	// The source is never a deferred copy itself.
+
+	const Impl* tmp = shared_source;
+	const Impl& source = tmp ? *tmp : *this;
+
+	Impl& dest_impl = *dest.impl;
+
+	if (&dest_impl == &source || dest_impl.shared_source == &source)
+	    return;
+
+	// The previous content of dest is dropped so it must be handed over
+	// to the deferred copies of dest.
+
+	dest_impl.hand_over();
+	dest_impl.detach();
+	dest_impl.clear();
+
+	dest_impl.shared_source = &source;
+	source.shared_copies.push_back(&dest);
+	source.shared = true;
+    }
+
+
+    void
+    Devicegraph::Impl::copy_now(Devicegraph& dest) const
+    {
+	Impl& dest_impl = *dest.impl;
+
+	dest_impl.clear();
+
+	CloneCopier copier(*this, dest, dest_impl);
+
+	boost::copy_graph(graph, dest_impl.graph, boost::vertex_copy(copier).edge_copy(copier));
+
+	dest_impl.rebuild_indexes();
+    }
+
+
+    void
+    Devicegraph::Impl::materialize(Devicegraph& self)
+    {
+	std::lock_guard<std::recursive_mutex> lock(share_mutex);
+
+	// Setting the back references of the clones accesses self, which
+	// must not start over.
+
+	if (!shared_source || materializing)
+	    return;
+
+	const Impl* source = shared_source;
+
+	// The clones still reference the source devicegraph until the copier
+	// sets their back references. Setting them must not make the other
+	// deferred copies of the source, so hide them meanwhile.
+
+	vector<Devicegraph*> tmp;
+	tmp.swap(source->shared_copies);
+	source->shared = false;
+
+	materializing = true;
+
+	try
+	{
+	    source->copy_now(self);
+	}
+	catch (...)
+	{
+	    materializing = false;
+	    tmp.swap(source->shared_copies);
+	    source->shared = true;
+	    throw;
+	}
+
+	materializing = false;
+	tmp.swap(source->shared_copies);
+	source->shared = true;
+
+	// Only now self stops being a deferred copy, so concurrent access
+	// waits for the copy to be complete.
+
+	detach();
+    }
+
+
+    void
+    Devicegraph::Impl::unshare() const
+    {
+	std::lock_guard<std::recursive_mutex> lock(share_mutex);
+
+	while (!shared_copies.empty())
+	{
+	    Devicegraph* shared_copy = shared_copies.back();
+	    shared_copy->impl->materialize(*shared_copy);
+	}
+    }
+
+
+    void
+    Devicegraph::Impl::hand_over()
+    {
+	std::lock_guard<std::recursive_mutex> lock(share_mutex);
+
+	if (shared_copies.empty())
+	    return;
+
+	vector<Devicegraph*> tmp;
+	tmp.swap(shared_copies);
+	shared = false;
+
+	Devicegraph* heir = tmp.front();
+	Impl& heir_impl = *heir->impl;
+
+	heir_impl.graph.swap(graph);
+	heir_impl.rebuild_indexes();
+	heir_impl.shared_source = nullptr;
+
+	clear();
+
+	for (vertex_descriptor vertex : heir_impl.vertices())
+	    heir_impl.graph[vertex]->get_impl().set_devicegraph_and_vertex(heir, vertex);
+
+	for (edge_descriptor edge : heir_impl.edges())
+	    heir_impl.graph[edge]->get_impl().set_devicegraph_and_edge(heir, edge);
+
+	for (Devicegraph* shared_copy : boost::make_iterator_range(next(tmp.begin()), tmp.end()))
+	{
+	    shared_copy->impl->shared_source = &heir_impl;
+	    heir_impl.shared_copies.push_back(shared_copy);
+	    heir_impl.shared = true;
+	}
+    }
+
+
+    void
+    Devicegraph::Impl::detach()
+    {
+	std::lock_guard<std::recursive_mutex> lock(share_mutex);
 
-	VertexIndexMapGenerator<graph_t> vertex_index_map_generator(graph);
+	const Impl* source = shared_source;
+	if (!source)
+	    return;
 
-	CloneCopier copier(*this, dest);
+	vector<Devicegraph*>& tmp = source->shared_copies;
+	tmp.erase(remove_if(tmp.begin(), tmp.end(), [this](const Devicegraph* devicegraph) {
+	    return devicegraph->impl.get() == this;
+	}), tmp.end());
+	source->shared = !tmp.empty();
 
-	boost::copy_graph(graph, dest.get_impl().graph,
-			  vertex_index_map(vertex_index_map_generator.get()).
-			  vertex_copy(copier).edge_copy(copier));
+	shared_source = nullptr;
     }
 
 
@@ -275,13 +423,10 @@ namespace storage
 	    filtered_graph_t filtered_graph(graph, make_edge_filter(View::CLASSIC),
 					    make_vertex_filter(View::CLASSIC));
 
-	    VertexIndexMapGenerator<filtered_graph_t> vertex_index_map_generator(filtered_graph);
-
 	    bool has_cycle = false;
 
 	    CycleDetector cycle_detector(has_cycle);
-	    boost::depth_first_search(filtered_graph, visitor(cycle_detector).
-				      vertex_index_map(vertex_index_map_generator.get()));
+	    boost::depth_first_search(filtered_graph, visitor(cycle_detector));
 
 	    if (has_cycle)
 		ST_THROW(Exception("devicegraph has a cycle"));
@@ -378,14 +523,23 @@ namespace storage
     Devicegraph::Impl::vertex_descriptor
     Devicegraph::Impl::add_vertex(Device* device)
     {
-	return boost::add_vertex(shared_ptr<Device>(device), graph);
+	vertex_descriptor vertex = boost::add_vertex(graph_t::vertex_property_type(0, shared_ptr<Device>(device)),
+						     graph);
+
+	index_vertex(vertex);
+
+	return vertex;
     }
 
 
     Devicegraph::Impl::vertex_descriptor
     Devicegraph::Impl::add_vertex_v2(shared_ptr<Device> device)
     {
-	return boost::add_vertex(device, graph);
+	vertex_descriptor vertex = boost::add_vertex(graph_t::vertex_property_type(0, device), graph);
+
+	index_vertex(vertex);
+
+	return vertex;
     }
 
 
@@ -413,6 +567,8 @@ namespace storage
 	if (!tmp.second)
 	    ST_THROW(LogicException("boost::add_edge behaved unexpectedly"));
 
+	index_edge(tmp.first);
+
 	// TODO should also set devicegraph and edge in holder but the
 	// devicegraph is not available here
 
@@ -444,6 +600,8 @@ namespace storage
 	if (!tmp.second)
 	    ST_THROW(LogicException("boost::add_edge behaved unexpectedly"));
 
+	index_edge(tmp.first);
+
 	// TODO should also set devicegraph and edge in holder but the
 	// devicegraph is not available here
 
@@ -478,40 +636,25 @@ namespace storage
     bool
     Devicegraph::Impl::device_exists(sid_t sid) const
     {
-	for (vertex_descriptor vertex : vertices())
-	{
-	    if (graph[vertex]->get_sid() == sid)
-		return true;
-	}
-
-	return false;
+	return vertex_index.find(sid) != vertex_index.end();
     }
 
 
     bool
     Devicegraph::Impl::holder_exists(sid_t source_sid, sid_t target_sid) const
     {
-	for (edge_descriptor edge : edges())
-	{
-	    if (graph[source(edge)]->get_sid() == source_sid &&
-		graph[target(edge)]->get_sid() == target_sid)
-		return true;
-	}
-
-	return false;
+	return edge_index.find(make_pair(source_sid, target_sid)) != edge_index.end();
     }
 
 
     Devicegraph::Impl::vertex_descriptor
     Devicegraph::Impl::find_vertex(sid_t sid) const
     {
-	for (vertex_descriptor vertex : vertices())
-	{
-	    if (graph[vertex]->get_sid() == sid)
-		return vertex;
-	}
+	std::unordered_map<sid_t, vertex_descriptor>::const_iterator it = vertex_index.find(sid);
+	if (it == vertex_index.end())
+	    ST_THROW(DeviceNotFoundBySid(sid));
 
-	ST_THROW(DeviceNotFoundBySid(sid));
+	return it->second;
     }
 
 
@@ -533,16 +676,12 @@ namespace storage
     vector<Devicegraph::Impl::edge_descriptor>
     Devicegraph::Impl::find_edges(sid_t source_sid, sid_t target_sid) const
     {
-	vector<Devicegraph::Impl::edge_descriptor> ret;
+	std::unordered_map<sid_pair_t, vector<edge_descriptor>, sid_pair_hash>::const_iterator it =
+	    edge_index.find(make_pair(source_sid, target_sid));
+	if (it == edge_index.end())
+	    return {};
 
-	for (edge_descriptor edge : edges())
-	{
-	    if (graph[source(edge)]->get_sid() == source_sid &&
-		graph[target(edge)]->get_sid() == target_sid)
-		ret.push_back(edge);
-	}
-
-	return ret;
+	return it->second;
     }
 
 
@@ -601,12 +740,32 @@ namespace storage
     Devicegraph::Impl::clear()
     {
 	graph.clear();
+
+	vertex_index.clear();
+	dense_vertex_index.clear();
+	edge_index.clear();
+
+	{
+	    std::lock_guard<std::mutex> lock(lookup_mutex);
+	    lookup_indexes.clear();
+	}
+
+	std::lock_guard<std::mutex> lock(type_mutex);
+	type_indexes.clear();
     }
 
 
     void
     Devicegraph::Impl::remove_vertex(vertex_descriptor vertex)
     {
+	for (edge_descriptor edge : boost::make_iterator_range(boost::in_edges(vertex, graph)))
+	    unindex_edge(edge);
+
+	for (edge_descriptor edge : boost::make_iterator_range(boost::out_edges(vertex, graph)))
+	    unindex_edge(edge);
+
+	unindex_vertex(vertex);
+
 	boost::clear_vertex(vertex, graph);
 	boost::remove_vertex(vertex, graph);
     }
@@ -615,10 +774,185 @@ namespace storage
     void
     Devicegraph::Impl::remove_edge(edge_descriptor edge)
     {
+	unindex_edge(edge);
+
 	boost::remove_edge(edge, graph);
     }
 
 
+    void
+    Devicegraph::Impl::index_vertex(vertex_descriptor vertex)
+    {
+	// If the sid is already used the first vertex is kept. check() reports
+	// non-unique sids.
+
+	vertex_index.emplace(graph[vertex]->get_sid(), vertex);
+
+	dense_vertex_index.add(graph, vertex);
+
+	{
+	    std::lock_guard<std::mutex> lock(lookup_mutex);
+
+	    for (map<pair<LookupKey, std::type_index>, LookupIndex>::value_type& value : lookup_indexes)
+		add_to_lookup_index(value.second, vertex);
+	}
+
+	std::lock_guard<std::mutex> lock(type_mutex);
+
+	for (map<std::type_index, TypeIndex>::value_type& value : type_indexes)
+	    add_to_type_index(value.second, vertex);
+    }
+
+
+    void
+    Devicegraph::Impl::unindex_vertex(vertex_descriptor vertex)
+    {
+	dense_vertex_index.remove(graph, vertex);
+
+	std::unordered_map<sid_t, vertex_descriptor>::iterator it = vertex_index.find(graph[vertex]->get_sid());
+	if (it != vertex_index.end() && it->second == vertex)
+	    vertex_index.erase(it);
+
+	std::lock_guard<std::mutex> lock(type_mutex);
+
+	for (map<std::type_index, TypeIndex>::value_type& value : type_indexes)
+	    remove_from_type_index(value.second, vertex);
+    }
+
+
+    void
+    Devicegraph::Impl::index_edge(edge_descriptor edge)
+    {
+	sid_pair_t sid_pair = make_pair(graph[source(edge)]->get_sid(), graph[target(edge)]->get_sid());
+
+	edge_index[sid_pair].push_back(edge);
+    }
+
+
+    void
+    Devicegraph::Impl::unindex_edge(edge_descriptor edge)
+    {
+	sid_pair_t sid_pair = make_pair(graph[source(edge)]->get_sid(), graph[target(edge)]->get_sid());
+
+	std::unordered_map<sid_pair_t, vector<edge_descriptor>, sid_pair_hash>::iterator it =
+	    edge_index.find(sid_pair);
+	if (it == edge_index.end())
+	    return;
+
+	vector<edge_descriptor>& edges = it->second;
+	edges.erase(remove(edges.begin(), edges.end(), edge), edges.end());
+
+	if (edges.empty())
+	    edge_index.erase(it);
+    }
+
+
+    void
+    Devicegraph::Impl::add_to_lookup_index(LookupIndex& lookup_index, vertex_descriptor vertex) const
+    {
+	sid_t sid = graph[vertex]->get_sid();
+
+	for (const string& key : lookup_index.keys(graph[vertex].get()))
+	    lookup_index.index.emplace(key, sid);
+    }
+
+
+    void
+    Devicegraph::Impl::add_to_type_index(TypeIndex& type_index, vertex_descriptor vertex) const
+    {
+	if (!type_index.matches(graph[vertex].get()))
+	    return;
+
+	type_index.positions.emplace(vertex, type_index.vertices.size());
+	type_index.vertices.push_back(vertex);
+    }
+
+
+    void
+    Devicegraph::Impl::remove_from_type_index(TypeIndex& type_index, vertex_descriptor vertex) const
+    {
+	std::unordered_map<vertex_descriptor, size_t>::iterator it = type_index.positions.find(vertex);
+	if (it == type_index.positions.end())
+	    return;
+
+	type_index.vertices[it->second] = graph_t::null_vertex();
+	type_index.positions.erase(it);
+
+	// Compact the index once half of the entries are removed. That keeps
+	// removing vertices amortised constant.
+
+	if (++type_index.removed <= type_index.vertices.size() / 2)
+	    return;
+
+	vector<vertex_descriptor> tmp;
+	tmp.reserve(type_index.positions.size());
+
+	for (vertex_descriptor v : type_index.vertices)
+	{
+	    if (v == graph_t::null_vertex())
+		continue;
+
+	    type_index.positions[v] = tmp.size();
+	    tmp.push_back(v);
+	}
+
+	type_index.vertices.swap(tmp);
+	type_index.removed = 0;
+    }
+
+
+    void
+    Devicegraph::Impl::update_lookup_indexes(vertex_descriptor vertex) const
+    {
+	// Old keys of the device are not removed from the indexes. To limit
+	// the number of stale entries an index is dropped (and rebuilt on the
+	// next lookup) once it has seen more updates than there are devices.
+
+	std::lock_guard<std::mutex> lock(lookup_mutex);
+
+	for (map<pair<LookupKey, std::type_index>, LookupIndex>::iterator it = lookup_indexes.begin();
+	     it != lookup_indexes.end(); )
+	{
+	    LookupIndex& lookup_index = it->second;
+
+	    if (++lookup_index.updates > num_devices())
+	    {
+		it = lookup_indexes.erase(it);
+	    }
+	    else
+	    {
+		add_to_lookup_index(lookup_index, vertex);
+		++it;
+	    }
+	}
+    }
+
+
+    void
+    Devicegraph::Impl::rebuild_indexes()
+    {
+	vertex_index.clear();
+	dense_vertex_index.clear();
+	edge_index.clear();
+
+	{
+	    std::lock_guard<std::mutex> lock(lookup_mutex);
+	    lookup_indexes.clear();
+	}
+
+	{
+	    std::lock_guard<std::mutex> lock(type_mutex);
+	    type_indexes.clear();
+	}
+
+	for (vertex_descriptor vertex : vertices())
+	    index_vertex(vertex);
+
+	for (edge_descriptor edge : edges())
+	    index_edge(edge);
+    }
+
+
     size_t
     Devicegraph::Impl::num_children(vertex_descriptor vertex, View view) const
     {
@@ -701,13 +1035,10 @@ namespace storage
     {
 	filtered_graph_t filtered_graph(graph, make_edge_filter(view), make_vertex_filter(view));
 
-	VertexIndexMapGenerator<filtered_graph_t> vertex_index_map_generator(filtered_graph);
-
 	vector<vertex_descriptor> ret;
 	VertexRecorder<vertex_descriptor> vertex_recorder(false, ret);
 
-	boost::breadth_first_search(filtered_graph, vertex, visitor(vertex_recorder).
-				    vertex_index_map(vertex_index_map_generator.get()));
+	boost::breadth_first_search(filtered_graph, vertex, visitor(vertex_recorder));
 
 	if (!itself)
 	    ret.erase(remove(ret.begin(), ret.end(), vertex), ret.end());
@@ -724,13 +1055,10 @@ namespace storage
 	filtered_graph_t filtered_graph(graph, make_edge_filter(view), make_vertex_filter(view));
 	reverse_graph_t reverse_graph(filtered_graph);
 
-	VertexIndexMapGenerator<reverse_graph_t> vertex_index_map_generator(reverse_graph);
-
 	vector<vertex_descriptor> ret;
 	VertexRecorder<vertex_descriptor> vertex_recorder(false, ret);
 
-	boost::breadth_first_search(reverse_graph, vertex, visitor(vertex_recorder).
-				    vertex_index_map(vertex_index_map_generator.get()));
+	boost::breadth_first_search(reverse_graph, vertex, visitor(vertex_recorder));
 
 	if (!itself)
 	    ret.erase(remove(ret.begin(), ret.end(), vertex), ret.end());
@@ -744,13 +1072,10 @@ namespace storage
     {
 	filtered_graph_t filtered_graph(graph, make_edge_filter(view), make_vertex_filter(view));
 
-	VertexIndexMapGenerator<filtered_graph_t> vertex_index_map_generator(filtered_graph);
-
 	vector<vertex_descriptor> ret;
 	VertexRecorder<vertex_descriptor> vertex_recorder(true, ret);
 
-	boost::breadth_first_search(filtered_graph, vertex, visitor(vertex_recorder).
-				    vertex_index_map(vertex_index_map_generator.get()));
+	boost::breadth_first_search(filtered_graph, vertex, visitor(vertex_recorder));
 
 	if (!itself)
 	    ret.erase(remove(ret.begin(), ret.end(), vertex), ret.end());
@@ -767,13 +1092,10 @@ namespace storage
 	filtered_graph_t filtered_graph(graph, make_edge_filter(view), make_vertex_filter(view));
 	reverse_graph_t reverse_graph(filtered_graph);
 
-	VertexIndexMapGenerator<reverse_graph_t> vertex_index_map_generator(filtered_graph);
-
 	vector<vertex_descriptor> ret;
 	VertexRecorder<vertex_descriptor> vertex_recorder(true, ret);
 
-	boost::breadth_first_search(reverse_graph, vertex, visitor(vertex_recorder).
-				    vertex_index_map(vertex_index_map_generator.get()));
+	boost::breadth_first_search(reverse_graph, vertex, visitor(vertex_recorder));
 
 	if (!itself)
 	    ret.erase(remove(ret.begin(), ret.end(), vertex), ret.end());
@@ -846,9 +1168,25 @@ namespace storage
 
 	clear();
 
-	XmlFile xml(filename);
+	// Both formats provide the same element tree. The binary file must
+	// be kept until loading is finished since the nodes point into it.
+
+	unique_ptr<XmlFile> xml;
+	unique_ptr<BinaryXmlFile> binary_xml;
+
+	const xmlNode* root_node = nullptr;
+
+	if (BinaryXmlFile::is_binary_xml_file(filename))
+	{
+	    binary_xml = make_unique<BinaryXmlFile>(filename);
+	    root_node = binary_xml->getRootElement();
+	}
+	else
+	{
+	    xml = make_unique<XmlFile>(filename);
+	    root_node = xml->getRootElement();
+	}
 
-	const xmlNode* root_node = xml.getRootElement();
 	if (!root_node)
 	    ST_THROW(Exception("root node not found"));
 
@@ -894,12 +1232,14 @@ namespace storage
 		Device* device = graph[vertex].get();
 		device->get_impl().set_sid(Storage::Impl::get_next_sid());
 	    }
+
+	    rebuild_indexes();
 	}
     }
 
 
     void
-    Devicegraph::Impl::save(const string& filename) const
+    Devicegraph::Impl::save(const string& filename, DevicegraphFormat format) const
     {
 	XmlFile xml;
 
@@ -927,8 +1267,17 @@ namespace storage
 	    holder->get_impl().save(holder_node);
 	}
 
-	if (!xml.save_to_file(filename))
-	    ST_THROW(Exception(sformat("failed to write '%s'", filename)));
+	switch (format)
+	{
+	    case DevicegraphFormat::XML:
+		if (!xml.save_to_file(filename))
+		    ST_THROW(Exception(sformat("failed to write '%s'", filename)));
+		break;
+
+	    case DevicegraphFormat::BINARY:
+		BinaryXmlFile::save_to_file(devicegraph_node, filename);
+		break;
+	}
     }
 
 
@@ -1017,7 +1366,7 @@ namespace storage
 	fout << "// " << generated_string() << "\n\n";
 
 	// Build up a property map with the sid to be used for the
-	// vertex id. Same as VertexIndexMapGenerator but with the sid
+	// vertex id. Same as the vertex index but with the sid
 	// instead of a generated index. Why? For once the sid is
 	// needed as id for the ranks. Also other programs can query
 	// the id when the user clicks on a node and thus can lookup
@@ -26,6 +26,14 @@
 
 
 #include <set>
+#include <map>
+#include <unordered_map>
+#include <typeindex>
+#include <type_traits>
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <atomic>
 #include <boost/noncopyable.hpp>
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/graph/filtered_graph.hpp>
@@ -34,6 +42,7 @@
 #include "storage/Holders/Holder.h"
 #include "storage/Devicegraph.h"
 #include "storage/View.h"
+#include "storage/Utils/GraphUtils.h"
 
 
 namespace storage
@@ -41,12 +50,22 @@ namespace storage
     using std::string;
     using std::vector;
     using std::set;
+    using std::map;
     using std::pair;
 
 
     using sid_pair_t = pair<sid_t, sid_t>;
 
 
+    struct sid_pair_hash
+    {
+	size_t operator()(const sid_pair_t& sid_pair) const
+	{
+	    return std::hash<uint64_t>()((uint64_t)(sid_pair.first) << 32 | sid_pair.second);
+	}
+    };
+
+
     class Devicegraph::Impl : private boost::noncopyable
     {
 
@@ -62,8 +81,11 @@ namespace storage
 	// properties, see:
 	// http://www.boost.org/doc/libs/1_56_0/libs/graph/doc/bundles.html
 
+	// The interior vertex_index property is maintained by dense_vertex_index.
+
 	typedef boost::adjacency_list<boost::listS, boost::listS, boost::bidirectionalS,
-				      std::shared_ptr<Device>, std::shared_ptr<Holder>> graph_t;
+				      boost::property<boost::vertex_index_t, size_t, std::shared_ptr<Device>>,
+				      std::shared_ptr<Holder>> graph_t;
 
 	typedef graph_t::vertex_descriptor vertex_descriptor;
 	typedef graph_t::edge_descriptor edge_descriptor;
@@ -96,8 +118,52 @@ namespace storage
 
 	void log_diff(std::ostream& log, const Impl& rhs) const;
 
+	/**
+	 * Copies the devicegraph to dest. The copy is deferred: dest only
+	 * references this devicegraph until dest is accessed or this
+	 * devicegraph is modified. Copies that are never looked at are
+	 * cheap.
+	 */
 	void copy(Devicegraph& dest) const;
 
+	/**
+	 * Check if this devicegraph is a deferred copy not yet made.
+	 */
+	bool is_deferred() const { return shared_source; }
+
+	/**
+	 * Check if deferred copies of this devicegraph exist.
+	 */
+	bool is_shared() const { return shared; }
+
+	/**
+	 * Makes the deferred copy. self must be the devicegraph owning this
+	 * object. Concurrent calls for the same devicegraph are allowed.
+	 */
+	void materialize(Devicegraph& self);
+
+	/**
+	 * Makes all deferred copies of this devicegraph. Must be done before
+	 * this devicegraph is modified.
+	 */
+	void unshare() const;
+
+	/**
+	 * Hands the content over to the deferred copies of this devicegraph.
+	 * The first copy takes over the devices and holders instead of
+	 * cloning them and the other copies become deferred copies of the
+	 * first one. Must be done before the content of this devicegraph is
+	 * dropped, e.g. when it is destroyed.
+	 */
+	void hand_over();
+
+	/**
+	 * Forgets about the source if this devicegraph is a deferred copy.
+	 */
+	void detach();
+
+	static bool is_deferred_copy(const Devicegraph& devicegraph) { return devicegraph.impl->is_deferred(); }
+
 	/**
 	 * Check if this devicegraph is the probed devicegraph.
 	 */
@@ -158,7 +224,7 @@ namespace storage
 	boost::iterator_range<edge_iterator> edges() const;
 
 	void load(Devicegraph* devicegraph, const string& filename, bool keep_sids);
-	void save(const string& filename) const;
+	void save(const string& filename, DevicegraphFormat format) const;
 
 	void print(std::ostream& out) const;
 
@@ -190,20 +256,16 @@ namespace storage
 	vector<edge_descriptor> out_edges(vertex_descriptor vertex, View view = View::CLASSIC) const;
 
 
+	/**
+	 * Returns the devices of Type, including derived classes, in the order
+	 * of the graph. Uses the type index for Type which is built on first
+	 * use.
+	 */
 	template<typename Type>
 	vector<Type*>
 	get_devices_of_type() const
 	{
-	    vector<Type*> ret;
-
-	    for (vertex_descriptor vertex : vertices())
-	    {
-		Type* device = dynamic_cast<Type*>(graph[vertex].get());
-		if (device)
-		    ret.push_back(device);
-	    }
-
-	    return ret;
+	    return get_devices_of_type_if<Type>([](const Type*) { return true; });
 	}
 
 
@@ -213,11 +275,37 @@ namespace storage
 	{
 	    vector<Type*> ret;
 
-	    for (vertex_descriptor vertex : vertices())
+	    if constexpr (std::is_same_v<std::remove_const_t<Type>, Device>)
 	    {
-		Type* device = dynamic_cast<Type*>(graph[vertex].get());
-		if (device && pred(device))
-		    ret.push_back(device);
+		for (vertex_descriptor vertex : vertices())
+		{
+		    Type* device = graph[vertex].get();
+		    if (pred(device))
+			ret.push_back(device);
+		}
+	    }
+	    else
+	    {
+		{
+		    std::lock_guard<std::mutex> lock(type_mutex);
+
+		    const TypeIndex& type_index = get_type_index<std::remove_const_t<Type>>();
+
+		    ret.reserve(type_index.vertices.size() - type_index.removed);
+
+		    for (vertex_descriptor vertex : type_index.vertices)
+		    {
+			if (vertex != graph_t::null_vertex())
+			    ret.push_back(static_cast<Type*>(graph[vertex].get()));
+		    }
+		}
+
+		// pred is called without holding the lock since it may query
+		// the devicegraph itself
+
+		ret.erase(std::remove_if(ret.begin(), ret.end(), [&pred](Type* device) {
+		    return !pred(device);
+		}), ret.end());
 	    }
 
 	    return ret;
@@ -292,6 +380,78 @@ namespace storage
 	}
 
 
+	/**
+	 * Index from a lookup key, e.g. a name or UUID, to the sids of the
+	 * devices having that key. The index is only extended when devices are
+	 * added or the keys of a device change, so entries can be stale and
+	 * must be verified, see find_vertices_by_lookup_key().
+	 */
+	typedef std::unordered_multimap<string, sid_t> lookup_index_t;
+
+	enum class LookupKey { NAME, ANY_NAME, UUID };
+
+	/**
+	 * Find the vertices of devices of Type having the key. The function
+	 * keys must return all keys of a device for the given lookup key. The
+	 * index for lookup_key and Type is built on first use. The vertices are
+	 * returned in the order of the graph.
+	 */
+	template <typename Type>
+	vector<vertex_descriptor>
+	find_vertices_by_lookup_key(LookupKey lookup_key, const string& key,
+				    std::function<vector<string>(const Type*)> keys) const
+	{
+	    vector<vertex_descriptor> ret;
+
+	    std::lock_guard<std::mutex> lock(lookup_mutex);
+
+	    const lookup_index_t& lookup_index = get_lookup_index<Type>(lookup_key, keys);
+
+	    for (const lookup_index_t::value_type& value : boost::make_iterator_range(lookup_index.equal_range(key)))
+	    {
+		std::unordered_map<sid_t, vertex_descriptor>::const_iterator it = vertex_index.find(value.second);
+		if (it == vertex_index.end())
+		    continue;
+
+		const Type* device = dynamic_cast<const Type*>(graph[it->second].get());
+		if (!device)
+		    continue;
+
+		const vector<string> tmp = keys(device);
+		if (std::find(tmp.begin(), tmp.end(), key) == tmp.end())
+		    continue;
+
+		if (std::find(ret.begin(), ret.end(), it->second) == ret.end())
+		    ret.push_back(it->second);
+	    }
+
+	    // The order of the index depends on the order of the updates and
+	    // hashing. Several devices with the same key are rare, so only then
+	    // restore the order of the graph.
+
+	    if (ret.size() > 1)
+	    {
+		vector<vertex_descriptor> sorted;
+		sorted.reserve(ret.size());
+
+		for (vertex_descriptor vertex : vertices())
+		{
+		    if (std::find(ret.begin(), ret.end(), vertex) != ret.end())
+			sorted.push_back(vertex);
+		}
+
+		ret.swap(sorted);
+	    }
+
+	    return ret;
+	}
+
+	/**
+	 * Must be called when the keys of the device of the vertex change,
+	 * e.g. when the device is renamed.
+	 */
+	void update_lookup_indexes(vertex_descriptor vertex) const;
+
 	Storage* get_storage() { return storage; }
 	const Storage* get_storage() const { return storage; }
 
@@ -304,6 +464,156 @@ namespace storage
 
 	Storage* storage;
 
+	void copy_now(Devicegraph& dest) const;
+
+	/**
+	 * The devicegraph this devicegraph is a deferred copy of. The source
+	 * is never a deferred copy itself.
+	 */
+	std::atomic<const Impl*> shared_source { nullptr };
+
+	/**
+	 * The devicegraphs that are deferred copies of this devicegraph.
+	 * Protected by share_mutex.
+	 */
+	mutable vector<Devicegraph*> shared_copies;
+
+	/**
+	 * Whether shared_copies is not empty. Allows to check that without
+	 * locking share_mutex.
+	 */
+	mutable std::atomic<bool> shared { false };
+
+	/**
+	 * Set while the deferred copy is made. Protected by share_mutex.
+	 */
+	bool materializing = false;
+
+	/**
+	 * Protects making, handing over and registering deferred copies. Those
+	 * operations involve several devicegraphs.
+	 */
+	static std::recursive_mutex share_mutex;
+
+	/**
+	 * Index from the sid of a device to the vertex. Must be kept in sync with
+	 * the graph by all functions adding or removing vertices.
+	 */
+	std::unordered_map<sid_t, vertex_descriptor> vertex_index;
+
+	/**
+	 * Dense index of the vertices used by the graph algorithms. Must be
+	 * kept in sync with the graph like vertex_index.
+	 */
+	DenseVertexIndex<graph_t> dense_vertex_index;
+
+	/**
+	 * Index from the sids of the source and target device to the edges. Must
+	 * be kept in sync with the graph by all functions adding or removing
+	 * edges.
+	 */
+	std::unordered_map<sid_pair_t, vector<edge_descriptor>, sid_pair_hash> edge_index;
+
+	void index_vertex(vertex_descriptor vertex);
+	void unindex_vertex(vertex_descriptor vertex);
+
+	void index_edge(edge_descriptor edge);
+	void unindex_edge(edge_descriptor edge);
+
+	/**
+	 * Rebuild the vertex and edge index from scratch, e.g. after the graph was
+	 * copied or the sids were changed. The lookup indexes are dropped.
+	 */
+	void rebuild_indexes();
+
+	struct LookupIndex
+	{
+	    std::function<vector<string>(const Device*)> keys;
+	    lookup_index_t index;
+	    size_t updates = 0;
+	};
+
+	/**
+	 * The lookup indexes are built on demand, thus mutable.
+	 */
+	mutable map<pair<LookupKey, std::type_index>, LookupIndex> lookup_indexes;
+
+	/**
+	 * Protects the lookup indexes during lookups and updates since those
+	 * can happen concurrently during a parallel commit.
+	 */
+	mutable std::mutex lookup_mutex;
+
+	template <typename Type>
+	const lookup_index_t&
+	get_lookup_index(LookupKey lookup_key, std::function<vector<string>(const Type*)> keys) const
+	{
+	    LookupIndex& lookup_index = lookup_indexes[make_pair(lookup_key, std::type_index(typeid(Type)))];
+
+	    if (!lookup_index.keys)
+	    {
+		lookup_index.keys = [keys](const Device* device) -> vector<string> {
+		    const Type* tmp = dynamic_cast<const Type*>(device);
+		    return tmp ? keys(tmp) : vector<string>();
+		};
+
+		for (vertex_descriptor vertex : vertices())
+		    add_to_lookup_index(lookup_index, vertex);
+	    }
+
+	    return lookup_index.index;
+	}
+
+	void add_to_lookup_index(LookupIndex& lookup_index, vertex_descriptor vertex) const;
+
+	/**
+	 * Index of the vertices of the devices of one class including derived
+	 * classes, e.g. the index for Partitionable includes Disks and Mds.
+	 * The vertices are in the order of the graph. Removed vertices are
+	 * replaced by the null vertex until the index is compacted.
+	 */
+	struct TypeIndex
+	{
+	    std::function<bool(const Device*)> matches;
+	    vector<vertex_descriptor> vertices;
+	    std::unordered_map<vertex_descriptor, size_t> positions;
+	    size_t removed = 0;
+	};
+
+	/**
+	 * The type indexes are built on demand, thus mutable. Afterwards they
+	 * are maintained by index_vertex() and unindex_vertex().
+	 */
+	mutable map<std::type_index, TypeIndex> type_indexes;
+
+	/**
+	 * Protects the type indexes since devices can be queried concurrently
+	 * during a parallel commit.
+	 */
+	mutable std::mutex type_mutex;
+
+	template <typename Type>
+	const TypeIndex&
+	get_type_index() const
+	{
+	    TypeIndex& type_index = type_indexes[std::type_index(typeid(Type))];
+
+	    if (!type_index.matches)
+	    {
+		type_index.matches = [](const Device* device) {
+		    return dynamic_cast<const Type*>(device) != nullptr;
+		};
+
+		for (vertex_descriptor vertex : vertices())
+		    add_to_type_index(type_index, vertex);
+	    }
+
+	    return type_index;
+	}
+
+	void add_to_type_index(TypeIndex& type_index, vertex_descriptor vertex) const;
+	void remove_from_type_index(TypeIndex& type_index, vertex_descriptor vertex) const;
+
     };
 
 }
@@ -289,7 +289,7 @@ namespace storage
 
 	    if (regex_match(line, match, set_uuid_regex) && match.size() == 2)
 	    {
-		uuid = match[1];
+		set_uuid(match[1]);
 		y2mil("found set-uuid " << uuid);
 		break;
 	    }
@@ -75,7 +75,7 @@ namespace storage
 	virtual uf_t used_features(UsedFeaturesDependencyType used_features_dependency_type) const override;
 
 	const string& get_uuid() const { return uuid; }
-	void set_uuid(const string& uuid) { Impl::uuid = uuid; }
+	void set_uuid(const string& uuid) { Impl::uuid = uuid; lookup_keys_changed(); }
 
 	virtual bool equal(const Device::Impl& rhs) const override;
 	virtual void log_diff(std::ostream& log, const Device::Impl& rhs_base) const override;
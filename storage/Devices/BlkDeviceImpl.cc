@@ -122,6 +122,8 @@ namespace storage
 		udev_ids = cmd_udevadm_info.get_by_id_links();
 		process_udev_ids(udev_ids, prober.get_udev_filters());
 	    }
+
+	    lookup_keys_changed();
 	}
     }
 
@@ -202,6 +204,26 @@ namespace storage
     BlkDevice::Impl::set_name(const string& name)
     {
 	Impl::name = name;
+
+	lookup_keys_changed();
+    }
+
+
+    void
+    BlkDevice::Impl::set_udev_paths(const vector<string>& udev_paths)
+    {
+	Impl::udev_paths = udev_paths;
+
+	lookup_keys_changed();
+    }
+
+
+    void
+    BlkDevice::Impl::set_udev_ids(const vector<string>& udev_ids)
+    {
+	Impl::udev_ids = udev_ids;
+
+	lookup_keys_changed();
     }
 
 
@@ -373,6 +395,30 @@ namespace storage
     }
 
 
+    namespace
+    {
+
+	/**
+	 * Keys for looking up a block device by any name, see
+	 * BlkDevice::Impl::is_alias_of().
+	 */
+	vector<string>
+	any_name_lookup_keys(const BlkDevice* blk_device)
+	{
+	    vector<string> ret = { blk_device->get_name() };
+
+	    for (const string& udev_path : blk_device->get_udev_paths())
+		ret.push_back(DEV_DISK_BY_PATH_DIR "/" + udev_path);
+
+	    for (const string& udev_id : blk_device->get_udev_ids())
+		ret.push_back(DEV_DISK_BY_ID_DIR "/" + udev_id);
+
+	    return ret;
+	}
+
+    }
+
+
     bool
     BlkDevice::Impl::exists_by_any_name(const Devicegraph* devicegraph, const string& name,
 					SystemInfo::Impl& system_info)
@@ -380,15 +426,9 @@ namespace storage
 	if (!devicegraph->get_impl().is_system() && !devicegraph->get_impl().is_probed())
 	    ST_THROW(Exception("function called on wrong devicegraph"));
 
-	for (Devicegraph::Impl::vertex_descriptor vertex : devicegraph->get_impl().vertices())
-	{
-	    const BlkDevice* blk_device = dynamic_cast<const BlkDevice*>(devicegraph->get_impl()[vertex]);
-	    if (blk_device)
-	    {
-		if (blk_device->get_name() == name || blk_device->get_impl().is_alias_of(name))
-		    return true;
-	    }
-	}
+	if (!devicegraph->get_impl().find_vertices_by_lookup_key<const BlkDevice>(
+		Devicegraph::Impl::LookupKey::ANY_NAME, name, any_name_lookup_keys).empty())
+	    return true;
 
 	try
 	{
@@ -420,15 +460,11 @@ namespace storage
 	if (!devicegraph->get_impl().is_system() && !devicegraph->get_impl().is_probed())
 	    ST_THROW(Exception("function called on wrong devicegraph"));
 
-	for (Devicegraph::Impl::vertex_descriptor vertex : devicegraph->get_impl().vertices())
-	{
-	    BlkDevice* blk_device = dynamic_cast<BlkDevice*>(devicegraph->get_impl()[vertex]);
-	    if (blk_device)
-	    {
-		if (blk_device->get_name() == name || blk_device->get_impl().is_alias_of(name))
-		    return blk_device;
-	    }
-	}
+	vector<Devicegraph::Impl::vertex_descriptor> vertices =
+	    devicegraph->get_impl().find_vertices_by_lookup_key<const BlkDevice>(
+		Devicegraph::Impl::LookupKey::ANY_NAME, name, any_name_lookup_keys);
+	if (!vertices.empty())
+	    return to_blk_device(devicegraph->get_impl()[vertices.front()]);
 
 	try
 	{
@@ -460,15 +496,11 @@ namespace storage
 	if (!devicegraph->get_impl().is_system() && !devicegraph->get_impl().is_probed())
 	    ST_THROW(Exception("function called on wrong devicegraph"));
 
-	for (Devicegraph::Impl::vertex_descriptor vertex : devicegraph->get_impl().vertices())
-	{
-	    const BlkDevice* blk_device = dynamic_cast<const BlkDevice*>(devicegraph->get_impl()[vertex]);
-	    if (blk_device)
-	    {
-		if (blk_device->get_name() == name || blk_device->get_impl().is_alias_of(name))
-		    return blk_device;
-	    }
-	}
+	vector<Devicegraph::Impl::vertex_descriptor> vertices =
+	    devicegraph->get_impl().find_vertices_by_lookup_key<const BlkDevice>(
+		Devicegraph::Impl::LookupKey::ANY_NAME, name, any_name_lookup_keys);
+	if (!vertices.empty())
+	    return to_blk_device(devicegraph->get_impl()[vertices.front()]);
 
 	try
 	{
@@ -980,7 +1012,12 @@ namespace storage
     void
     wait_for_devices(const vector<const BlkDevice*>& blk_devices)
     {
-	udev_settle();
+	vector<string> dev_names;
+
+	for (const BlkDevice* blk_device : blk_devices)
+	    dev_names.push_back(blk_device->get_name());
+
+	udev_settle(dev_names);
 
 	if (Mockup::get_mode() == Mockup::Mode::PLAYBACK)
 	    return;
@@ -1027,7 +1064,7 @@ namespace storage
     void
     wait_for_detach_devices(const vector<string>& dev_names)
     {
-	udev_settle();
+	udev_settle(dev_names);
 
 	if (Mockup::get_mode() == Mockup::Mode::PLAYBACK)
 	    return;
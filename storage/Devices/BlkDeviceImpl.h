@@ -102,10 +102,10 @@ namespace storage
 	void set_topology(const Topology& topology) { Impl::topology = topology; }
 
 	const vector<string>& get_udev_paths() const { return udev_paths; }
-	void set_udev_paths(const vector<string>& udev_paths) { Impl::udev_paths = udev_paths; }
+	void set_udev_paths(const vector<string>& udev_paths);
 
 	const vector<string>& get_udev_ids() const { return udev_ids; }
-	void set_udev_ids(const vector<string>& udev_ids) { Impl::udev_ids = udev_ids; }
+	void set_udev_ids(const vector<string>& udev_ids);
 
 	virtual string get_fstab_spec(MountByType mount_by_type) const;
 
@@ -27,6 +27,7 @@
 #include "storage/Devicegraph.h"
 #include "storage/Storage.h"
 #include "storage/Environment.h"
+#include "storage/EnvironmentImpl.h"
 #include "storage/SystemInfo/SystemInfoImpl.h"
 #include "storage/Utils/Exception.h"
 #include "storage/Utils/Enum.h"
@@ -203,6 +204,19 @@ namespace storage
     void
     Dasd::Impl::probe_dasds(Prober& prober)
     {
+	const int max_threads = probe_threads();
+	if (max_threads > 1)
+	{
+	    vector<string> names;
+	    for (const string& short_name : prober.get_sys_block_entries().dasds)
+	    {
+		if (!boost::starts_with(short_name, "vd"))
+		    names.push_back(DEV_DIR "/" + short_name);
+	    }
+
+	    prober.get_system_info().prefetchDasdview(names, max_threads);
+	}
+
 	for (const string& short_name : prober.get_sys_block_entries().dasds)
 	{
 	    string name = DEV_DIR "/" + short_name;
@@ -57,6 +57,19 @@ namespace storage
     Device::~Device() = default;
 
 
+    Device::Impl&
+    Device::get_impl()
+    {
+	// Non-const access to the device makes the deferred copies of the
+	// devicegraph, see Devicegraph::get_impl().
+
+	if (impl->has_devicegraph())
+	    impl->get_devicegraph()->get_impl();
+
+	return *impl;
+    }
+
+
     string
     Device::get_displayname() const
     {
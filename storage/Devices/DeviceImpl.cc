@@ -182,6 +182,16 @@ namespace storage
     }
 
 
+    void
+    Device::Impl::lookup_keys_changed() const
+    {
+	// The device might not be in a devicegraph yet.
+
+	if (devicegraph)
+	    devicegraph->get_impl().update_lookup_indexes(vertex);
+    }
+
+
     Devicegraph*
     Device::Impl::get_devicegraph()
     {
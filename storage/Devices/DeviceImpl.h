@@ -109,6 +109,8 @@ namespace storage
 	Devicegraph* get_devicegraph();
 	const Devicegraph* get_devicegraph() const;
 
+	bool has_devicegraph() const { return devicegraph; }
+
 	Devicegraph::Impl::vertex_descriptor get_vertex() const;
 
 	virtual Device* get_non_impl() { return devicegraph->get_impl()[vertex]; }
@@ -395,6 +397,12 @@ namespace storage
 
 	Impl(const xmlNode* node);
 
+	/**
+	 * Has to be called when a key used for lookups in the devicegraph,
+	 * e.g. the name or UUID, of the device changes.
+	 */
+	void lookup_keys_changed() const;
+
     public:
 
 	/**
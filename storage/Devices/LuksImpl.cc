@@ -35,6 +35,7 @@
 #include "storage/Prober.h"
 #include "storage/Utils/Format.h"
 #include "storage/Utils/StorageTmpl.h"
+#include "storage/EnvironmentImpl.h"
 
 
 namespace storage
@@ -400,6 +401,8 @@ namespace storage
 	 * times.
 	 */
 
+	vector<BlkDevice*> blk_devices;
+
 	for (BlkDevice* blk_device : BlkDevice::get_all(prober.get_system()))
 	{
 	    if (blk_device->has_children())
@@ -412,6 +415,23 @@ namespace storage
 	    if (it1 == blkid.end() || !it1->second.is_luks)
 		continue;
 
+	    blk_devices.push_back(blk_device);
+	}
+
+	const int max_threads = probe_threads();
+	if (max_threads > 1)
+	{
+	    vector<string> names;
+	    for (const BlkDevice* blk_device : blk_devices)
+		names.push_back(blk_device->get_name());
+
+	    system_info.prefetchCmdCryptsetupLuksDump(names, max_threads);
+	}
+
+	for (BlkDevice* blk_device : blk_devices)
+	{
+	    Blkid::const_iterator it1 = blkid.find_by_any_name(blk_device->get_name(), system_info);
+
 	    string uuid = it1->second.luks_uuid;
 	    string label = it1->second.luks_label;
 
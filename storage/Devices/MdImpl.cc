@@ -520,6 +520,16 @@ namespace storage
 	SystemInfo::Impl& system_info = prober.get_system_info();
 	const MdLinks& md_links = system_info.getMdLinks();
 
+	const int max_threads = probe_threads();
+	if (max_threads > 1)
+	{
+	    vector<string> names;
+	    for (const string& short_name : prober.get_sys_block_entries().mds)
+		names.push_back(DEV_DIR "/" + short_name);
+
+	    system_info.prefetchCmdMdadmDetail(names, max_threads);
+	}
+
 	for (const string& short_name : prober.get_sys_block_entries().mds)
 	{
 	    string name = DEV_DIR "/" + short_name;
@@ -325,7 +325,7 @@ namespace storage
 
 	SystemCmd cmd(cmd_args, SystemCmd::DoThrow);
 
-	udev_settle();
+	udev_settle({ partitionable->get_name() });
     }
 
 
@@ -1015,7 +1015,7 @@ namespace storage
 	cmd_args << to_string(get_region().get_start() * factor)
 		 << to_string((get_region().get_end() - tmps.size()) * factor + (factor - 1));
 
-	udev_settle();
+	udev_settle({ partitionable->get_name() });
 
 	SystemCmd cmd(cmd_args, SystemCmd::DoThrow);
 
@@ -1025,7 +1025,7 @@ namespace storage
 	{
 	    if (!CmdPartedVersion::supports_wipe_signatures())
 	    {
-		udev_settle();
+		udev_settle({ partitionable->get_name() });
 		wipe_device();
 	    }
 
@@ -1116,7 +1116,7 @@ namespace storage
 
 	    cmd_args << to_string(get_region().get_end() - i) << to_string(get_region().get_end() - i);
 
-	    udev_settle();
+	    udev_settle({ partitionable->get_name() });
 
 	    SystemCmd cmd(cmd_args, SystemCmd::DoThrow);
 	}
@@ -1139,7 +1139,7 @@ namespace storage
 	{
 	    SystemCmd::Args cmd_args = { PARTED_BIN, "--script", partitionable->get_name(), "rm", to_string(i) };
 
-	    udev_settle();
+	    udev_settle({ partitionable->get_name() });
 
 	    SystemCmd cmd(cmd_args, SystemCmd::DoThrow);
 	}
@@ -1147,7 +1147,7 @@ namespace storage
 	SystemCmd::Args cmd_args = { PARTED_BIN, "--script", partitionable->get_name(),
 	    "unit", "s", "resizepart", to_string(get_number()), to_string(get_region().get_end()) };
 
-	udev_settle();
+	udev_settle({ partitionable->get_name() });
 
 	wait_for_devices({ get_non_impl() });
 
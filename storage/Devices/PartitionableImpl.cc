@@ -153,14 +153,21 @@ namespace storage
     }
 
 
-    void
-    Partitionable::Impl::probe_pass_1c(Prober& prober)
+    bool
+    Partitionable::Impl::probe_pass_1c_needs_parted() const
     {
 	if (has_children() || !is_active() || get_size() == 0)
-	    return;
+	    return false;
 
 	// do not run parted on host-managed zoned disks
-	if (!is_usable_as_partitionable())
+	return is_usable_as_partitionable();
+    }
+
+
+    void
+    Partitionable::Impl::probe_pass_1c(Prober& prober)
+    {
+	if (!probe_pass_1c_needs_parted())
 	    return;
 
 	try
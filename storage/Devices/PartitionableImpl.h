@@ -65,6 +65,11 @@ namespace storage
 	virtual void probe_pass_1a(Prober& prober) override;
 	virtual void probe_pass_1c(Prober& prober) override;
 
+	/**
+	 * Checks whether probe_pass_1c() runs parted for the partitionable.
+	 */
+	bool probe_pass_1c_needs_parted() const;
+
 	PartitionTable* create_partition_table(PtType pt_type);
 
 	bool has_partition_table() const;
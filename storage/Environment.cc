@@ -100,6 +100,20 @@ namespace storage
     }
 
 
+    DevicegraphFormat
+    Environment::get_devicegraph_format() const
+    {
+	return get_impl().get_devicegraph_format();
+    }
+
+
+    void
+    Environment::set_devicegraph_format(DevicegraphFormat devicegraph_format)
+    {
+	get_impl().set_devicegraph_format(devicegraph_format);
+    }
+
+
     const string&
     Environment::get_arch_filename() const
     {
@@ -60,6 +60,10 @@ namespace storage
     };
 
 
+    // Defined in Devicegraph.h.
+    enum class DevicegraphFormat;
+
+
     class Environment
     {
     public:
@@ -113,6 +117,14 @@ namespace storage
 	const std::string& get_devicegraph_filename() const;
 	void set_devicegraph_filename(const std::string& devicegraph_filename);
 
+	/**
+	 * Format used to write the devicegraph in probe mode
+	 * STANDARD_WRITE_DEVICEGRAPH. When reading the devicegraph the format
+	 * is detected. The default is XML.
+	 */
+	DevicegraphFormat get_devicegraph_format() const;
+	void set_devicegraph_format(DevicegraphFormat devicegraph_format);
+
 	const std::string& get_arch_filename() const;
 	void set_arch_filename(const std::string& arch_filename);
 
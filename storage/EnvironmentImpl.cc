@@ -29,6 +29,8 @@
 
 #include "config.h"
 #include "storage/EnvironmentImpl.h"
+#include "storage/Utils/Mockup.h"
+#include "storage/Utils/Remote.h"
 
 
 namespace storage
@@ -174,6 +176,90 @@ namespace storage
     }
 
 
+    int
+    probe_threads()
+    {
+	return read_env_var("LIBSTORAGE_PROBE_THREADS", 0);
+    }
+
+
+    bool
+    native_access_possible()
+    {
+	return Mockup::get_mode() == Mockup::Mode::NONE && !get_remote_callbacks();
+    }
+
+
+    bool
+    udevadm_export_db()
+    {
+	return read_env_var("LIBSTORAGE_UDEVADM_EXPORT_DB", false);
+    }
+
+
+    bool
+    lvm_fullreport()
+    {
+	return read_env_var("LIBSTORAGE_LVM_FULLREPORT", false);
+    }
+
+
+    bool
+    sysfs_scanner()
+    {
+	return read_env_var("LIBSTORAGE_SYSFS_SCANNER", false);
+    }
+
+
+    bool
+    partition_table_reader()
+    {
+	return read_env_var("LIBSTORAGE_PARTITION_TABLE_READER", false);
+    }
+
+
+    bool
+    signature_scanner()
+    {
+	return read_env_var("LIBSTORAGE_SIGNATURE_SCANNER", false);
+    }
+
+
+    bool
+    crypt_header_reader()
+    {
+	return read_env_var("LIBSTORAGE_CRYPT_HEADER_READER", false);
+    }
+
+
+    bool
+    posix_spawn_backend()
+    {
+	return read_env_var("LIBSTORAGE_POSIX_SPAWN", false);
+    }
+
+
+    int
+    commit_threads()
+    {
+	return read_env_var("LIBSTORAGE_COMMIT_THREADS", 0);
+    }
+
+
+    bool
+    udev_monitor()
+    {
+	return read_env_var("LIBSTORAGE_UDEV_MONITOR", false);
+    }
+
+
+    bool
+    btrfs_ioctl()
+    {
+	return read_env_var("LIBSTORAGE_BTRFS_IOCTL", false);
+    }
+
+
     const vector<string> EnumTraits<OsFlavour>::names({
 	"linux", "suse", "redhat"
     });
@@ -214,19 +300,30 @@ namespace storage
 	    "LD_LIBRARY_PATH",
 	    "LD_PRELOAD",
 	    "LIBSTORAGE_BLKDISCARD",
+	    "LIBSTORAGE_BTRFS_IOCTL",
 	    "LIBSTORAGE_BTRFS_QGROUPS",
 	    "LIBSTORAGE_BTRFS_SNAPSHOT_RELATIONS",
+	    "LIBSTORAGE_COMMIT_THREADS",
 	    "LIBSTORAGE_CONFDIR",
+	    "LIBSTORAGE_CRYPT_HEADER_READER",
 	    "LIBSTORAGE_DEVELOPER_MODE",
 	    "LIBSTORAGE_LOCALEDIR",
 	    "LIBSTORAGE_LOCKFILE_ROOT",
+	    "LIBSTORAGE_LVM_FULLREPORT",
 	    "LIBSTORAGE_MDADM_ACTIVATE_METHOD",
 	    "LIBSTORAGE_MULTIPLE_DEVICES_BTRFS",
 	    "LIBSTORAGE_OS_FLAVOUR",
+	    "LIBSTORAGE_PARTITION_TABLE_READER",
 	    "LIBSTORAGE_PFSOEMS",
+	    "LIBSTORAGE_POSIX_SPAWN",
+	    "LIBSTORAGE_PROBE_THREADS",
 	    "LIBSTORAGE_ROOTPREFIX",
+	    "LIBSTORAGE_SIGNATURE_SCANNER",
+	    "LIBSTORAGE_SYSFS_SCANNER",
 	    "LIBSTORAGE_TABOOS",
 	    "LIBSTORAGE_TOPOLOGICAL_SORT_METHOD",
+	    "LIBSTORAGE_UDEV_MONITOR",
+	    "LIBSTORAGE_UDEVADM_EXPORT_DB",
 	};
 
 	for (const char* env_var : env_vars)
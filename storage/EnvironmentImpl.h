@@ -26,6 +26,7 @@
 
 
 #include "storage/Environment.h"
+#include "storage/Devicegraph.h"
 #include "storage/Utils/Enum.h"
 
 
@@ -56,6 +57,10 @@ namespace storage
 	void set_devicegraph_filename(const string& devicegraph_filename)
 	    { Impl::devicegraph_filename = devicegraph_filename; }
 
+	DevicegraphFormat get_devicegraph_format() const { return devicegraph_format; }
+	void set_devicegraph_format(DevicegraphFormat devicegraph_format)
+	    { Impl::devicegraph_format = devicegraph_format; }
+
 	const string& get_arch_filename() const { return arch_filename; }
 	void set_arch_filename(const string& arch_filename) { Impl::arch_filename = arch_filename; }
 
@@ -79,6 +84,7 @@ namespace storage
 	string rootprefix;
 	string lockfile_root;
 	string devicegraph_filename;
+	DevicegraphFormat devicegraph_format = DevicegraphFormat::XML;
 	string arch_filename;
 	string mockup_filename;
 
@@ -136,6 +142,89 @@ namespace storage
      */
     bool run_blkdiscard();
 
+    /**
+     * Number of threads used to run commands in parallel during probing and
+     * in BlkFilesystem::detect_all_infos(). Values below 2 disable running
+     * commands in parallel.
+     */
+    int probe_threads();
+
+    /**
+     * Whether the system can be accessed directly, e.g. by reading block
+     * devices or using ioctls, instead of running commands. Not possible
+     * in mockup mode or with remote callbacks since there the commands are
+     * faked or run elsewhere.
+     */
+    bool native_access_possible();
+
+    /**
+     * Switch to use 'udevadm info --export-db' to get the udev information of all
+     * block devices with a single command (during probing).
+     */
+    bool udevadm_export_db();
+
+    /**
+     * Switch to use 'lvm fullreport' to get the information about all PVs, VGs
+     * and LVs with a single command (during probing).
+     */
+    bool lvm_fullreport();
+
+    /**
+     * Switch to read the sysfs attributes of all block devices natively in one
+     * pass (during probing).
+     */
+    bool sysfs_scanner();
+
+    /**
+     * Switch to read MS-DOS and GPT partition tables natively instead of
+     * running parted (during probing).
+     */
+    bool partition_table_reader();
+
+    /**
+     * Switch to detect filesystems, LUKS, LVM PVs, MD members and bcache by
+     * reading the signatures natively instead of running blkid for all block
+     * devices (during probing).
+     */
+    bool signature_scanner();
+
+    /**
+     * Switch to read LUKS headers and BitLocker metadata natively instead of
+     * running 'cryptsetup luksDump' and 'cryptsetup bitlkDump' for every
+     * encrypted device (during probing).
+     */
+    bool crypt_header_reader();
+
+    /**
+     * Switch to start commands with posix_spawn instead of fork and exec. Avoids
+     * copying the page tables of a possibly large process for every command.
+     */
+    bool posix_spawn_backend();
+
+    /**
+     * Number of threads used to commit independent actions in parallel. Values
+     * below 2 disable committing actions in parallel. When enabled the calls
+     * of CommitCallbacksV2::begin_action() and end_action() for different
+     * actions can interleave.
+     */
+    int commit_threads();
+
+    /**
+     * Switch to wait only for the udev events of the affected devices
+     * instead of running 'udevadm settle' (during commit).
+     */
+    bool udev_monitor();
+
+    /**
+     * Switch to create btrfs subvolumes and set the nocow attribute using
+     * ioctls within one mount of the btrfs instead of running the btrfs and
+     * chattr commands each with its own mount (during commit). Also
+     * switches to read the subvolumes and their nocow attribute using
+     * ioctls instead of running the btrfs and lsattr commands (during
+     * probing).
+     */
+    bool btrfs_ioctl();
+
     /**
      * Operating system flavour.
      */
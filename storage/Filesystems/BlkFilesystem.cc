@@ -248,6 +248,13 @@ namespace storage
     }
 
 
+    void
+    BlkFilesystem::detect_all_infos(const Devicegraph* devicegraph, uint32_t what)
+    {
+	Impl::detect_all_infos(devicegraph, what);
+    }
+
+
     vector<const BlkFilesystem*>
     BlkFilesystem::find_by_label(const Devicegraph* devicegraph, const string& label)
     {
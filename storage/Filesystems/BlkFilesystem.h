@@ -37,6 +37,30 @@ namespace storage
     class ContentInfo;
 
 
+    /**
+     * Infos detected by BlkFilesystem::detect_all_infos().
+     */
+    enum : uint32_t
+    {
+
+	/**
+	 * The ResizeInfo, see BlkFilesystem::detect_resize_info().
+	 */
+	DI_RESIZE_INFO = 1 << 0,
+
+	/**
+	 * The ContentInfo, see BlkFilesystem::detect_content_info().
+	 */
+	DI_CONTENT_INFO = 1 << 1,
+
+	/**
+	 * The SpaceInfo, see Filesystem::detect_space_info().
+	 */
+	DI_SPACE_INFO = 1 << 2
+
+    };
+
+
     // abstract class
 
     class BlkFilesystem : public Filesystem
@@ -181,6 +205,19 @@ namespace storage
 	 */
 	void set_content_info(const ContentInfo& content_info);
 
+	/**
+	 * Detect the infos selected by what (a combination of DI_RESIZE_INFO,
+	 * DI_CONTENT_INFO and DI_SPACE_INFO) for all filesystems of the
+	 * devicegraph at once. Each filesystem is mounted at most once and
+	 * several filesystems are handled in parallel (see
+	 * LIBSTORAGE_PROBE_THREADS). The infos are cached so that
+	 * subsequent calls of the detect functions return immediately.
+	 *
+	 * Errors are logged but otherwise ignored. Calling the detect
+	 * function afterwards reports the error.
+	 */
+	static void detect_all_infos(const Devicegraph* devicegraph, uint32_t what);
+
 	/**
 	 * Find filesystems by label.
 	 */
@@ -33,6 +33,7 @@
 #include "storage/Utils/HumanString.h"
 #include "storage/Utils/CallbacksImpl.h"
 #include "storage/Utils/Udev.h"
+#include "storage/Utils/WorkerPool.h"
 #include "storage/Filesystems/BlkFilesystemImpl.h"
 #include "storage/Filesystems/MountPointImpl.h"
 #include "storage/Holders/FilesystemUserImpl.h"
@@ -460,6 +461,104 @@ namespace storage
     }
 
 
+    void
+    BlkFilesystem::Impl::detect_all_infos(const Devicegraph* devicegraph, uint32_t what)
+    {
+	y2mil("detect-all-infos what:" << what);
+
+	vector<std::function<void()>> tasks;
+
+	for (const BlkFilesystem* blk_filesystem : BlkFilesystem::get_all(devicegraph))
+	{
+	    tasks.push_back([blk_filesystem, what]() {
+
+		const BlkFilesystem::Impl& impl = blk_filesystem->get_impl();
+
+		// Only detect infos not already cached.
+
+		bool need_resize_info = (what & DI_RESIZE_INFO) && !impl.resize_info.has_value();
+		bool need_content_info = (what & DI_CONTENT_INFO) && !impl.content_info.has_value();
+		bool need_space_info = (what & DI_SPACE_INFO) && !impl.has_space_info();
+
+		// Some tools refuse to work on mounted filesystems, e.g.
+		// ntfsresize, so detect the resize info first if that does
+		// not need a mount anyway.
+
+		if (need_resize_info && !impl.resize_info_needs_mount())
+		{
+		    try
+		    {
+			impl.detect_resize_info();
+		    }
+		    catch (const Exception& exception)
+		    {
+			ST_CAUGHT(exception);
+		    }
+
+		    need_resize_info = false;
+		}
+
+		if (!need_resize_info && !need_content_info && !need_space_info)
+		    return;
+
+		try
+		{
+		    // Mount the filesystem once for all infos. The nested
+		    // EnsureMounted objects of the detect functions reuse the
+		    // mount.
+
+		    unique_ptr<EnsureMounted> ensure_mounted;
+		    if (blk_filesystem->exists_in_system() && blk_filesystem->supports_mount())
+			ensure_mounted = make_unique<EnsureMounted>(blk_filesystem);
+
+		    if (need_resize_info)
+		    {
+			try
+			{
+			    impl.detect_resize_info();
+			}
+			catch (const Exception& exception)
+			{
+			    ST_CAUGHT(exception);
+			}
+		    }
+
+		    if (need_content_info)
+		    {
+			try
+			{
+			    impl.detect_content_info();
+			}
+			catch (const Exception& exception)
+			{
+			    ST_CAUGHT(exception);
+			}
+		    }
+
+		    if (need_space_info)
+		    {
+			try
+			{
+			    impl.detect_space_info();
+			}
+			catch (const Exception& exception)
+			{
+			    ST_CAUGHT(exception);
+			}
+		    }
+		}
+		catch (const Exception& exception)
+		{
+		    ST_CAUGHT(exception);
+		}
+
+	    });
+	}
+
+	run_in_worker_pool(tasks, probe_threads());
+    }
+
+
     bool
     BlkFilesystem::Impl::detect_is_windows(const string& mount_point)
     {
@@ -119,6 +119,12 @@ namespace storage
 	virtual ResizeInfo detect_resize_info_on_disk(const BlkDevice* blk_device = nullptr) const;
 	void set_resize_info(const ResizeInfo& resize_info);
 
+	/**
+	 * Whether detect_resize_info_on_disk() mounts the filesystem. The
+	 * generic implementation does so to get the free size.
+	 */
+	virtual bool resize_info_needs_mount() const { return supports_shrink(); }
+
 	unsigned long long used_size_on_disk() const;
 	unsigned long long free_size_on_disk() const;
 
@@ -126,6 +132,8 @@ namespace storage
 	virtual ContentInfo detect_content_info_on_disk() const;
 	void set_content_info(const ContentInfo& content_info);
 
+	static void detect_all_infos(const Devicegraph* devicegraph, uint32_t what);
+
 	virtual Text get_message_name() const override;
 
 	virtual string get_mount_name() const override;
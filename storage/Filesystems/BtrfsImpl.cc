@@ -634,6 +634,19 @@ namespace storage
 	    mount_point = ensure_mounted->get_any_mount_point();
 	}
 
+	if (btrfs_ioctl())
+	{
+	    try
+	    {
+		system_info.prefetchBtrfsSubvolumes(blk_device->get_name(), mount_point);
+	    }
+	    catch (const Exception& exception)
+	    {
+		// Not fatal, the information is read the usual way.
+		ST_CAUGHT(exception);
+	    }
+	}
+
 	// Unfortunately 'btrfs subvolume list' uses the UUID to show the parent/origin of
 	// snapshots instead of the ID. Also unfortunately the top-level subvolume is not
 	// included in the output so the UUID of the top-level must be obtained
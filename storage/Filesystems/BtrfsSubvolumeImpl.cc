@@ -29,6 +29,7 @@
 #include "storage/Devicegraph.h"
 #include "storage/Utils/StorageDefines.h"
 #include "storage/Utils/SystemCmd.h"
+#include "storage/Utils/BtrfsIoctl.h"
 #include "storage/Utils/StorageTmpl.h"
 #include "storage/Utils/HumanString.h"
 #include "storage/Devices/BlkDeviceImpl.h"
@@ -39,6 +40,7 @@
 #include "storage/Holders/Subdevice.h"
 #include "storage/Holders/Snapshot.h"
 #include "storage/Prober.h"
+#include "storage/ActiongraphImpl.h"
 #include "storage/Utils/Format.h"
 #include "storage/Actions/CreateImpl.h"
 #include "storage/Actions/DeleteImpl.h"
@@ -568,11 +570,31 @@ namespace storage
 	// e.g. when creating <fs-tree>/a/b it is enough when subvol=a is
 	// mounted somewhere.
 
-	// TODO Just do one mount if several subvolumes get created.
-
 	EnsureMounted ensure_mounted(top_level, false);
 
-	string full_path = ensure_mounted.get_any_mount_point() + "/" + path;
+	create_in(ensure_mounted.get_any_mount_point(), false);
+    }
+
+
+    void
+    BtrfsSubvolume::Impl::do_create(CommitData& commit_data)
+    {
+	if (!commit_data.keep_btrfs_mount)
+	{
+	    do_create();
+	    return;
+	}
+
+	const BtrfsSubvolume* top_level = get_top_level_btrfs_subvolume();
+
+	create_in(commit_data.get_btrfs_mount_point(top_level), true);
+    }
+
+
+    void
+    BtrfsSubvolume::Impl::create_in(const string& mount_point, bool ioctl)
+    {
+	string full_path = mount_point + "/" + path;
 	string full_dirname = dirname(full_path);
 
 	if (access(full_dirname.c_str(), R_OK) != 0)
@@ -587,11 +609,20 @@ namespace storage
 	    rmdir(full_path.c_str());
 	}
 
-	SystemCmd::Args cmd_args = { BTRFS_BIN, "subvolume", "create", full_path };
+	if (ioctl)
+	{
+	    BtrfsIoctl::create_subvolume(full_dirname, basename(full_path));
 
-	SystemCmd cmd(cmd_args, SystemCmd::DoThrow);
+	    set_id(BtrfsIoctl::get_subvolume_id(full_path));
+	}
+	else
+	{
+	    SystemCmd::Args cmd_args = { BTRFS_BIN, "subvolume", "create", full_path };
+
+	    SystemCmd cmd(cmd_args, SystemCmd::DoThrow);
 
-	probe_id(ensure_mounted.get_any_mount_point());
+	    probe_id(mount_point);
+	}
 
 	if (has_btrfs_qgroup())
 	    get_btrfs_qgroup()->get_impl().set_id(get_btrfs_qgroup_id());
@@ -717,10 +748,16 @@ namespace storage
 
 
     void
-    BtrfsSubvolume::Impl::do_set_nocow() const
+    BtrfsSubvolume::Impl::do_set_nocow(CommitData& commit_data) const
     {
 	const BtrfsSubvolume* top_level = get_top_level_btrfs_subvolume();
 
+	if (commit_data.keep_btrfs_mount)
+	{
+	    BtrfsIoctl::set_nocow(commit_data.get_btrfs_mount_point(top_level) + "/" + path, nocow);
+	    return;
+	}
+
 	EnsureMounted ensure_mounted(top_level, false);
 
 	SystemCmd::Args cmd_args = { CHATTR_BIN, nocow ? "+C" : "-C",
@@ -151,6 +151,12 @@ namespace storage
 	virtual Text do_create_text(Tense tense) const override;
 	virtual void do_create() override;
 
+	/**
+	 * Creates the subvolume using ioctls within the mount kept in the
+	 * commit data if enabled, see CommitData::keep_btrfs_mount.
+	 */
+	void do_create(CommitData& commit_data);
+
 	virtual Text do_mount_text(const MountPoint* mount_point, Tense tense) const override;
 
 	virtual Text do_unmount_text(const MountPoint* mount_point, Tense tense) const override;
@@ -160,7 +166,7 @@ namespace storage
 	virtual Text do_remove_from_etc_fstab_text(const MountPoint* mount_point, Tense tense) const override;
 
 	virtual Text do_set_nocow_text(Tense tense) const;
-	virtual void do_set_nocow() const;
+	virtual void do_set_nocow(CommitData& commit_data) const;
 	virtual uf_t do_set_nocow_used_features() const { return used_features_pure(); }
 
 	virtual Text do_set_default_btrfs_subvolume_text(Tense tense) const;
@@ -179,6 +185,12 @@ namespace storage
 
 	void probe_id(const string& mount_point);
 
+	/**
+	 * Creates the subvolume below the mount point of the top-level
+	 * subvolume, either using ioctls or the btrfs command.
+	 */
+	void create_in(const string& mount_point, bool ioctl);
+
     private:
 
 	long id = unknown_id;
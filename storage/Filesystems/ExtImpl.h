@@ -74,6 +74,7 @@ namespace storage
 	virtual const char* get_classname() const override { return DeviceTraits<Ext>::classname; }
 
 	virtual ResizeInfo detect_resize_info_on_disk(const BlkDevice* blk_device = nullptr) const override;
+	virtual bool resize_info_needs_mount() const override { return false; }
 
 	virtual void do_create() override;
 
@@ -22,6 +22,8 @@
 
 
 #include <algorithm>
+#include <mutex>
+#include <thread>
 #include <boost/algorithm/string.hpp>
 
 #include "storage/Utils/XmlFile.h"
@@ -600,6 +602,28 @@ namespace storage
     }
 
 
+    namespace
+    {
+
+	/**
+	 * The temporary mounts of the EnsureMounted objects by thread and
+	 * mountable. Nested EnsureMounted objects on the same thread reuse the
+	 * temporary mount, e.g. when several infos of a filesystem are detected
+	 * at once, see BlkFilesystem::Impl::detect_all_infos().
+	 */
+	struct SharedTmpMount
+	{
+	    string path;
+	    bool read_only;
+	};
+
+	std::mutex shared_tmp_mounts_mutex;
+
+	map<pair<std::thread::id, const Mountable*>, SharedTmpMount> shared_tmp_mounts;
+
+    }
+
+
     EnsureMounted::EnsureMounted(const Mountable* mountable, bool read_only)
 	: mountable(mountable), tmp_mount()
     {
@@ -610,7 +634,7 @@ namespace storage
 	    ST_THROW(Exception("mount not supported"));
 	}
 
-	if (mount_needed())
+	if (mount_needed() && !find_shared_tmp_mount(read_only))
 	{
 	    y2mil("mount is needed");
 
@@ -622,6 +646,35 @@ namespace storage
     EnsureMounted::~EnsureMounted()
     {
 	y2mil("~EnsureMounted " << *mountable);
+
+	if (shares_tmp_mount)
+	{
+	    std::lock_guard<std::mutex> lock(shared_tmp_mounts_mutex);
+	    shared_tmp_mounts.erase(make_pair(std::this_thread::get_id(), mountable));
+	}
+    }
+
+
+    bool
+    EnsureMounted::find_shared_tmp_mount(bool read_only)
+    {
+	std::lock_guard<std::mutex> lock(shared_tmp_mounts_mutex);
+
+	map<pair<std::thread::id, const Mountable*>, SharedTmpMount>::const_iterator it =
+	    shared_tmp_mounts.find(make_pair(std::this_thread::get_id(), mountable));
+	if (it == shared_tmp_mounts.end())
+	    return false;
+
+	// A read-only mount cannot be used if read-write is requested.
+
+	if (it->second.read_only && !read_only)
+	    return false;
+
+	y2mil("reusing mount at " << it->second.path);
+
+	shared_mount_point = it->second.path;
+
+	return true;
     }
 
 
@@ -678,6 +731,12 @@ namespace storage
 	tmp_mount = make_unique<TmpMount>(storage->get_impl().get_tmp_dir().get_fullname(),
 					  "tmp-mount-XXXXXX", mountable->get_impl().get_mount_name(),
 					  read_only, mountable->get_impl().get_mount_options());
+
+	std::lock_guard<std::mutex> lock(shared_tmp_mounts_mutex);
+
+	SharedTmpMount shared_tmp_mount = { tmp_mount->get_fullname(), read_only };
+	shares_tmp_mount = shared_tmp_mounts.emplace(make_pair(std::this_thread::get_id(), mountable),
+						     shared_tmp_mount).second;
     }
 
 
@@ -686,6 +745,8 @@ namespace storage
     {
 	if (tmp_mount)
 	    return tmp_mount->get_fullname();
+	else if (!shared_mount_point.empty())
+	    return shared_mount_point;
 	else
 	    return mountable->get_mount_point()->get_path();
     }
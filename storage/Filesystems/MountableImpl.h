@@ -293,12 +293,28 @@ namespace storage
 	 */
 	void do_mount(bool read_only);
 
+	/**
+	 * Check whether an enclosing EnsureMounted object on the same thread
+	 * has mounted the mountable and use that mount point.
+	 */
+	bool find_shared_tmp_mount(bool read_only);
+
 	bool mountable_has_active_mount_point() const;
 
 	const Mountable* mountable;
 
 	unique_ptr<TmpMount> tmp_mount;
 
+	/**
+	 * Whether tmp_mount can be reused by nested EnsureMounted objects.
+	 */
+	bool shares_tmp_mount = false;
+
+	/**
+	 * Mount point of the enclosing EnsureMounted object if reused.
+	 */
+	string shared_mount_point;
+
     };
 
 }
@@ -77,6 +77,7 @@ namespace storage
 	virtual unique_ptr<Device::Impl> clone() const override { return make_unique<Impl>(*this); }
 
 	virtual ResizeInfo detect_resize_info_on_disk(const BlkDevice* blk_device = nullptr) const override;
+	virtual bool resize_info_needs_mount() const override { return false; }
 
 	virtual ContentInfo detect_content_info_on_disk() const override;
 
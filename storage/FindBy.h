@@ -33,18 +33,35 @@
 namespace storage
 {
     using std::string;
+    using std::vector;
+
+
+    template<typename Type>
+    vector<string>
+    name_lookup_keys(const Type* device)
+    {
+	return { device->get_impl().get_name() };
+    }
+
+
+    template<typename Type>
+    vector<string>
+    uuid_lookup_keys(const Type* device)
+    {
+	return { device->get_impl().get_uuid() };
+    }
 
 
     template<typename Type>
     Type*
     find_by_name(Devicegraph* devicegraph, const string& name)
     {
-	for (Devicegraph::Impl::vertex_descriptor vertex : devicegraph->get_impl().vertices())
-	{
-	    Type* device = dynamic_cast<Type*>(devicegraph->get_impl()[vertex]);
-	    if (device && device->get_impl().get_name() == name)
-		return device;
-	}
+	Devicegraph::Impl& devicegraph_impl = devicegraph->get_impl();
+
+	vector<Devicegraph::Impl::vertex_descriptor> vertices = devicegraph_impl.find_vertices_by_lookup_key<Type>(
+	    Devicegraph::Impl::LookupKey::NAME, name, name_lookup_keys<Type>);
+	if (!vertices.empty())
+	    return dynamic_cast<Type*>(devicegraph_impl[vertices.front()]);
 
 	ST_THROW(DeviceNotFoundByName(name));
     }
@@ -54,12 +71,12 @@ namespace storage
     const Type*
     find_by_name(const Devicegraph* devicegraph, const string& name)
     {
-	for (Devicegraph::Impl::vertex_descriptor vertex : devicegraph->get_impl().vertices())
-	{
-	    const Type* device = dynamic_cast<const Type*>(devicegraph->get_impl()[vertex]);
-	    if (device && device->get_impl().get_name() == name)
-		return device;
-	}
+	const Devicegraph::Impl& devicegraph_impl = devicegraph->get_impl();
+
+	vector<Devicegraph::Impl::vertex_descriptor> vertices = devicegraph_impl.find_vertices_by_lookup_key<Type>(
+	    Devicegraph::Impl::LookupKey::NAME, name, name_lookup_keys<Type>);
+	if (!vertices.empty())
+	    return dynamic_cast<const Type*>(devicegraph_impl[vertices.front()]);
 
 	ST_THROW(DeviceNotFoundByName(name));
     }
@@ -69,12 +86,12 @@ namespace storage
     Type*
     find_by_uuid(Devicegraph* devicegraph, const string& uuid)
     {
-	for (Devicegraph::Impl::vertex_descriptor vertex : devicegraph->get_impl().vertices())
-	{
-	    Type* device = dynamic_cast<Type*>(devicegraph->get_impl()[vertex]);
-	    if (device && device->get_impl().get_uuid() == uuid)
-		return device;
-	}
+	Devicegraph::Impl& devicegraph_impl = devicegraph->get_impl();
+
+	vector<Devicegraph::Impl::vertex_descriptor> vertices = devicegraph_impl.find_vertices_by_lookup_key<Type>(
+	    Devicegraph::Impl::LookupKey::UUID, uuid, uuid_lookup_keys<Type>);
+	if (!vertices.empty())
+	    return dynamic_cast<Type*>(devicegraph_impl[vertices.front()]);
 
 	ST_THROW(DeviceNotFoundByUuid(uuid));
     }
@@ -84,12 +101,12 @@ namespace storage
     const Type*
     find_by_uuid(const Devicegraph* devicegraph, const string& uuid)
     {
-	for (Devicegraph::Impl::vertex_descriptor vertex : devicegraph->get_impl().vertices())
-	{
-	    const Type* device = dynamic_cast<const Type*>(devicegraph->get_impl()[vertex]);
-	    if (device && device->get_impl().get_uuid() == uuid)
-		return device;
-	}
+	const Devicegraph::Impl& devicegraph_impl = devicegraph->get_impl();
+
+	vector<Devicegraph::Impl::vertex_descriptor> vertices = devicegraph_impl.find_vertices_by_lookup_key<Type>(
+	    Devicegraph::Impl::LookupKey::UUID, uuid, uuid_lookup_keys<Type>);
+	if (!vertices.empty())
+	    return dynamic_cast<const Type*>(devicegraph_impl[vertices.front()]);
 
 	ST_THROW(DeviceNotFoundByUuid(uuid));
     }
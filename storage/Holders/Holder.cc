@@ -55,6 +55,19 @@ namespace storage
     Holder::~Holder() = default;
 
 
+    Holder::Impl&
+    Holder::get_impl()
+    {
+	// Non-const access to the holder makes the deferred copies of the
+	// devicegraph, see Devicegraph::get_impl().
+
+	if (impl->get_devicegraph())
+	    impl->get_devicegraph()->get_impl();
+
+	return *impl;
+    }
+
+
     bool
     Holder::operator==(const Holder& rhs) const
     {
@@ -182,7 +182,7 @@ namespace storage
 
 	class Impl;
 
-	Impl& get_impl() { return *impl; }
+	Impl& get_impl();
 	const Impl& get_impl() const { return *impl; }
 
 	virtual Holder* clone() const ST_DEPRECATED = 0;
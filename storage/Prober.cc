@@ -53,22 +53,95 @@
 #include "storage/Filesystems/TmpfsImpl.h"
 #include "storage/UsedFeatures.h"
 #include "storage/Utils/StorageTmpl.h"
+#include "storage/EnvironmentImpl.h"
 
 
 namespace storage
 {
 
 
+    namespace
+    {
+
+	bool
+	skip_sys_block_entry(const string& short_name)
+	{
+	    return boost::starts_with(short_name, "loop") || boost::starts_with(short_name, "dm-");
+	}
+
+
+	/**
+	 * Run the 'stat' and 'udevadm info' commands for all entries in
+	 * /sys/block in parallel. Errors are only reported when the results
+	 * are used.
+	 */
+	void
+	prefetch_sys_block_entries(SystemInfo::Impl& system_info, int max_threads)
+	{
+	    vector<string> names;
+
+	    for (const string& short_name : system_info.getDir(SYSFS_DIR "/block"))
+	    {
+		if (!skip_sys_block_entry(short_name))
+		    names.push_back(DEV_DIR "/" + short_name);
+	    }
+
+	    system_info.prefetchCmdStat(names, max_threads);
+
+	    vector<string> udevadm_info_names;
+
+	    for (const string& name : names)
+	    {
+		if (Md::Impl::is_valid_sysfs_name(name) || Bcache::Impl::is_valid_name(name))
+		    continue;
+
+		try
+		{
+		    if (system_info.getCmdStat(name).is_blk())
+			udevadm_info_names.push_back(name);
+		}
+		catch (const Exception& exception)
+		{
+		    ST_CAUGHT(exception);
+		}
+	    }
+
+	    system_info.prefetchCmdUdevadmInfo(udevadm_info_names, max_threads);
+	}
+
+    }
+
+
     SysBlockEntries
     probe_sys_block_entries(SystemInfo::Impl& system_info)
     {
 	const Arch& arch = system_info.getArch();
 
+	if (sysfs_scanner())
+	{
+	    try
+	    {
+		system_info.prefetchSysfs();
+	    }
+	    catch (const Exception& exception)
+	    {
+		// Not fatal, the information is read the usual way.
+		ST_CAUGHT(exception);
+	    }
+	}
+
+	if (udevadm_export_db())
+	    system_info.prefetchCmdUdevadmInfoAll();
+
+	const int max_threads = probe_threads();
+	if (max_threads > 1)
+	    prefetch_sys_block_entries(system_info, max_threads);
+
 	SysBlockEntries sys_block_entries;
 
 	for (const string& short_name : system_info.getDir(SYSFS_DIR "/block"))
 	{
-	    if (boost::starts_with(short_name, "loop") || boost::starts_with(short_name, "dm-"))
+	    if (skip_sys_block_entry(short_name))
 		continue;
 
 	    string name = DEV_DIR "/" + short_name;
@@ -314,6 +387,19 @@ namespace storage
 	{
 	    if (system_info.getBlkid().any_lvm())
 	    {
+		if (lvm_fullreport())
+		{
+		    try
+		    {
+			system_info.prefetchCmdLvmFullreport();
+		    }
+		    catch (const Exception& exception)
+		    {
+			// Not fatal, the information is read the usual way.
+			ST_CAUGHT(exception);
+		    }
+		}
+
 		LvmVg::Impl::probe_lvm_vgs(*this);
 		LvmPv::Impl::probe_lvm_pvs(*this);
 		LvmLv::Impl::probe_lvm_lvs(*this);
@@ -375,6 +461,20 @@ namespace storage
 
 	try
 	{
+	    const int max_threads = probe_threads();
+	    if (max_threads > 1)
+	    {
+		vector<string> names;
+
+		for (const Partitionable* partitionable : Partitionable::get_all(system))
+		{
+		    if (partitionable->get_impl().probe_pass_1c_needs_parted())
+			names.push_back(partitionable->get_name());
+		}
+
+		system_info.prefetchParted(names, max_threads);
+	    }
+
 	    for (Devicegraph::Impl::vertex_descriptor vertex : system->get_impl().vertices())
 	    {
 		Device* device = system->get_impl()[vertex];
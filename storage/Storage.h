@@ -427,6 +427,10 @@ namespace storage
 
 	/**
 	 * Called at the begin of commit of a single action.
+	 *
+	 * If actions are committed in parallel, see LIBSTORAGE_COMMIT_THREADS,
+	 * other actions can begin before this action ends. The callbacks are
+	 * never called concurrently.
 	 */
 	virtual void begin_action(const Action::Base* action) const {}
 
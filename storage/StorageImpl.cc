@@ -74,6 +74,17 @@ namespace storage
 
     Storage::Impl::~Impl()
     {
+	// Destroy deferred copies first, otherwise the content of their source
+	// would be handed over to them when the source is destroyed.
+
+	for (devicegraphs_t::iterator it = devicegraphs.begin(); it != devicegraphs.end(); )
+	{
+	    if (Devicegraph::Impl::is_deferred_copy(it->second))
+		it = devicegraphs.erase(it);
+	    else
+		++it;
+	}
+
 	// TODO: Make sure logger is destroyed after this object
     }
 
@@ -211,7 +222,7 @@ namespace storage
 
 	    case ProbeMode::STANDARD_WRITE_DEVICEGRAPH: {
 		probe_helper(probe_callbacks, probed, system_info);
-		probed->save(environment.get_devicegraph_filename());
+		probed->save(environment.get_devicegraph_filename(), environment.get_devicegraph_format());
 	    } break;
 
 	    case ProbeMode::STANDARD_WRITE_MOCKUP: {
@@ -245,6 +256,8 @@ namespace storage
 	copy_devicegraph("system", "probed");
 
 	setup_taboos(system_info);
+
+	flush_logger();
     }
 
 
@@ -510,6 +523,8 @@ namespace storage
 
 	actiongraph->get_impl().commit(commit_options, commit_callbacks);
 
+	flush_logger();
+
 	// TODO somehow update probed
     }
 
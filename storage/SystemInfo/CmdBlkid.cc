@@ -33,6 +33,7 @@
 #include "storage/Filesystems/FilesystemImpl.h"
 #include "storage/EnvironmentImpl.h"
 #include "storage/Utils/JsonFile.h"
+#include "storage/SystemInfo/SignatureScanner.h"
 
 
 namespace storage
@@ -54,15 +55,44 @@ namespace storage
 
     CmdBlkid::CmdBlkid(Udevadm& udevadm, const std::optional<string>& device)
     {
-	const bool json = CmdBlkidVersion::supports_json_option_v2();
+	// Also needed before scanning natively since the generations of the
+	// cached results are built from the udev database, see
+	// SignatureScanner.
 
 	udevadm.settle();
 
+	if (!device && signature_scanner() && native_access_possible())
+	{
+	    try
+	    {
+		scan_natively();
+		return;
+	    }
+	    catch (const Exception& exception)
+	    {
+		ST_CAUGHT(exception);
+	    }
+
+	    y2mil("using blkid for all devices");
+	}
+
+	run(device ? vector<string>({ device.value() }) : vector<string>());
+
+	if (device && data.size() > 1)
+	    ST_THROW(Exception("command blkid returned wrong number of devices"));
+    }
+
+
+    void
+    CmdBlkid::run(const vector<string>& devices)
+    {
+	const bool json = CmdBlkidVersion::supports_json_option_v2();
+
 	SystemCmd::Args cmd_args({ BLKID_BIN, "--cache-file", DEV_NULL_FILE });
 	if (json)
 	    cmd_args << "--output" << "json";
-	if (device)
-	    cmd_args << device.value();
+	for (const string& device : devices)
+	    cmd_args << device;
 
 	SystemCmd::Options options(cmd_args, SystemCmd::DoThrow);
 
@@ -75,9 +105,49 @@ namespace storage
 	    parse(cmd.stdout());
 	else
 	    parse_json(cmd.stdout());
+    }
 
-	if (device && data.size() > 1)
-	    ST_THROW(Exception("command blkid returned wrong number of devices"));
+
+    void
+    CmdBlkid::scan_natively()
+    {
+	SignatureScanner scanner(probe_threads());
+
+	vector<SignatureScanner::Device*> unsure_devices;
+	vector<string> unsure_names;
+
+	for (SignatureScanner::Device& device : scanner.get_devices())
+	{
+	    if (device.result.status == SignatureScanner::Status::UNSURE)
+	    {
+		unsure_devices.push_back(&device);
+		unsure_names.push_back(device.name);
+	    }
+	}
+
+	// Devices the scanner cannot handle are probed by a single blkid
+	// call.
+
+	if (!unsure_devices.empty())
+	{
+	    run(unsure_names);
+
+	    for (SignatureScanner::Device* device : unsure_devices)
+	    {
+		const_iterator it = data.find(device->name);
+		SignatureScanner::resolve(*device, it != data.end() ? &it->second : nullptr);
+	    }
+	}
+
+	data.clear();
+
+	for (const SignatureScanner::Device& device : scanner.get_devices())
+	{
+	    if (device.result.status == SignatureScanner::Status::FOUND)
+		data[device.name] = device.result.entry;
+	}
+
+	y2mil(*this);
     }
 
 
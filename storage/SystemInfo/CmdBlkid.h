@@ -115,6 +115,17 @@ namespace storage
 
 	CmdBlkid(Udevadm& udevadm, const std::optional<string>& device);
 
+	/**
+	 * Runs blkid for the devices or for all devices if empty.
+	 */
+	void run(const vector<string>& devices);
+
+	/**
+	 * Uses the SignatureScanner and runs blkid only for the devices the
+	 * scanner is unsure about.
+	 */
+	void scan_natively();
+
 	void parse(const vector<string>& lines);
 	void parse_json(const vector<string>& lines);
 
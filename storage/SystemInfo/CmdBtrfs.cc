@@ -179,6 +179,25 @@ namespace storage
     }
 
 
+    CmdBtrfsSubvolumeList::CmdBtrfsSubvolumeList(const BtrfsIoctl::Subvolumes& subvolumes)
+    {
+	for (const BtrfsIoctl::Subvolume& subvolume : subvolumes.subvolumes)
+	{
+	    Entry entry;
+
+	    entry.id = subvolume.id;
+	    entry.parent_id = subvolume.parent_id;
+	    entry.path = subvolume.path;
+	    entry.uuid = subvolume.uuid;
+	    entry.parent_uuid = subvolume.parent_uuid;
+
+	    data.push_back(entry);
+	}
+
+	y2mil(*this);
+    }
+
+
     void
     CmdBtrfsSubvolumeList::parse(const vector<string>& lines)
     {
@@ -283,6 +302,13 @@ namespace storage
     }
 
 
+    CmdBtrfsSubvolumeShow::CmdBtrfsSubvolumeShow(const BtrfsIoctl::Subvolumes& subvolumes)
+	: uuid(subvolumes.top_level_uuid)
+    {
+	y2mil(*this);
+    }
+
+
     void
     CmdBtrfsSubvolumeShow::parse(const vector<string>& lines)
     {
@@ -345,6 +371,13 @@ namespace storage
     }
 
 
+    CmdBtrfsSubvolumeGetDefault::CmdBtrfsSubvolumeGetDefault(const BtrfsIoctl::Subvolumes& subvolumes)
+	: id(subvolumes.default_id)
+    {
+	y2mil(*this);
+    }
+
+
     void
     CmdBtrfsSubvolumeGetDefault::parse(const vector<string>& lines)
     {
@@ -34,6 +34,7 @@
 #include "storage/Filesystems/BtrfsQgroupImpl.h"
 #include "storage/Utils/JsonFile.h"
 #include "storage/Utils/Udev.h"
+#include "storage/Utils/BtrfsIoctl.h"
 
 
 namespace storage
@@ -118,6 +119,11 @@ namespace storage
 
 	CmdBtrfsSubvolumeList(const key_t& key, const string& mount_point);
 
+	/**
+	 * Constructor using the information read by ioctls.
+	 */
+	CmdBtrfsSubvolumeList(const BtrfsIoctl::Subvolumes& subvolumes);
+
 	/**
 	 * Entry for every subvolume (unfortunately except the top-level).
 	 *
@@ -166,6 +172,11 @@ namespace storage
 
 	CmdBtrfsSubvolumeShow(const key_t& key, const string& mount_point);
 
+	/**
+	 * Constructor using the information read by ioctls.
+	 */
+	CmdBtrfsSubvolumeShow(const BtrfsIoctl::Subvolumes& subvolumes);
+
 	const string& get_uuid() const { return uuid; }
 
 	friend std::ostream& operator<<(std::ostream& s, const CmdBtrfsSubvolumeShow&
@@ -192,6 +203,11 @@ namespace storage
 
 	CmdBtrfsSubvolumeGetDefault(const key_t& key, const string& mount_point);
 
+	/**
+	 * Constructor using the information read by ioctls.
+	 */
+	CmdBtrfsSubvolumeGetDefault(const BtrfsIoctl::Subvolumes& subvolumes);
+
 	long get_id() const { return id; }
 
 	friend std::ostream& operator<<(std::ostream& s, const CmdBtrfsSubvolumeGetDefault&
@@ -28,7 +28,9 @@
 #include "storage/Utils/StorageDefines.h"
 #include "storage/Utils/StorageTmpl.h"
 #include "storage/SystemInfo/CmdCryptsetup.h"
+#include "storage/SystemInfo/CryptHeaderReader.h"
 #include "storage/Devices/EncryptionImpl.h"
+#include "storage/EnvironmentImpl.h"
 
 
 namespace storage
@@ -99,12 +101,51 @@ namespace storage
     CmdCryptsetupLuksDump::CmdCryptsetupLuksDump(const string& name)
 	: name(name)
     {
+	if (crypt_header_reader() && native_access_possible())
+	{
+	    try
+	    {
+		if (read_natively())
+		    return;
+	    }
+	    catch (const Exception& exception)
+	    {
+		ST_CAUGHT(exception);
+	    }
+
+	    y2mil("using cryptsetup luksDump for " << name);
+	}
+
 	SystemCmd cmd({ CRYPTSETUP_BIN, "luksDump", name }, SystemCmd::DoThrow);
 
 	parse(cmd.stdout());
     }
 
 
+    bool
+    CmdCryptsetupLuksDump::read_natively()
+    {
+	const CryptHeaderReader reader(name);
+	if (!reader.is_supported())
+	    return false;
+
+	if (reader.get_encryption_type() != EncryptionType::LUKS1 &&
+	    reader.get_encryption_type() != EncryptionType::LUKS2)
+	    return false;
+
+	uuid = reader.get_uuid();
+	encryption_type = reader.get_encryption_type();
+	cipher = reader.get_cipher();
+	key_size = reader.get_key_size();
+	pbkdf = reader.get_pbkdf();
+	integrity = reader.get_integrity();
+
+	y2mil(*this);
+
+	return true;
+    }
+
+
     void
     CmdCryptsetupLuksDump::parse(const vector<string>& lines)
     {
@@ -292,12 +333,44 @@ namespace storage
     CmdCryptsetupBitlkDump::CmdCryptsetupBitlkDump(const string& name)
 	: name(name)
     {
+	if (crypt_header_reader() && native_access_possible())
+	{
+	    try
+	    {
+		if (read_natively())
+		    return;
+	    }
+	    catch (const Exception& exception)
+	    {
+		ST_CAUGHT(exception);
+	    }
+
+	    y2mil("using cryptsetup bitlkDump for " << name);
+	}
+
 	SystemCmd cmd({ CRYPTSETUP_BIN, "bitlkDump", name }, SystemCmd::DoThrow);
 
 	parse(cmd.stdout());
     }
 
 
+    bool
+    CmdCryptsetupBitlkDump::read_natively()
+    {
+	const CryptHeaderReader reader(name);
+	if (!reader.is_supported() || reader.get_encryption_type() != EncryptionType::BITLOCKER)
+	    return false;
+
+	uuid = reader.get_uuid();
+	cipher = reader.get_cipher();
+	key_size = reader.get_key_size();
+
+	y2mil(*this);
+
+	return true;
+    }
+
+
     void
     CmdCryptsetupBitlkDump::parse(const vector<string>& lines)
     {
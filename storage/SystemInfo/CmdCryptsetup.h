@@ -78,6 +78,12 @@ namespace storage
 
     private:
 
+	/**
+	 * Reads the header using CryptHeaderReader. Returns false if that
+	 * is not possible.
+	 */
+	bool read_natively();
+
 	void parse(const vector<string>& lines);
 
 	void parse_version1(const vector<string>& lines);
@@ -132,6 +138,12 @@ namespace storage
 
     private:
 
+	/**
+	 * Reads the metadata using CryptHeaderReader. Returns false if that
+	 * is not possible.
+	 */
+	bool read_natively();
+
 	void parse(const vector<string>& lines);
 
 	string name;
@@ -50,6 +50,13 @@ namespace storage
     }
 
 
+    CmdLsattr::CmdLsattr(const string& mount_point, const string& path, bool nocow)
+	: mount_point(mount_point), path(path), nocow(nocow)
+    {
+	y2mil(*this);
+    }
+
+
     void
     CmdLsattr::parse(const vector<string>& lines)
     {
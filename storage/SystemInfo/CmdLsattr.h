@@ -43,6 +43,11 @@ namespace storage
 
 	CmdLsattr(const key_t& key, const string& mount_point, const string& path);
 
+	/**
+	 * Constructor for a nocow attribute read by an ioctl.
+	 */
+	CmdLsattr(const string& mount_point, const string& path, bool nocow);
+
 	bool is_nocow() const { return nocow; }
 
 	friend std::ostream& operator<<(std::ostream& s, const CmdLsattr& cmd_lsattr);
@@ -42,24 +42,38 @@ namespace storage
     using namespace std;
 
 
-    void
-    CmdLvm::parse(const vector<string>& lines, const char* tag)
+    namespace
     {
-	JsonFile json_file(lines);
 
-	vector<json_object*> tmp1;
-	if (get_child_nodes(json_file.get_root(), "report", tmp1))
+	vector<json_object*>
+	get_report_objects(json_object* root, const char* tag)
 	{
-	    for (json_object* tmp2 : tmp1)
+	    vector<json_object*> ret;
+
+	    vector<json_object*> tmp1;
+	    if (get_child_nodes(root, "report", tmp1))
 	    {
-		vector<json_object*> tmp3;
-		if (get_child_nodes(tmp2, tag, tmp3))
+		for (json_object* tmp2 : tmp1)
 		{
-		    for (json_object* tmp4 : tmp3)
-			parse(tmp4);
+		    vector<json_object*> tmp3;
+		    if (get_child_nodes(tmp2, tag, tmp3))
+			ret.insert(ret.end(), tmp3.begin(), tmp3.end());
 		}
 	    }
+
+	    return ret;
 	}
+
+    }
+
+
+    void
+    CmdLvm::parse(string_view data, const char* tag)
+    {
+	JsonFile json_file(data);
+
+	for (json_object* object : get_report_objects(json_file.get_root(), tag))
+	    parse(object);
     }
 
 
@@ -68,30 +82,48 @@ namespace storage
 
     CmdPvs::CmdPvs()
     {
-	SystemCmd cmd({ PVS_BIN, COMMON_LVM_OPTIONS, "--all", "--options",  PVS_OPTIONS }, SystemCmd::DoThrow);
+	SystemCmd::Options options({ PVS_BIN, COMMON_LVM_OPTIONS, "--all", "--options",  PVS_OPTIONS },
+				   SystemCmd::DoThrow);
+	options.contiguous_stdout = true;
 
-	parse(cmd.stdout());
+	SystemCmd cmd(options);
+
+	parse(cmd.stdout_buffer());
     }
 
 
     CmdPvs::CmdPvs(const string& pv_name)
     {
-	SystemCmd cmd({ PVS_BIN, COMMON_LVM_OPTIONS, "--all", "--options", PVS_OPTIONS, pv_name },
-		      SystemCmd::DoThrow);
+	SystemCmd::Options options({ PVS_BIN, COMMON_LVM_OPTIONS, "--all", "--options", PVS_OPTIONS, pv_name },
+				   SystemCmd::DoThrow);
+	options.contiguous_stdout = true;
+
+	SystemCmd cmd(options);
 
-	parse(cmd.stdout());
+	parse(cmd.stdout_buffer());
 
 	if (pvs.size() != 1)
 	    ST_THROW(Exception("command pvs returned wrong number of pvs"));
     }
 
 
+    CmdPvs::CmdPvs(const CmdLvmFullreport& cmd_lvm_fullreport)
+    {
+	for (json_object* object : cmd_lvm_fullreport.get_objects("pv"))
+	    parse(object);
+
+	sort(pvs.begin(), pvs.end(), [](const Pv& lhs, const Pv& rhs) { return lhs.pv_name < rhs.pv_name; });
+
+	y2mil(*this);
+    }
+
+
     void
-    CmdPvs::parse(const vector<string>& lines)
+    CmdPvs::parse(string_view data)
     {
 	pvs.clear();
 
-	CmdLvm::parse(lines, "pv");
+	CmdLvm::parse(data, "pv");
 
 	sort(pvs.begin(), pvs.end(), [](const Pv& lhs, const Pv& rhs) { return lhs.pv_name < rhs.pv_name; });
 
@@ -176,18 +208,25 @@ namespace storage
 	// Note: Querying segtype, origin, origin_uuid and origin_size is rather new and
 	// not available in all testsuite data.
 
-	SystemCmd cmd({ LVS_BIN, COMMON_LVM_OPTIONS, "--all", "--options", LVS_OPTIONS }, SystemCmd::DoThrow);
+	SystemCmd::Options options({ LVS_BIN, COMMON_LVM_OPTIONS, "--all", "--options", LVS_OPTIONS },
+				   SystemCmd::DoThrow);
+	options.contiguous_stdout = true;
+
+	SystemCmd cmd(options);
 
-	parse(cmd.stdout());
+	parse(cmd.stdout_buffer());
     }
 
 
     CmdLvs::CmdLvs(const string& vg_name, const string& lv_name)
     {
-	SystemCmd cmd({ LVS_BIN, COMMON_LVM_OPTIONS, "--all", "--options", LVS_OPTIONS, "--",
+	SystemCmd::Options options({ LVS_BIN, COMMON_LVM_OPTIONS, "--all", "--options", LVS_OPTIONS, "--",
 		vg_name + "/" + lv_name }, SystemCmd::DoThrow);
+	options.contiguous_stdout = true;
 
-	parse(cmd.stdout());
+	SystemCmd cmd(options);
+
+	parse(cmd.stdout_buffer());
 
 	if (lvs.size() != 1)
 	    ST_THROW(Exception("command lvs returned wrong number of lvs"));
@@ -202,12 +241,52 @@ namespace storage
     }
 
 
+    CmdLvs::CmdLvs(const CmdLvmFullreport& cmd_lvm_fullreport)
+    {
+	// In the full report the segments are not part of the LVs but
+	// reported separately.
+
+	map<string, vector<json_object*>> segments;
+
+	for (json_object* object : cmd_lvm_fullreport.get_objects("seg"))
+	{
+	    string lv_uuid;
+	    get_child_value(object, "lv_uuid", lv_uuid);
+
+	    segments[lv_uuid].push_back(object);
+	}
+
+	for (json_object* object : cmd_lvm_fullreport.get_objects("lv"))
+	{
+	    string lv_uuid;
+	    get_child_value(object, "lv_uuid", lv_uuid);
+
+	    const vector<json_object*>& tmp = segments[lv_uuid];
+
+	    string segtype;
+	    if (!tmp.empty())
+		get_child_value(tmp.front(), "segtype", segtype);
+
+	    Lv lv = parse_lv(object, segtype);
+
+	    for (json_object* segment : tmp)
+		lv.segments.push_back(parse_segment(segment));
+
+	    lvs.push_back(lv);
+	}
+
+	sort(lvs.begin(), lvs.end(), [](const Lv& lhs, const Lv& rhs) { return lhs.lv_name < rhs.lv_name; });
+
+	y2mil(*this);
+    }
+
+
     void
-    CmdLvs::parse(const vector<string>& lines)
+    CmdLvs::parse(string_view data)
     {
 	lvs.clear();
 
-	CmdLvm::parse(lines, "lv");
+	CmdLvm::parse(data, "lv");
 
 	sort(lvs.begin(), lvs.end(), [](const Lv& lhs, const Lv& rhs) { return lhs.lv_name < rhs.lv_name; });
 
@@ -217,9 +296,37 @@ namespace storage
 
     void
     CmdLvs::parse(json_object* object)
+    {
+	string segtype;
+	get_child_value(object, "segtype", segtype);
+
+	Lv lv = parse_lv(object, segtype);
+	Segment segment = parse_segment(object);
+
+	// The stripes and chunksize options makes lvs print every segment of
+	// a LV. Depending on whether the LV is already in lvs, either add the
+	// complete LV or only the segment to the already existing LV.
+
+	vector<Lv>::iterator it = find_if(lvs.begin(), lvs.end(), [lv](const Lv& tmp) {
+	    return lv.lv_uuid == tmp.lv_uuid;
+	});
+
+	if (it == lvs.end())
+	{
+	    lv.segments.push_back(segment);
+	    lvs.push_back(lv);
+	}
+	else
+	{
+	    it->segments.push_back(segment);
+	}
+    }
+
+
+    CmdLvs::Lv
+    CmdLvs::parse_lv(json_object* object, const string& segtype) const
     {
 	Lv lv;
-	Segment segment;
 
 	get_child_value(object, "lv_name", lv.lv_name);
 	get_child_value(object, "lv_uuid", lv.lv_uuid);
@@ -253,8 +360,6 @@ namespace storage
 	    case 'o':
 	    case 'C':
 	    {
-		string segtype;
-		get_child_value(object, "segtype", segtype);
 		if (segtype.empty())
 		    ST_THROW(ParseException("bad segtype", segtype, "linear"));
 
@@ -286,28 +391,21 @@ namespace storage
 	get_child_value(object, "metadata_lv", lv.metadata_name);
 	get_child_value(object, "metadata_lv_uuid", lv.metadata_uuid);
 
+	return lv;
+    }
+
+
+    CmdLvs::Segment
+    CmdLvs::parse_segment(json_object* object) const
+    {
+	Segment segment;
+
 	get_child_value(object, "stripes", segment.stripes);
 	get_child_value(object, "stripe_size", segment.stripe_size);
 
 	get_child_value(object, "chunk_size", segment.chunk_size);
 
-	// The stripes and chunksize options makes lvs print every segment of
-	// a LV. Depending on whether the LV is already in lvs, either add the
-	// complete LV or only the segment to the already existing LV.
-
-	vector<Lv>::iterator it = find_if(lvs.begin(), lvs.end(), [lv](const Lv& tmp) {
-	    return lv.lv_uuid == tmp.lv_uuid;
-	});
-
-	if (it == lvs.end())
-	{
-	    lv.segments.push_back(segment);
-	    lvs.push_back(lv);
-	}
-	else
-	{
-	    it->segments.push_back(segment);
-	}
+	return segment;
     }
 
 
@@ -413,18 +511,24 @@ namespace storage
 
     CmdVgs::CmdVgs()
     {
-	SystemCmd cmd({ VGS_BIN, COMMON_LVM_OPTIONS, "--options", VGS_OPTIONS }, SystemCmd::DoThrow);
+	SystemCmd::Options options({ VGS_BIN, COMMON_LVM_OPTIONS, "--options", VGS_OPTIONS }, SystemCmd::DoThrow);
+	options.contiguous_stdout = true;
+
+	SystemCmd cmd(options);
 
-	parse(cmd.stdout());
+	parse(cmd.stdout_buffer());
     }
 
 
     CmdVgs::CmdVgs(const string& vg_name)
     {
-	SystemCmd cmd({ VGS_BIN, COMMON_LVM_OPTIONS, "--options", VGS_OPTIONS, "--", vg_name },
-		SystemCmd::DoThrow);
+	SystemCmd::Options options({ VGS_BIN, COMMON_LVM_OPTIONS, "--options", VGS_OPTIONS, "--", vg_name },
+				   SystemCmd::DoThrow);
+	options.contiguous_stdout = true;
 
-	parse(cmd.stdout());
+	SystemCmd cmd(options);
+
+	parse(cmd.stdout_buffer());
 
 	if (vgs.size() != 1)
 	    ST_THROW(Exception("command vgs returned wrong number of vgs"));
@@ -436,12 +540,23 @@ namespace storage
     }
 
 
+    CmdVgs::CmdVgs(const CmdLvmFullreport& cmd_lvm_fullreport)
+    {
+	for (json_object* object : cmd_lvm_fullreport.get_objects("vg"))
+	    parse(object);
+
+	sort(vgs.begin(), vgs.end(), [](const Vg& lhs, const Vg& rhs) { return lhs.vg_name < rhs.vg_name; });
+
+	y2mil(*this);
+    }
+
+
     void
-    CmdVgs::parse(const vector<string>& lines)
+    CmdVgs::parse(string_view data)
     {
 	vgs.clear();
 
-	CmdLvm::parse(lines, "vg");
+	CmdLvm::parse(data, "vg");
 
 	sort(vgs.begin(), vgs.end(), [](const Vg& lhs, const Vg& rhs) { return lhs.vg_name < rhs.vg_name; });
 
@@ -457,6 +572,11 @@ namespace storage
 	get_child_value(object, "vg_name", vg.vg_name);
 	get_child_value(object, "vg_uuid", vg.vg_uuid);
 
+	// The full report also contains a report for the orphan PVs.
+
+	if (vg.vg_uuid.empty())
+	    return;
+
 	string vg_attr;
 	get_child_value(object, "vg_attr", vg_attr);
 	if (vg_attr.size() < 6)
@@ -503,4 +623,35 @@ namespace storage
 	return s;
     }
 
+
+
+#define FULLREPORT_LV_OPTIONS "lv_name,lv_uuid,vg_name,vg_uuid,lv_role,lv_attr,lv_size,origin_size,"	\
+	"pool_lv,pool_lv_uuid,origin,origin_uuid,data_lv,data_lv_uuid,metadata_lv,metadata_lv_uuid"
+
+#define FULLREPORT_SEG_OPTIONS "lv_uuid,segtype,stripes,stripe_size,chunk_size"
+
+
+    CmdLvmFullreport::CmdLvmFullreport()
+    {
+	SystemCmd::Options options({ LVM_BIN, "fullreport", COMMON_LVM_OPTIONS, "--all",
+		"--configreport", "pv", "--options", PVS_OPTIONS, "--configreport", "vg", "--options",
+		VGS_OPTIONS, "--configreport", "lv", "--options", FULLREPORT_LV_OPTIONS,
+		"--configreport", "seg", "--options", FULLREPORT_SEG_OPTIONS }, SystemCmd::DoThrow);
+	options.contiguous_stdout = true;
+
+	SystemCmd cmd(options);
+
+	json_file = make_unique<JsonFile>(string_view(cmd.stdout_buffer()));
+    }
+
+
+    CmdLvmFullreport::~CmdLvmFullreport() = default;
+
+
+    vector<json_object*>
+    CmdLvmFullreport::get_objects(const char* tag) const
+    {
+	return get_report_objects(json_file->get_root(), tag);
+    }
+
 }
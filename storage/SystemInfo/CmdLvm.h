@@ -26,7 +26,9 @@
 
 
 #include <string>
+#include <string_view>
 #include <vector>
+#include <memory>
 
 #include "storage/Devices/LvmLv.h"
 #include "storage/Utils/JsonFile.h"
@@ -35,16 +37,20 @@
 namespace storage
 {
     using std::string;
+    using std::string_view;
     using std::vector;
 
 
+    class CmdLvmFullreport;
+
+
     class CmdLvm
     {
     protected:
 
 	virtual ~CmdLvm() = default;
 
-	void parse(const vector<string>& lines, const char* tag);
+	void parse(string_view data, const char* tag);
 	virtual void parse(json_object* object) = 0;
 
     };
@@ -56,6 +62,7 @@ namespace storage
 
 	CmdPvs();
 	CmdPvs(const string& pv_name);
+	CmdPvs(const CmdLvmFullreport& cmd_lvm_fullreport);
 
 	struct Pv
 	{
@@ -78,7 +85,7 @@ namespace storage
 
     private:
 
-	void parse(const vector<string>& lines);
+	void parse(string_view data);
 	virtual void parse(json_object* object) override;
 
 	vector<Pv> pvs;
@@ -92,6 +99,7 @@ namespace storage
 
 	CmdLvs();
 	CmdLvs(const string& vg_name, const string& lv_name);
+	CmdLvs(const CmdLvmFullreport& cmd_lvm_fullreport);
 
 	/**
 	 * Enum to represent the role reported by lvs. So far only
@@ -141,8 +149,10 @@ namespace storage
 
     private:
 
-	void parse(const vector<string>& lines);
+	void parse(string_view data);
 	virtual void parse(json_object* object) override;
+	Lv parse_lv(json_object* object, const string& segtype) const;
+	Segment parse_segment(json_object* object) const;
 	Role parse_role(const string& role) const;
 
 	vector<Lv> lvs;
@@ -156,6 +166,7 @@ namespace storage
 
 	CmdVgs();
 	CmdVgs(const string& vg_name);
+	CmdVgs(const CmdLvmFullreport& cmd_lvm_fullreport);
 
 	struct Vg
 	{
@@ -175,13 +186,38 @@ namespace storage
 
     private:
 
-	void parse(const vector<string>& lines);
+	void parse(string_view data);
 	virtual void parse(json_object* object) override;
 
 	vector<Vg> vgs;
 
     };
 
+
+    /**
+     * Runs 'lvm fullreport' to get the PVs, VGs, LVs and segments with a
+     * single scan of the LVM metadata. CmdPvs, CmdVgs and CmdLvs can be
+     * constructed from the report.
+     */
+    class CmdLvmFullreport
+    {
+    public:
+
+	CmdLvmFullreport();
+	~CmdLvmFullreport();
+
+	/**
+	 * Returns the objects of the given subreport, e.g. "pv" or "seg", of
+	 * all reports.
+	 */
+	vector<json_object*> get_objects(const char* tag) const;
+
+    private:
+
+	std::unique_ptr<JsonFile> json_file;
+
+    };
+
 }
 
 #endif
@@ -35,6 +35,7 @@
 #include "storage/Devices/PartitionTable.h"
 #include "storage/Utils/Format.h"
 #include "storage/EnvironmentImpl.h"
+#include "storage/SystemInfo/PartitionTableReader.h"
 
 
 namespace storage
@@ -45,12 +46,29 @@ namespace storage
     CmdParted::CmdParted(Udevadm& udevadm, const string& device)
 	: device(device)
     {
+	if (partition_table_reader() && native_access_possible())
+	{
+	    try
+	    {
+		if (read_natively())
+		    return;
+	    }
+	    catch (const Exception& exception)
+	    {
+		ST_CAUGHT(exception);
+	    }
+
+	    y2mil("using parted for " << device);
+	}
+
 	const bool json = CmdPartedVersion::supports_json_option();
 
 	SystemCmd::Options options({ PARTED_BIN, "--script", json ? "--json" : "--machine", device,
 		"unit", "s", "print" }, SystemCmd::DoThrow);
 	options.verify = [](int) { return true; };
-	if (!json)
+	if (json)
+	    options.contiguous_stdout = true;
+	else
 	    options.setenv("PARTED_PRINT_NUMBER_OF_PARTITION_SLOTS", "1");
 
 	SystemCmd cmd(options);
@@ -80,60 +98,102 @@ namespace storage
 	    }
 	}
 
-	parse(cmd.stdout(), cmd.stderr());
+	if (json)
+	    parse(cmd.stdout_buffer(), cmd.stderr());
+	else
+	    parse(cmd.stdout(), cmd.stderr());
 
 	if (CmdPartedVersion::print_triggers_udev())
 	    udevadm.set_settle_needed();
     }
 
 
+    bool
+    CmdParted::read_natively()
+    {
+	const PartitionTableReader reader(device);
+	if (!reader.is_supported())
+	    return false;
+
+	label = reader.get_label();
+	region = reader.get_region();
+	primary_slots = reader.get_primary_slots();
+	gpt_undersized = reader.is_gpt_undersized();
+	gpt_backup_broken = reader.is_gpt_backup_broken();
+	gpt_pmbr_boot = reader.is_gpt_pmbr_boot();
+	entries = reader.get_entries();
+
+	y2mil(*this);
+
+	return true;
+    }
+
+
     void
-    CmdParted::parse(const vector<string>& stdout, const vector<string>& stderr)
+    CmdParted::parse(string_view stdout, const vector<string>& stderr)
     {
-	primary_slots = -1;
-	implicit = false;
-	gpt_undersized = false;
-	gpt_backup_broken = false;
-	gpt_pmbr_boot = false;
-	entries.clear();
+	clear();
 
-	if (CmdPartedVersion::supports_json_option())
-	{
-	    JsonFile json_file(stdout);
+	JsonFile json_file(stdout);
 
-	    json_object* tmp1;
-	    if (!get_child_node(json_file.get_root(), "disk", tmp1))
-		ST_THROW(Exception("\"disk\" not found in json output of 'parted'"));
+	json_object* tmp1;
+	if (!get_child_node(json_file.get_root(), "disk", tmp1))
+	    ST_THROW(Exception("\"disk\" not found in json output of 'parted'"));
 
-	    scan_device(tmp1);
+	scan_device(tmp1);
 
-	    if (label != PtType::UNKNOWN && label != PtType::LOOP)
-	    {
-		vector<json_object*> tmp2;
-		if (!get_child_nodes(tmp1, "partitions", tmp2))
-		    ST_THROW(Exception("\"partitions\" not found in json output of 'parted'"));
+	if (label != PtType::UNKNOWN && label != PtType::LOOP)
+	{
+	    vector<json_object*> tmp2;
+	    if (!get_child_nodes(tmp1, "partitions", tmp2))
+		ST_THROW(Exception("\"partitions\" not found in json output of 'parted'"));
 
-		for (json_object* tmp3 : tmp2)
-		    scan_entry(tmp3);
-	    }
+	    for (json_object* tmp3 : tmp2)
+		scan_entry(tmp3);
 	}
-	else
-	{
-	    if (stdout.size() < 2)
-		ST_THROW(Exception("wrong number of lines"));
 
-	    if (stdout[0] != "BYT;")
-		ST_THROW(ParseException("Bad first line", stdout[0], "BYT;"));
+	finish(stderr);
+    }
 
-	    scan_device_line(stdout[1]);
 
-	    if (label != PtType::UNKNOWN && label != PtType::LOOP)
-	    {
-		for (size_t i = 2; i < stdout.size(); ++i)
-		    scan_entry_line(stdout[i]);
-	    }
+    void
+    CmdParted::parse(const vector<string>& stdout, const vector<string>& stderr)
+    {
+	clear();
+
+	if (stdout.size() < 2)
+	    ST_THROW(Exception("wrong number of lines"));
+
+	if (stdout[0] != "BYT;")
+	    ST_THROW(ParseException("Bad first line", stdout[0], "BYT;"));
+
+	scan_device_line(stdout[1]);
+
+	if (label != PtType::UNKNOWN && label != PtType::LOOP)
+	{
+	    for (size_t i = 2; i < stdout.size(); ++i)
+		scan_entry_line(stdout[i]);
 	}
 
+	finish(stderr);
+    }
+
+
+    void
+    CmdParted::clear()
+    {
+	primary_slots = -1;
+	implicit = false;
+	gpt_undersized = false;
+	gpt_backup_broken = false;
+	gpt_pmbr_boot = false;
+	entries.clear();
+    }
+
+
+    void
+    CmdParted::finish(const vector<string>& stderr)
+    {
 	scan_stderr(stderr);
 
 	fix_dasd_sector_size();
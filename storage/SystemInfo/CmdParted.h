@@ -34,6 +34,7 @@
 namespace storage
 {
     using std::string;
+    using std::string_view;
     using std::vector;
     using std::map;
 
@@ -50,6 +51,10 @@ namespace storage
 	 * Constructor: Probe the specified device
 	 * with the 'parted' command and parse its output.
 	 * This may throw a SystemCmdException or a ParseException.
+	 *
+	 * If enabled MS-DOS and GPT partition tables are read natively
+	 * instead, see PartitionTableReader. parted is still used for all
+	 * other cases.
 	 */
 	CmdParted(Udevadm& udevadm, const string& device);
 
@@ -168,11 +173,30 @@ namespace storage
 	int physical_sector_size = 0;
 
 	/**
-	 * Parse the output of the 'parted' command in 'lines'.
+	 * Read the partition table with the PartitionTableReader instead of
+	 * running parted. Returns false if the reader does not support the
+	 * partition table.
+	 */
+	bool read_natively();
+
+	/**
+	 * Parse the json output of the 'parted' command in 'stdout'.
+	 */
+	void parse(string_view stdout, const vector<string>& stderr);
+
+	/**
+	 * Parse the machine output of the 'parted' command in 'stdout'.
 	 * This may throw a ParseException.
 	 */
 	void parse(const vector<string>& stdout, const vector<string>& stderr);
 
+	void clear();
+
+	/**
+	 * Common final steps of both parse functions.
+	 */
+	void finish(const vector<string>& stderr);
+
 	/**
 	 * parted reports wrong sector sizes on DASDs, see
 	 * https://bugzilla.suse.com/show_bug.cgi?id=866535 and
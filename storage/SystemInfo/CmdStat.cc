@@ -22,6 +22,8 @@
 
 #include "storage/Utils/LoggerImpl.h"
 #include "storage/Utils/SystemCmd.h"
+#include "storage/Utils/Mockup.h"
+#include "storage/Utils/Format.h"
 #include "storage/Utils/StorageDefines.h"
 #include "storage/SystemInfo/CmdStat.h"
 
@@ -43,6 +45,24 @@ namespace storage
     }
 
 
+    CmdStat::CmdStat(const string& path, mode_t mode)
+	: path(path), mode(mode)
+    {
+	if (Mockup::get_mode() == Mockup::Mode::RECORD)
+	{
+	    Mockup::Command command;
+	    if (mode != 0)
+		command.stdout = { sformat("%x", mode) };
+	    else
+		command.exit_code = 1;
+
+	    Mockup::set_command({ STAT_BIN, "--format", "%f", path }, command);
+	}
+
+	y2mil(*this);
+    }
+
+
     void
     CmdStat::parse(const vector<string>& lines)
     {
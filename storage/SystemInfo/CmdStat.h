@@ -44,6 +44,12 @@ namespace storage
 
 	CmdStat(const string& path);
 
+	/**
+	 * Constructs the object from the mode, e.g. from lstat(2). A mode of 0
+	 * means the path does not exist.
+	 */
+	CmdStat(const string& path, mode_t mode);
+
 	bool is_blk() const { return S_ISBLK(mode); }
 	bool is_dir() const { return S_ISDIR(mode); }
 	bool is_reg() const { return S_ISREG(mode); }
@@ -60,6 +60,13 @@ namespace storage
     }
 
 
+    CmdUdevadmInfo::CmdUdevadmInfo(const string& file, const vector<string>& lines)
+	: file(file)
+    {
+	parse(lines);
+    }
+
+
     void
     CmdUdevadmInfo::parse(const vector<string>& stdout)
     {
@@ -124,8 +131,8 @@ namespace storage
     }
 
 
-    bool
-    CmdUdevadmInfo::is_alias_of(const string& file) const
+    vector<string>
+    CmdUdevadmInfo::get_aliases() const
     {
 	struct Link
 	{
@@ -143,12 +150,20 @@ namespace storage
 	    { DEV_MAPPER_DIR "/", mapper_links },
 	};
 
+	vector<string> aliases;
+
 	for (const Link& link : links)
 	    for (const string& tmp : link.variable)
-		if (link.prefix + tmp == file)
-		    return true;
+		aliases.push_back(link.prefix + tmp);
+
+	return aliases;
+    }
+
 
-	return false;
+    bool
+    CmdUdevadmInfo::is_alias_of(const string& file) const
+    {
+	return contains(get_aliases(), file);
     }
 
 
@@ -186,4 +201,61 @@ namespace storage
 	return s;
     }
 
+
+
+    CmdUdevadmExportDb::CmdUdevadmExportDb(Udevadm& udevadm)
+    {
+	// See CmdUdevadmInfo::CmdUdevadmInfo().
+	udevadm.settle();
+
+	SystemCmd::Options options({ UDEVADM_BIN, "info", "--export-db" }, SystemCmd::DoThrow);
+	options.unsetenv("SYSTEMD_COLORS");
+
+	SystemCmd cmd(options);
+
+	parse(cmd.stdout());
+    }
+
+
+    void
+    CmdUdevadmExportDb::parse(const vector<string>& stdout)
+    {
+	// The records are separated by empty lines. Only block devices with a
+	// device node are of interest.
+
+	vector<string> record;
+	string name;
+	bool block = false;
+
+	auto flush = [this, &record, &name, &block]() {
+	    if (block && !name.empty())
+		infos.emplace_back(DEV_DIR "/" + name, record);
+
+	    record.clear();
+	    name.clear();
+	    block = false;
+	};
+
+	for (const string& line : stdout)
+	{
+	    if (line.empty())
+	    {
+		flush();
+		continue;
+	    }
+
+	    if (boost::starts_with(line, "N: "))
+		name = line.substr(strlen("N: "));
+
+	    if (line == "E: SUBSYSTEM=block")
+		block = true;
+
+	    record.push_back(line);
+	}
+
+	flush();
+
+	y2mil("found " << infos.size() << " block devices in udev database");
+    }
+
 }
@@ -49,6 +49,12 @@ namespace storage
 
 	CmdUdevadmInfo(Udevadm& udevadm, const string& file);
 
+	/**
+	 * Constructs the object from the lines of a single record, e.g. taken from
+	 * the output of 'udevadm info --export-db'.
+	 */
+	CmdUdevadmInfo(const string& file, const vector<string>& lines);
+
 	const string& get_path() const { return path; }
 	const string& get_name() const { return name; }
 
@@ -62,6 +68,12 @@ namespace storage
 	const vector<string>& get_by_id_links() const { return by_id_links; }
 	const vector<string>& get_by_partuuid_links() const { return by_partuuid_links; }
 
+	/**
+	 * Returns all links of the device including the directory, e.g.
+	 * "/dev/disk/by-id/wwn-0x50014ee203733bb5".
+	 */
+	vector<string> get_aliases() const;
+
 	bool is_alias_of(const string& file) const;
 
 	friend std::ostream& operator<<(std::ostream& s, const CmdUdevadmInfo& cmd_udevadm_info);
@@ -89,6 +101,31 @@ namespace storage
 
     };
 
+
+
+    /**
+     * Runs 'udevadm info --export-db' and keeps the information of all block
+     * devices with a device node. So a single command provides the
+     * information otherwise provided by one CmdUdevadmInfo per device.
+     */
+    class CmdUdevadmExportDb
+    {
+
+    public:
+
+	CmdUdevadmExportDb(Udevadm& udevadm);
+
+	const vector<CmdUdevadmInfo>& get_infos() const { return infos; }
+
+    private:
+
+	void parse(const vector<string>& stdout);
+
+	vector<CmdUdevadmInfo> infos;
+
+    };
+
+
     template <> struct EnumTraits<CmdUdevadmInfo::DeviceType> { static const vector<string> names; };
 
 }
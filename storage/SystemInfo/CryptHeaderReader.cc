@@ -0,0 +1,351 @@
+/*
+ * Copyright (c) 2026 SUSE LLC
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+#include <map>
+
+#include "storage/Utils/LoggerImpl.h"
+#include "storage/Utils/ExceptionImpl.h"
+#include "storage/Utils/Format.h"
+#include "storage/Utils/JsonFile.h"
+#include "storage/Utils/Endian.h"
+#include "storage/Utils/BlockReader.h"
+#include "storage/SystemInfo/CryptHeaderReader.h"
+
+
+namespace storage
+{
+    using namespace std;
+
+
+    namespace
+    {
+
+	/**
+	 * Returns the NUL terminated string stored in a field of the given
+	 * size. Throws if the string is not terminated.
+	 */
+	string
+	get_string(const uint8_t* p, size_t size)
+	{
+	    size_t length = strnlen((const char*)(p), size);
+	    if (length == size)
+		ST_THROW(Exception("string not terminated in header"));
+
+	    return string((const char*)(p), length);
+	}
+
+
+	/**
+	 * Formats a GUID stored in the mixed-endian on-disk format.
+	 */
+	string
+	format_guid(const uint8_t* p)
+	{
+	    string ret = sformat("%08x-%04x-%04x-", get_le32(p), get_le16(p + 4), get_le16(p + 6));
+
+	    // sformat would print uint8_t as character.
+
+	    for (int i = 8; i < 16; ++i)
+	    {
+		if (i == 10)
+		    ret += '-';
+
+		ret += sformat("%02x", (unsigned int)(p[i]));
+	    }
+
+	    return ret;
+	}
+
+
+	/**
+	 * Returns the members of a LUKS2 JSON object sorted by their
+	 * numeric key. That is the order in which cryptsetup reports the
+	 * segments and keyslots.
+	 */
+	map<unsigned long, json_object*>
+	get_numbered_children(json_object* parent)
+	{
+	    map<unsigned long, json_object*> ret;
+
+	    json_object_iterator it = json_object_iter_begin(parent);
+	    json_object_iterator end = json_object_iter_end(parent);
+
+	    for (; !json_object_iter_equal(&it, &end); json_object_iter_next(&it))
+	    {
+		const char* key = json_object_iter_peek_name(&it);
+
+		char* tmp;
+		errno = 0;
+		unsigned long number = strtoul(key, &tmp, 10);
+		if (errno != 0 || tmp == key || *tmp != '\0')
+		    ST_THROW(Exception(sformat("invalid key '%s' in LUKS2 metadata", key)));
+
+		ret[number] = json_object_iter_peek_value(&it);
+	    }
+
+	    return ret;
+	}
+
+
+	const char LUKS_MAGIC[] = "LUKS\xba\xbe";
+	const char LUKS2_SECONDARY_MAGIC[] = "SKUL\xba\xbe";
+	const size_t luks_magic_size = 6;
+
+	const size_t luks2_binary_header_size = 4096;
+	const uint64_t luks2_min_header_size = 16 * 1024;
+	const uint64_t luks2_max_header_size = 4 * 1024 * 1024;
+
+	const char BITLOCKER_SIGNATURE[] = "-FVE-FS-";
+	const size_t bitlocker_signature_size = 8;
+
+	const size_t bitlocker_fve_offset = 160;
+	const size_t bitlocker_fve_size = 112;
+
+	/**
+	 * The encryption methods of BitLocker with the cipher and the key
+	 * size in bits as reported by cryptsetup.
+	 */
+	const map<uint16_t, pair<const char*, unsigned int>> bitlocker_encryptions = {
+	    { 0x8000, { "aes-cbc-elephant", 256 } },
+	    { 0x8001, { "aes-cbc-elephant", 512 } },
+	    { 0x8002, { "aes-cbc-eboiv", 128 } },
+	    { 0x8003, { "aes-cbc-eboiv", 256 } },
+	    { 0x8004, { "aes-xts-plain64", 256 } },
+	    { 0x8005, { "aes-xts-plain64", 512 } },
+	};
+
+    }
+
+
+    CryptHeaderReader::CryptHeaderReader(const string& device)
+	: device(device)
+    {
+	const BlockReader block_reader(device);
+
+	if (block_reader.get_size() < luks2_binary_header_size)
+	{
+	    y2mil("device " << device << " too small for crypt header");
+	    return;
+	}
+
+	const vector<uint8_t> header = block_reader.read(0, luks2_binary_header_size);
+
+	if (memcmp(header.data(), LUKS_MAGIC, luks_magic_size) == 0)
+	{
+	    switch (get_be16(header.data() + 6))
+	    {
+		case 1:
+		    read_luks1(header.data());
+		    break;
+
+		case 2:
+		    read_luks2(block_reader, header.data());
+		    break;
+
+		default:
+		    y2mil("unknown LUKS version on " << device);
+	    }
+	}
+	else if (memcmp(header.data() + 3, BITLOCKER_SIGNATURE, bitlocker_signature_size) == 0)
+	{
+	    read_bitlocker(block_reader, header.data());
+	}
+	else
+	{
+	    y2mil("no supported crypt header on " << device);
+	}
+    }
+
+
+    void
+    CryptHeaderReader::read_luks1(const uint8_t* header)
+    {
+	/*
+	 * The LUKS1 header (big-endian):
+	 *    8  cipher name (32 bytes)
+	 *   40  cipher mode (32 bytes)
+	 *  108  key bytes (4 bytes)
+	 *  168  UUID (40 bytes)
+	 */
+
+	const string cipher_name = get_string(header + 8, 32);
+	const string cipher_mode = get_string(header + 40, 32);
+	const uint32_t key_bytes = get_be32(header + 108);
+
+	if (cipher_name.empty() || cipher_mode.empty() || key_bytes == 0 || key_bytes > 512)
+	{
+	    y2mil("unsupported LUKS1 header on " << device);
+	    return;
+	}
+
+	encryption_type = EncryptionType::LUKS1;
+	uuid = get_string(header + 168, 40);
+	cipher = cipher_name + "-" + cipher_mode;
+	key_size = key_bytes;
+
+	supported = true;
+    }
+
+
+    void
+    CryptHeaderReader::read_luks2(const BlockReader& block_reader, const uint8_t* header)
+    {
+	/*
+	 * The LUKS2 binary header (big-endian), see
+	 * https://gitlab.com/cryptsetup/cryptsetup/blob/master/docs/on-disk-format-luks2.pdf:
+	 *    8  header size including the JSON area (8 bytes)
+	 *   16  sequence id (8 bytes)
+	 *  168  UUID (40 bytes)
+	 *
+	 * The JSON area follows the binary header. The secondary header
+	 * follows the primary header.
+	 */
+
+	const uint64_t hdr_size = get_be64(header + 8);
+	if (hdr_size < luks2_min_header_size || hdr_size > luks2_max_header_size ||
+	    (hdr_size & (hdr_size - 1)) != 0)
+	{
+	    y2mil("unsupported LUKS2 header size on " << device);
+	    return;
+	}
+
+	const vector<uint8_t> primary = block_reader.read(0, hdr_size);
+	const vector<uint8_t> secondary = block_reader.read(hdr_size, hdr_size);
+
+	// Without verifying the checksums the primary header is only
+	// trusted if the secondary header is an identical copy. During an
+	// update or after damage cryptsetup must decide.
+
+	if (memcmp(secondary.data(), LUKS2_SECONDARY_MAGIC, luks_magic_size) != 0 ||
+	    memcmp(primary.data() + 6, secondary.data() + 6, 2 + 8 + 8) != 0 ||
+	    memcmp(primary.data() + 168, secondary.data() + 168, 40) != 0 ||
+	    memcmp(primary.data() + luks2_binary_header_size, secondary.data() + luks2_binary_header_size,
+		   hdr_size - luks2_binary_header_size) != 0)
+	{
+	    y2mil("LUKS2 headers do not match on " << device);
+	    return;
+	}
+
+	const char* json_area = (const char*)(primary.data() + luks2_binary_header_size);
+
+	JsonFile json_file(string_view(json_area, strnlen(json_area, hdr_size - luks2_binary_header_size)));
+
+	json_object* segments;
+	if (!get_child_node(json_file.get_root(), "segments", segments))
+	    ST_THROW(Exception("\"segments\" not found in LUKS2 metadata"));
+
+	string tmp_cipher;
+	string tmp_integrity;
+
+	for (const map<unsigned long, json_object*>::value_type& segment : get_numbered_children(segments))
+	{
+	    string type;
+	    if (!get_child_value(segment.second, "type", type) || type != "crypt")
+		continue;
+
+	    get_child_value(segment.second, "encryption", tmp_cipher);
+
+	    json_object* tmp;
+	    if (get_child_node(segment.second, "integrity", tmp))
+		get_child_value(tmp, "type", tmp_integrity);
+	}
+
+	if (tmp_cipher.empty())
+	{
+	    y2mil("no crypt segment in LUKS2 metadata on " << device);
+	    return;
+	}
+
+	json_object* keyslots;
+	if (!get_child_node(json_file.get_root(), "keyslots", keyslots))
+	    ST_THROW(Exception("\"keyslots\" not found in LUKS2 metadata"));
+
+	const map<unsigned long, json_object*> numbered_keyslots = get_numbered_children(keyslots);
+	if (!numbered_keyslots.empty())
+	{
+	    json_object* keyslot = numbered_keyslots.begin()->second;
+
+	    get_child_value(keyslot, "key_size", key_size);
+
+	    json_object* tmp;
+	    if (get_child_node(keyslot, "kdf", tmp))
+		get_child_value(tmp, "type", pbkdf);
+	}
+
+	encryption_type = EncryptionType::LUKS2;
+	uuid = get_string(primary.data() + 168, 40);
+	cipher = tmp_cipher;
+	integrity = tmp_integrity;
+
+	supported = true;
+    }
+
+
+    void
+    CryptHeaderReader::read_bitlocker(const BlockReader& block_reader, const uint8_t* header)
+    {
+	/*
+	 * The volume header (little-endian) has the offsets of the three
+	 * copies of the FVE metadata block at 160. The FVE metadata block:
+	 *    0  signature (8 bytes)
+	 *   10  version (2 bytes)
+	 *   80  volume GUID (16 bytes)
+	 *  100  encryption method (2 bytes)
+	 */
+
+	const uint64_t offset = get_le64(header + bitlocker_fve_offset);
+
+	const vector<uint8_t> fve = block_reader.read(offset, bitlocker_fve_size);
+
+	if (memcmp(fve.data(), BITLOCKER_SIGNATURE, bitlocker_signature_size) != 0)
+	{
+	    y2mil("invalid FVE metadata block on " << device);
+	    return;
+	}
+
+	if (get_le16(fve.data() + 10) != 2)
+	{
+	    y2mil("unsupported BitLocker version on " << device);
+	    return;
+	}
+
+	map<uint16_t, pair<const char*, unsigned int>>::const_iterator it =
+	    bitlocker_encryptions.find(get_le16(fve.data() + 100));
+	if (it == bitlocker_encryptions.end())
+	{
+	    y2mil("unknown BitLocker encryption method on " << device);
+	    return;
+	}
+
+	encryption_type = EncryptionType::BITLOCKER;
+	uuid = format_guid(fve.data() + 80);
+	cipher = it->second.first;
+	key_size = it->second.second / 8;
+
+	supported = true;
+    }
+
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2026 SUSE LLC
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+
+#ifndef STORAGE_CRYPT_HEADER_READER_H
+#define STORAGE_CRYPT_HEADER_READER_H
+
+
+#include <string>
+
+#include "storage/Devices/Encryption.h"
+
+
+namespace storage
+{
+    using std::string;
+
+    class BlockReader;
+
+
+    /**
+     * Reads the LUKS1 and LUKS2 headers and the BitLocker metadata directly
+     * from the device without running cryptsetup. Provides the same
+     * information as CmdCryptsetupLuksDump and CmdCryptsetupBitlkDump.
+     *
+     * Headers the reader cannot handle with certainty are reported as
+     * unsupported, e.g. LUKS2 headers whose primary and secondary copy do
+     * not match (the checksums are not verified), BitLocker To Go or
+     * BitLocker of Windows Vista. The caller must then use cryptsetup.
+     */
+    class CryptHeaderReader
+    {
+
+    public:
+
+	/**
+	 * Reads the header of the device (or image file).
+	 *
+	 * @throw Exception if the device cannot be read
+	 */
+	CryptHeaderReader(const string& device);
+
+	/**
+	 * Whether the header was read. If not all other functions return
+	 * default values.
+	 */
+	bool is_supported() const { return supported; }
+
+	/**
+	 * Either UNKNOWN, LUKS1, LUKS2 or BITLOCKER.
+	 */
+	EncryptionType get_encryption_type() const { return encryption_type; }
+
+	const string& get_uuid() const { return uuid; }
+
+	const string& get_cipher() const { return cipher; }
+
+	/**
+	 * The size of the master key in bytes.
+	 */
+	unsigned int get_key_size() const { return key_size; }
+
+	/**
+	 * The PBKDF of the first keyslot. Only for LUKS2.
+	 */
+	const string& get_pbkdf() const { return pbkdf; }
+
+	/**
+	 * The integrity of the data segment. Only for LUKS2.
+	 */
+	const string& get_integrity() const { return integrity; }
+
+    private:
+
+	void read_luks1(const uint8_t* header);
+	void read_luks2(const BlockReader& block_reader, const uint8_t* header);
+	void read_bitlocker(const BlockReader& block_reader, const uint8_t* header);
+
+	const string device;
+
+	bool supported = false;
+
+	EncryptionType encryption_type = EncryptionType::UNKNOWN;
+	string uuid;
+	string cipher;
+	unsigned int key_size = 0;
+	string pbkdf;
+	string integrity;
+
+    };
+
+}
+
+
+#endif
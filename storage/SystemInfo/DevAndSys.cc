@@ -49,6 +49,16 @@ namespace storage
     }
 
 
+    Dir::Dir(const string& path, const vector<string>& entries)
+	: path(path), entries(entries)
+    {
+	if (Mockup::get_mode() == Mockup::Mode::RECORD)
+	    Mockup::set_command({ LS_BIN, "-1", "--sort=none", path }, entries);
+
+	y2mil(*this);
+    }
+
+
     void
     Dir::parse(const vector<string>& lines)
     {
@@ -107,6 +117,16 @@ namespace storage
     }
 
 
+    File::File(const string& path, const vector<string>& content)
+	: path(path), content(content)
+    {
+	if (Mockup::get_mode() == Mockup::Mode::RECORD)
+	    Mockup::set_file(path, content);
+
+	y2mil(*this);
+    }
+
+
     template<typename T>
     T
     File::get() const
@@ -52,6 +52,12 @@ namespace storage
 
 	Dir(Udevadm& udevadm, const string& path);
 
+	/**
+	 * Constructs the object from entries read elsewhere, e.g. by the
+	 * SysfsScanner.
+	 */
+	Dir(const string& path, const vector<string>& entries);
+
 	typedef vector<string>::const_iterator const_iterator;
 
 	bool empty() const { return entries.empty(); }
@@ -85,6 +91,12 @@ namespace storage
 
 	File(const string& path);
 
+	/**
+	 * Constructs the object from content read elsewhere, e.g. by the
+	 * SysfsScanner.
+	 */
+	File(const string& path, const vector<string>& content);
+
 	const_iterator begin() const { return content.begin(); }
 	const_iterator end() const { return content.end(); }
 
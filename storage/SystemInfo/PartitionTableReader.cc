@@ -0,0 +1,521 @@
+/*
+ * Copyright (c) 2026 SUSE LLC
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#include <string.h>
+#include <set>
+
+#include "storage/Utils/LoggerImpl.h"
+#include "storage/Utils/ExceptionImpl.h"
+#include "storage/Utils/Format.h"
+#include "storage/Utils/Endian.h"
+#include "storage/Utils/BlockReader.h"
+#include "storage/Devices/Partition.h"
+#include "storage/SystemInfo/PartitionTableReader.h"
+
+
+namespace storage
+{
+    using namespace std;
+
+
+    namespace
+    {
+
+	/**
+	 * Formats a GUID stored in the mixed-endian on-disk format.
+	 */
+	string
+	format_guid(const uint8_t* p)
+	{
+	    string ret = sformat("%08x-%04x-%04x-", get_le32(p), get_le16(p + 4), get_le16(p + 6));
+
+	    // sformat would print uint8_t as character.
+
+	    for (int i = 8; i < 16; ++i)
+	    {
+		if (i == 10)
+		    ret += '-';
+
+		ret += sformat("%02x", (unsigned int)(p[i]));
+	    }
+
+	    return ret;
+	}
+
+
+	/**
+	 * Converts the NUL terminated UTF-16LE name of a GPT partition to UTF-8.
+	 */
+	string
+	utf16le_to_utf8(const uint8_t* p, size_t max_length)
+	{
+	    string ret;
+
+	    for (size_t i = 0; i < max_length; ++i)
+	    {
+		uint32_t c = get_le16(p + 2 * i);
+		if (c == 0)
+		    break;
+
+		if (c >= 0xd800 && c < 0xdc00 && i + 1 < max_length)
+		{
+		    uint32_t c2 = get_le16(p + 2 * (i + 1));
+		    if (c2 >= 0xdc00 && c2 < 0xe000)
+		    {
+			c = 0x10000 + ((c - 0xd800) << 10) + (c2 - 0xdc00);
+			++i;
+		    }
+		}
+
+		if (c < 0x80)
+		{
+		    ret += (char)(c);
+		}
+		else if (c < 0x800)
+		{
+		    ret += (char)(0xc0 | c >> 6);
+		    ret += (char)(0x80 | (c & 0x3f));
+		}
+		else if (c < 0x10000)
+		{
+		    ret += (char)(0xe0 | c >> 12);
+		    ret += (char)(0x80 | (c >> 6 & 0x3f));
+		    ret += (char)(0x80 | (c & 0x3f));
+		}
+		else
+		{
+		    ret += (char)(0xf0 | c >> 18);
+		    ret += (char)(0x80 | (c >> 12 & 0x3f));
+		    ret += (char)(0x80 | (c >> 6 & 0x3f));
+		    ret += (char)(0x80 | (c & 0x3f));
+		}
+	    }
+
+	    return ret;
+	}
+
+
+	/**
+	 * Partition type GUIDs parted reports as flags, see
+	 * CmdParted::id_to_name.
+	 */
+	const map<string, unsigned int> gpt_flag_guids = {
+	    { "21686148-6449-6e6f-744e-656564454649", ID_BIOS_BOOT },
+	    { "de94bba4-06d1-4d40-a16a-bfd50179d6ac", ID_DIAG },
+	    { "c12a7328-f81f-11d2-ba4b-00a0c93ec93b", ID_ESP },
+	    { "d3bfe2de-3daf-11df-ba40-e3a556d89593", ID_IRST },
+	    { "933ac7e1-2eb4-4f13-b844-0e14e2aef915", ID_LINUX_HOME },
+	    { "e6d6d379-f507-44c2-a23c-238f2a3df928", ID_LVM },
+	    { "e3c9e316-0b5c-4db8-817d-f92df00215ae", ID_MICROSOFT_RESERVED },
+	    { "9e1a2d38-c612-4316-aa26-8b49521e5a8b", ID_PREP },
+	    { "a19d880f-05fc-4d3b-a006-743f0f84911e", ID_RAID },
+	    { "0657fd6d-a4ab-43c4-84e5-0933c84b4f4f", ID_SWAP },
+	    { "ebd0a0a2-b9e5-4433-87c0-68b6b72699c7", ID_WINDOWS_BASIC_DATA },
+	    { "bc13c2ff-59e6-4262-a352-b275fd6f7172", ID_XBOOTLDR },
+	};
+
+
+	unsigned int
+	gpt_type_guid_to_id(const string& guid)
+	{
+	    map<string, unsigned int>::const_iterator it1 = gpt_flag_guids.find(guid);
+	    if (it1 != gpt_flag_guids.end())
+		return it1->second;
+
+	    for (const map<unsigned int, const char*>::value_type& tmp : CmdParted::id_to_uuid)
+	    {
+		if (guid == tmp.second)
+		    return tmp.first;
+	    }
+
+	    return ID_UNKNOWN;
+	}
+
+
+	const size_t mbr_size = 512;
+
+	const uint8_t MBR_TYPE_GPT_PROTECTIVE = 0xee;
+
+	const char GPT_SIGNATURE[] = "EFI PART";
+
+	const size_t gpt_min_header_size = 92;
+	const size_t gpt_entry_size = 128;
+	const size_t gpt_max_entries = 1024;
+
+	const uint64_t GPT_ATTR_LEGACY_BOOT = 1ULL << 2;
+	const uint64_t GPT_ATTR_NO_AUTOMOUNT = 1ULL << 63;
+
+	const unsigned int max_logical_partitions = 256;
+
+    }
+
+
+    /**
+     * Reads whole sectors from a block device or image file.
+     */
+    class PartitionTableReader::SectorReader
+    {
+
+    public:
+
+	SectorReader(const string& name)
+	    : block_reader(name)
+	{
+	    if (get_sector_size() < mbr_size || get_sector_size() % mbr_size != 0)
+		ST_THROW(Exception(sformat("unexpected sector size %zu for %s", get_sector_size(), name)));
+	}
+
+	size_t get_sector_size() const { return block_reader.get_sector_size(); }
+
+	uint64_t get_num_sectors() const { return block_reader.get_size() / get_sector_size(); }
+
+	/**
+	 * Reads num sectors starting at sector.
+	 */
+	vector<uint8_t> read(uint64_t sector, uint64_t num) const
+	{
+	    if (sector >= get_num_sectors() || num > get_num_sectors() - sector)
+		ST_THROW(Exception(sformat("read beyond end of %s", block_reader.get_name())));
+
+	    return block_reader.read(sector * get_sector_size(), num * get_sector_size());
+	}
+
+    private:
+
+	const BlockReader block_reader;
+
+    };
+
+
+    PartitionTableReader::PartitionTableReader(const string& device)
+	: device(device)
+    {
+	const SectorReader sector_reader(device);
+
+	region = Region(0, sector_reader.get_num_sectors(), sector_reader.get_sector_size());
+
+	const vector<uint8_t> mbr = sector_reader.read(0, 1);
+
+	if (mbr[510] != 0x55 || mbr[511] != 0xaa)
+	{
+	    y2mil("no MBR signature on " << device);
+	    return;
+	}
+
+	bool gpt_protective = false;
+
+	for (int i = 0; i < 4; ++i)
+	{
+	    if (mbr[446 + 16 * i + 4] == MBR_TYPE_GPT_PROTECTIVE)
+		gpt_protective = true;
+	}
+
+	if (gpt_protective)
+	    read_gpt(sector_reader, mbr);
+	else
+	    read_msdos(sector_reader, mbr);
+    }
+
+
+    void
+    PartitionTableReader::read_msdos(const SectorReader& sector_reader, const vector<uint8_t>& mbr)
+    {
+	// A boot sector of a FAT or NTFS filesystem on the whole device also
+	// has the MBR signature. Leave those cases to parted.
+
+	if (memcmp(&mbr[54], "FAT", 3) == 0 || memcmp(&mbr[82], "FAT32", 5) == 0 ||
+	    memcmp(&mbr[3], "NTFS", 4) == 0)
+	{
+	    y2mil("boot sector of filesystem on " << device);
+	    return;
+	}
+
+	const unsigned int block_size = region.get_block_size();
+
+	vector<CmdParted::Entry> tmp_entries;
+
+	uint64_t extended_start = 0;
+	uint64_t extended_length = 0;
+
+	for (unsigned int i = 0; i < 4; ++i)
+	{
+	    const uint8_t* p = &mbr[446 + 16 * i];
+
+	    if (p[0] != 0x00 && p[0] != 0x80)
+	    {
+		y2mil("invalid boot indicator on " << device);
+		return;
+	    }
+
+	    const uint8_t id = p[4];
+	    const uint32_t start = get_le32(p + 8);
+	    const uint32_t length = get_le32(p + 12);
+
+	    if (id == 0x00 || length == 0)
+		continue;
+
+	    CmdParted::Entry entry;
+	    entry.number = i + 1;
+	    entry.region = Region(start, length, block_size);
+	    entry.id = id;
+	    entry.boot = p[0] == 0x80;
+
+	    if (id == 0x05 || id == 0x0f || id == 0x85)
+	    {
+		if (extended_length != 0)
+		{
+		    y2mil("several extended partitions on " << device);
+		    return;
+		}
+
+		entry.type = PartitionType::EXTENDED;
+		extended_start = start;
+		extended_length = length;
+	    }
+
+	    tmp_entries.push_back(entry);
+	}
+
+	if (tmp_entries.empty())
+	{
+	    // parted and the prober have special handling for empty MS-DOS
+	    // partition tables, e.g. an MBR written by grub.
+
+	    y2mil("MS-DOS partition table without partitions on " << device);
+	    return;
+	}
+
+	// Follow the chain of extended boot records (EBRs). The first entry of
+	// an EBR is the logical partition relative to the EBR, the second one
+	// the link to the next EBR relative to the extended partition.
+
+	uint64_t ebr = extended_start;
+	set<uint64_t> visited;
+
+	for (unsigned int number = 5; extended_length != 0; ++number)
+	{
+	    if (number >= 5 + max_logical_partitions || !visited.insert(ebr).second)
+	    {
+		y2mil("loop in EBR chain on " << device);
+		return;
+	    }
+
+	    const vector<uint8_t> sector = sector_reader.read(ebr, 1);
+
+	    if (sector[510] != 0x55 || sector[511] != 0xaa)
+	    {
+		y2mil("invalid EBR on " << device);
+		return;
+	    }
+
+	    const uint8_t* p1 = &sector[446];
+	    const uint8_t* p2 = &sector[446 + 16];
+
+	    if (p1[4] == 0x00 || get_le32(p1 + 12) == 0)
+	    {
+		// An EBR without logical partition is only fine if it is the
+		// single, empty one.
+
+		if (ebr != extended_start || p2[4] != 0x00)
+		{
+		    y2mil("unexpected EBR on " << device);
+		    return;
+		}
+
+		break;
+	    }
+
+	    CmdParted::Entry entry;
+	    entry.number = number;
+	    entry.region = Region(ebr + get_le32(p1 + 8), get_le32(p1 + 12), block_size);
+	    entry.type = PartitionType::LOGICAL;
+	    entry.id = p1[4];
+	    entry.boot = p1[0] == 0x80;
+
+	    tmp_entries.push_back(entry);
+
+	    if (p2[4] != 0x05 && p2[4] != 0x0f && p2[4] != 0x85)
+		break;
+
+	    const uint32_t next = get_le32(p2 + 8);
+	    if (next == 0 || next >= extended_length)
+	    {
+		y2mil("invalid EBR link on " << device);
+		return;
+	    }
+
+	    ebr = extended_start + next;
+	}
+
+	label = PtType::MSDOS;
+	primary_slots = 4;
+	entries = tmp_entries;
+	supported = true;
+    }
+
+
+    void
+    PartitionTableReader::read_gpt(const SectorReader& sector_reader, const vector<uint8_t>& mbr)
+    {
+	const unsigned int block_size = region.get_block_size();
+	const uint64_t last_sector = sector_reader.get_num_sectors() - 1;
+
+	// Checks a GPT header and reads its partition entry array. Returns
+	// false if either is not valid.
+
+	auto read_header = [&sector_reader, block_size](uint64_t sector, vector<uint8_t>& header,
+						 vector<uint8_t>& array) {
+
+	    header = sector_reader.read(sector, 1);
+
+	    if (memcmp(&header[0], GPT_SIGNATURE, 8) != 0)
+		return false;
+
+	    const uint32_t header_size = get_le32(&header[12]);
+	    if (header_size < gpt_min_header_size || header_size > block_size)
+		return false;
+
+	    vector<uint8_t> tmp(header.begin(), header.begin() + header_size);
+	    memset(&tmp[16], 0, 4);
+	    if (crc32(tmp.data(), tmp.size()) != get_le32(&header[16]))
+		return false;
+
+	    if (get_le64(&header[24]) != sector)
+		return false;
+
+	    const uint64_t array_sector = get_le64(&header[72]);
+	    const uint32_t num_entries = get_le32(&header[80]);
+	    const uint32_t entry_size = get_le32(&header[84]);
+
+	    if (num_entries == 0 || num_entries > gpt_max_entries || entry_size != gpt_entry_size)
+		return false;
+
+	    const uint64_t array_size = (uint64_t)(num_entries) * entry_size;
+
+	    array = sector_reader.read(array_sector, (array_size + block_size - 1) / block_size);
+	    array.resize(array_size);
+
+	    return crc32(array.data(), array.size()) == get_le32(&header[88]);
+	};
+
+	vector<uint8_t> header;
+	vector<uint8_t> array;
+
+	if (!read_header(1, header, array))
+	{
+	    // parted can use the backup GPT and asks about it. Leave that
+	    // to parted.
+
+	    y2mil("primary GPT not valid on " << device);
+	    return;
+	}
+
+	for (int i = 0; i < 4; ++i)
+	{
+	    const uint8_t* p = &mbr[446 + 16 * i];
+	    if (p[4] == MBR_TYPE_GPT_PROTECTIVE)
+		gpt_pmbr_boot = p[0] == 0x80;
+	}
+
+	const uint64_t alternate_sector = get_le64(&header[32]);
+
+	if (alternate_sector > last_sector)
+	{
+	    y2mil("alternate GPT beyond end of " << device);
+	    return;
+	}
+
+	gpt_undersized = alternate_sector < last_sector;
+
+	vector<uint8_t> backup_header;
+	vector<uint8_t> backup_array;
+
+	gpt_backup_broken = !read_header(alternate_sector, backup_header, backup_array);
+
+	const uint32_t num_entries = get_le32(&header[80]);
+
+	vector<CmdParted::Entry> tmp_entries;
+
+	for (uint32_t i = 0; i < num_entries; ++i)
+	{
+	    const uint8_t* p = &array[i * gpt_entry_size];
+
+	    static const uint8_t unused[16] = {};
+	    if (memcmp(p, unused, 16) == 0)
+		continue;
+
+	    const uint64_t first = get_le64(p + 32);
+	    const uint64_t last = get_le64(p + 40);
+	    if (first > last || last > last_sector)
+	    {
+		y2mil("invalid GPT entry " << i + 1 << " on " << device);
+		return;
+	    }
+
+	    const uint64_t attributes = get_le64(p + 48);
+
+	    CmdParted::Entry entry;
+	    entry.number = i + 1;
+	    entry.region = Region(first, last - first + 1, block_size);
+	    entry.id = gpt_type_guid_to_id(format_guid(p));
+	    entry.legacy_boot = attributes & GPT_ATTR_LEGACY_BOOT;
+	    entry.no_automount = attributes & GPT_ATTR_NO_AUTOMOUNT;
+	    entry.name = utf16le_to_utf8(p + 56, 36);
+
+	    tmp_entries.push_back(entry);
+	}
+
+	label = PtType::GPT;
+	primary_slots = num_entries;
+	entries = tmp_entries;
+	supported = true;
+    }
+
+
+    uint32_t
+    PartitionTableReader::crc32(const void* data, size_t size)
+    {
+	static uint32_t table[256];
+
+	static const bool initialized = []() {
+	    for (uint32_t i = 0; i < 256; ++i)
+	    {
+		uint32_t c = i;
+		for (int j = 0; j < 8; ++j)
+		    c = c & 1 ? 0xedb88320 ^ c >> 1 : c >> 1;
+		table[i] = c;
+	    }
+	    return true;
+	}();
+
+	(void)(initialized);
+
+	uint32_t crc = 0xffffffff;
+
+	const uint8_t* p = (const uint8_t*)(data);
+	for (size_t i = 0; i < size; ++i)
+	    crc = table[(crc ^ p[i]) & 0xff] ^ crc >> 8;
+
+	return crc ^ 0xffffffff;
+    }
+
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2026 SUSE LLC
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#ifndef STORAGE_PARTITION_TABLE_READER_H
+#define STORAGE_PARTITION_TABLE_READER_H
+
+
+#include <stdint.h>
+
+#include "storage/SystemInfo/CmdParted.h"
+
+
+namespace storage
+{
+    using std::string;
+    using std::vector;
+
+
+    /**
+     * Reads MS-DOS and GPT partition tables directly from the device
+     * without running parted. Provides the same information as CmdParted.
+     *
+     * Layouts the reader cannot handle with certainty, e.g. a missing or
+     * corrupt primary GPT, an MBR that might be a boot sector of a
+     * filesystem or a DASD, are reported as unsupported. The caller must
+     * then use parted.
+     */
+    class PartitionTableReader
+    {
+
+    public:
+
+	/**
+	 * Reads the partition table of the device (or image file).
+	 *
+	 * @throw Exception if the device cannot be read
+	 */
+	PartitionTableReader(const string& device);
+
+	/**
+	 * Whether the partition table was read. If not all other
+	 * functions return default values.
+	 */
+	bool is_supported() const { return supported; }
+
+	PtType get_label() const { return label; }
+
+	/**
+	 * Region spanning the whole device. Reports the device size in
+	 * logical sectors and the logical sector size.
+	 */
+	const Region& get_region() const { return region; }
+
+	int get_primary_slots() const { return primary_slots; }
+
+	bool is_gpt_undersized() const { return gpt_undersized; }
+	bool is_gpt_backup_broken() const { return gpt_backup_broken; }
+	bool is_gpt_pmbr_boot() const { return gpt_pmbr_boot; }
+
+	/**
+	 * The partition entries sorted by number.
+	 */
+	const vector<CmdParted::Entry>& get_entries() const { return entries; }
+
+	/**
+	 * CRC32 as used by GPT.
+	 */
+	static uint32_t crc32(const void* data, size_t size);
+
+    private:
+
+	class SectorReader;
+
+	void read_msdos(const SectorReader& sector_reader, const vector<uint8_t>& mbr);
+	void read_gpt(const SectorReader& sector_reader, const vector<uint8_t>& mbr);
+
+	const string device;
+
+	bool supported = false;
+
+	PtType label = PtType::UNKNOWN;
+	Region region;
+	int primary_slots = -1;
+	bool gpt_undersized = false;
+	bool gpt_backup_broken = false;
+	bool gpt_pmbr_boot = false;
+	vector<CmdParted::Entry> entries;
+
+    };
+
+}
+
+
+#endif
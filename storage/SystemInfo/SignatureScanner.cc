@@ -0,0 +1,916 @@
+/*
+ * Copyright (c) 2026 SUSE LLC
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#include <unistd.h>
+#include <string.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <boost/algorithm/string.hpp>
+
+#include "storage/Utils/LoggerImpl.h"
+#include "storage/Utils/ExceptionImpl.h"
+#include "storage/Utils/StorageDefines.h"
+#include "storage/Utils/HumanString.h"
+#include "storage/Utils/Format.h"
+#include "storage/Utils/WorkerPool.h"
+#include "storage/Utils/Endian.h"
+#include "storage/Utils/BlockReader.h"
+#include "storage/SystemInfo/SignatureScanner.h"
+
+
+namespace storage
+{
+    using namespace std;
+
+
+    namespace
+    {
+
+	bool
+	is_zero(const uint8_t* p, size_t length)
+	{
+	    return all_of(p, p + length, [](uint8_t c) { return c == 0; });
+	}
+
+
+	/**
+	 * Formats a UUID stored as 16 bytes in big-endian order. Like blkid
+	 * an all-zero UUID is reported as empty.
+	 */
+	string
+	format_uuid(const uint8_t* p)
+	{
+	    if (is_zero(p, 16))
+		return "";
+
+	    string ret;
+
+	    // sformat would print uint8_t as character.
+
+	    for (int i = 0; i < 16; ++i)
+	    {
+		if (i == 4 || i == 6 || i == 8 || i == 10)
+		    ret += '-';
+
+		ret += sformat("%02x", (unsigned int)(p[i]));
+	    }
+
+	    return ret;
+	}
+
+
+	/**
+	 * Gets a string of at most max_length bytes which is terminated by
+	 * NUL if shorter. Trailing whitespace is removed like blkid does.
+	 */
+	string
+	get_string(const uint8_t* p, size_t max_length)
+	{
+	    const uint8_t* end = find(p, p + max_length, 0);
+
+	    return boost::trim_right_copy(string(p, end));
+	}
+
+
+	const uint64_t head_size = 256 * KiB;
+	const uint64_t tail_size = 128 * KiB;
+
+	const uint16_t EXT_SUPER_MAGIC = 0xef53;
+
+	const uint32_t EXT_FEATURE_COMPAT_HAS_JOURNAL = 0x0004;
+	const uint32_t EXT_FEATURE_INCOMPAT_JOURNAL_DEV = 0x0008;
+	const uint32_t EXT2_FEATURE_INCOMPAT_SUPP = 0x0002 | 0x0010;
+	const uint32_t EXT3_FEATURE_INCOMPAT_SUPP = 0x0002 | 0x0004 | 0x0010;
+	const uint32_t EXT2_FEATURE_RO_COMPAT_SUPP = 0x0001 | 0x0002 | 0x0004;
+	const uint32_t EXT2_FLAGS_TEST_FILESYS = 0x0004;
+
+	const uint32_t MD_SB_MAGIC = 0xa92b4efc;
+
+	const uint32_t DDF_MAGIC = 0xde11de11;
+
+	const uint32_t XFS_LOG_MAGIC = 0xfeedbabe;
+
+	const uint8_t bcache_magic[16] = {
+	    0xc6, 0x85, 0x73, 0xf6, 0x4e, 0x1a, 0x45, 0xca, 0x82, 0x65, 0xf5, 0x7f, 0x48, 0xba, 0x6d, 0x81
+	};
+
+	const uint8_t bcachefs_magic[16] = {
+	    0xc6, 0x85, 0x73, 0xf6, 0x66, 0xce, 0x90, 0xa9, 0xd9, 0x6a, 0x60, 0xcf, 0x80, 0x3d, 0xf7, 0xef
+	};
+
+
+	/**
+	 * Signatures of types the scanner does not decode. Devices having
+	 * one of these are left to blkid.
+	 */
+	struct OtherSignature
+	{
+	    uint64_t offset;
+	    const char* magic;
+	    size_t length;
+	};
+
+	const OtherSignature other_signatures[] = {
+	    { 3, "NTFS    ", 8 },
+	    { 3, "EXFAT   ", 8 },
+	    { 3, "-FVE-FS-", 8 },
+	    { 3, "MSWIN", 5 },
+	    { 3, "MSDOS", 5 },
+	    { 0x36, "MSDOS", 5 },
+	    { 0x36, "FAT", 3 },
+	    { 0x52, "MSWIN", 5 },
+	    { 0x52, "FAT32   ", 8 },
+	    { 0, "hsqs", 4 },
+	    { 0, "sqsh", 4 },
+	    { 1024, "BD", 2 },
+	    { 1024, "H+", 2 },
+	    { 1024, "HX", 2 },
+	    { 1024 + 6, "\x34\x34", 2 },
+	    { 1024, "\x10\x20\xf5\xf2", 4 },
+	    { 1024, "\xe2\xe1\xf5\xe0", 4 },
+	    { 1024 + 16, "\x7f\x13", 2 },
+	    { 1024 + 16, "\x8f\x13", 2 },
+	    { 1024 + 16, "\x68\x24", 2 },
+	    { 1024 + 16, "\x78\x24", 2 },
+	    { 1024 + 24, "\x5a\x4d", 2 },
+	    { 8 * KiB + 52, "ReIsErFs", 8 },
+	    { 64 * KiB + 52, "ReIsErFs", 8 },
+	    { 64 * KiB + 52, "ReIsEr2Fs", 9 },
+	    { 64 * KiB + 52, "ReIsEr3Fs", 9 },
+	    { 32 * KiB, "JFS1", 4 },
+	    { 32 * KiB + 9, "CDROM", 5 },
+	    { 9 * 512 + 32, "\xf0\x16\x78\x5a", 4 },
+	    { 9 * 512 + 32, "\xfd\x16\x78\x5a", 4 },
+	};
+
+
+	/**
+	 * Signatures of fake RAIDs located in a sector counted from the end
+	 * of the device, e.g. 1 for the last sector. Sectors have 512 bytes
+	 * here independent of the logical sector size. Like MD RAIDs these
+	 * take precedence over the content at the beginning of the device.
+	 */
+	struct EndSignature
+	{
+	    uint64_t sector;
+	    uint64_t offset;
+	    const char* magic;
+	    size_t length;
+	};
+
+	const EndSignature end_signatures[] = {
+	    { 1, 0, "\x55\xaa", 2 },				// via
+	    { 1, 0, "JM", 2 },					// jmicron
+	    { 1, 0, "$XIDE$", 6 },				// lsi
+	    { 1, 0, "\x37\xfc\x4d\x1e", 4 },			// adaptec
+	    { 1, 0x60, "\x00\x00\x00\x2f", 4 },		// silicon
+	    { 2, 0, "NVIDIA", 6 },				// nvidia
+	    { 11, 32, "\xf3\x16\x78\x5a", 4 },		// hpt45x
+	    { 11, 32, "\xfd\x16\x78\x5a", 4 },		// hpt45x
+	};
+
+
+	/**
+	 * The Promise signature can be in one of several sectors counted from
+	 * the end of the device. Some are outside of the tail window and are
+	 * read separately.
+	 */
+	const char promise_magic[] = "Promise Technology, Inc.";
+
+	const uint64_t promise_sectors[] = {
+	    16, 63, 255, 256, 399, 591, 675, 735, 911, 951, 974, 991, 3087
+	};
+
+
+	/**
+	 * The start and the end of a device.
+	 */
+	class Window
+	{
+
+	public:
+
+	    Window(const string& name);
+
+	    uint64_t get_size() const { return size; }
+
+	    /**
+	     * Returns the length bytes at offset or nullptr if they were not
+	     * read.
+	     */
+	    const uint8_t* get(uint64_t offset, size_t length) const;
+
+	    bool has(uint64_t offset, const char* magic, size_t length) const
+	    {
+		const uint8_t* p = get(offset, length);
+		return p && memcmp(p, magic, length) == 0;
+	    }
+
+	private:
+
+	    uint64_t size = 0;
+
+	    vector<uint8_t> head;
+
+	    uint64_t tail_offset = 0;
+	    vector<uint8_t> tail;
+
+	    /**
+	     * Single sectors outside of head and tail, by offset.
+	     */
+	    map<uint64_t, vector<uint8_t>> sectors;
+
+	};
+
+
+	Window::Window(const string& name)
+	{
+	    const BlockReader block_reader(name);
+
+	    const size_t sector_size = block_reader.get_sector_size();
+
+	    size = block_reader.get_size();
+	    size -= size % sector_size;
+
+	    head = block_reader.read(0, min(size, head_size));
+
+	    if (size > head_size)
+	    {
+		tail_offset = max(size - tail_size, head_size);
+		tail = block_reader.read(tail_offset, size - tail_offset);
+	    }
+
+	    for (uint64_t promise_sector : promise_sectors)
+	    {
+		if (size < promise_sector * 512)
+		    continue;
+
+		uint64_t offset = size - promise_sector * 512;
+		offset -= offset % sector_size;
+
+		if (!get(offset, sector_size) && sectors.find(offset) == sectors.end())
+		    sectors[offset] = block_reader.read(offset, sector_size);
+	    }
+	}
+
+
+	const uint8_t*
+	Window::get(uint64_t offset, size_t length) const
+	{
+	    if (offset + length <= head.size())
+		return head.data() + offset;
+
+	    if (offset >= tail_offset && offset + length <= tail_offset + tail.size())
+		return tail.data() + (offset - tail_offset);
+
+	    map<uint64_t, vector<uint8_t>>::const_iterator it = sectors.upper_bound(offset);
+	    if (it != sectors.begin())
+	    {
+		--it;
+		if (offset + length <= it->first + it->second.size())
+		    return it->second.data() + (offset - it->first);
+	    }
+
+	    return nullptr;
+	}
+
+
+	bool
+	has_fake_raid_signature(const Window& window)
+	{
+	    const uint64_t size = window.get_size();
+
+	    for (const EndSignature& end_signature : end_signatures)
+	    {
+		if (size >= end_signature.sector * 512 &&
+		    window.has(size - end_signature.sector * 512 + end_signature.offset, end_signature.magic,
+			       end_signature.length))
+		    return true;
+	    }
+
+	    for (uint64_t promise_sector : promise_sectors)
+	    {
+		if (size >= promise_sector * 512 &&
+		    window.has(size - promise_sector * 512, promise_magic, strlen(promise_magic)))
+		    return true;
+	    }
+
+	    return false;
+	}
+
+
+	bool
+	has_other_signature(const Window& window)
+	{
+	    for (const OtherSignature& other_signature : other_signatures)
+	    {
+		if (window.has(other_signature.offset, other_signature.magic, other_signature.length))
+		    return true;
+	    }
+
+	    // FAT without any of the strings, only a jump instruction and
+	    // a plausible BIOS parameter block.
+
+	    const uint8_t* p = window.get(0, 512);
+	    if (p && (p[0] == 0xeb || p[0] == 0xe9) && p[510] == 0x55 && p[511] == 0xaa)
+	    {
+		uint16_t sector_size = get_le16(p + 11);
+		uint8_t cluster_size = p[13];
+		if (sector_size >= 512 && sector_size <= 4096 && (sector_size & (sector_size - 1)) == 0 &&
+		    cluster_size != 0 && (cluster_size & (cluster_size - 1)) == 0)
+		    return true;
+	    }
+
+	    // ISO 9660 and the volume recognition sequence of UDF.
+
+	    for (uint64_t offset = 32 * KiB; offset < 96 * KiB; offset += 2 * KiB)
+	    {
+		for (const char* id : { "CD001", "BEA01", "NSR02", "NSR03", "TEA01", "BOOT2", "CDW02" })
+		{
+		    if (window.has(offset + 1, id, 5))
+			return true;
+		}
+	    }
+
+	    p = window.get(0, 4);
+	    if (p && get_be32(p) == XFS_LOG_MAGIC)
+		return true;
+
+	    if (window.has(4 * KiB + 24, (const char*)(bcachefs_magic), 16))
+		return true;
+
+	    return false;
+	}
+
+
+	bool
+	has_partition_table(const Window& window)
+	{
+	    const uint8_t* p = window.get(510, 2);
+	    if (p && p[0] == 0x55 && p[1] == 0xaa)
+		return true;
+
+	    return window.has(512, "EFI PART", 8) || window.has(4 * KiB, "EFI PART", 8);
+	}
+
+
+	/**
+	 * Detects MD RAID members of all metadata versions including IMSM
+	 * and DDF.
+	 */
+	bool
+	probe_md(const Window& window, CmdBlkid::Entry& entry)
+	{
+	    const uint64_t size = window.get_size();
+
+	    vector<uint64_t> offsets_v1 = { 0, 4 * KiB };
+	    if (size >= 8 * KiB)
+		offsets_v1.push_back((((size >> 9) - 16) & ~7ULL) << 9);
+
+	    for (uint64_t offset : offsets_v1)
+	    {
+		const uint8_t* p = window.get(offset, 8);
+		if (p && get_le32(p) == MD_SB_MAGIC && get_le32(p + 4) == 1)
+		{
+		    entry.is_md = true;
+		    return true;
+		}
+	    }
+
+	    if (size >= 128 * KiB)
+	    {
+		const uint8_t* p = window.get((size & ~(64 * KiB - 1)) - 64 * KiB, 8);
+		if (p && ((get_le32(p) == MD_SB_MAGIC && get_le32(p + 4) == 0) ||
+			  (get_be32(p) == MD_SB_MAGIC && get_be32(p + 4) == 0)))
+		{
+		    entry.is_md = true;
+		    return true;
+		}
+	    }
+
+	    if (size >= 2 * 512 && window.has(size - 2 * 512, "Intel Raid ISM Cfg Sig. ", 24))
+	    {
+		entry.is_md = true;
+		return true;
+	    }
+
+	    if (size >= 512)
+	    {
+		const uint8_t* p = window.get(size - 512, 4);
+		if (p && get_be32(p) == DDF_MAGIC)
+		{
+		    entry.is_md = true;
+		    return true;
+		}
+	    }
+
+	    return false;
+	}
+
+
+	bool
+	probe_lvm(const Window& window, CmdBlkid::Entry& entry)
+	{
+	    // The label can be in any of the first four sectors.
+
+	    for (uint64_t sector = 0; sector < 4; ++sector)
+	    {
+		if (window.has(sector * 512, "LABELONE", 8) && window.has(sector * 512 + 24, "LVM2 001", 8))
+		{
+		    entry.is_lvm = true;
+		    return true;
+		}
+	    }
+
+	    return false;
+	}
+
+
+	/**
+	 * Detects ext2, ext3, ext4 and external ext journals. The distinction
+	 * between the ext versions follows the feature flags like blkid
+	 * does. Returns false with unsure set for layouts blkid reports
+	 * differently, e.g. ext4dev.
+	 */
+	bool
+	probe_ext(const Window& window, CmdBlkid::Entry& entry, bool& unsure)
+	{
+	    const uint8_t* sb = window.get(1024, 1024);
+	    if (!sb || get_le16(sb + 56) != EXT_SUPER_MAGIC)
+		return false;
+
+	    const uint32_t compat = get_le32(sb + 92);
+	    const uint32_t incompat = get_le32(sb + 96);
+	    const uint32_t ro_compat = get_le32(sb + 100);
+	    const uint32_t flags = get_le32(sb + 352);
+
+	    if (incompat & EXT_FEATURE_INCOMPAT_JOURNAL_DEV)
+	    {
+		entry.is_journal = true;
+		entry.journal_uuid = format_uuid(sb + 104);
+		return true;
+	    }
+
+	    const bool has_journal = compat & EXT_FEATURE_COMPAT_HAS_JOURNAL;
+	    const bool ext2_supported = !(ro_compat & ~EXT2_FEATURE_RO_COMPAT_SUPP) &&
+		!(incompat & ~EXT2_FEATURE_INCOMPAT_SUPP);
+	    const bool ext3_supported = !(ro_compat & ~EXT2_FEATURE_RO_COMPAT_SUPP) &&
+		!(incompat & ~EXT3_FEATURE_INCOMPAT_SUPP);
+
+	    if (!has_journal && ext2_supported)
+		entry.fs_type = FsType::EXT2;
+	    else if (has_journal && ext3_supported)
+		entry.fs_type = FsType::EXT3;
+	    else if (!ext3_supported && !(flags & EXT2_FLAGS_TEST_FILESYS))
+		entry.fs_type = FsType::EXT4;
+	    else
+	    {
+		unsure = true;
+		return false;
+	    }
+
+	    entry.is_fs = true;
+	    entry.fs_uuid = format_uuid(sb + 104);
+	    entry.fs_label = get_string(sb + 120, 16);
+	    if (has_journal)
+		entry.fs_journal_uuid = format_uuid(sb + 208);
+
+	    return true;
+	}
+
+
+	bool
+	probe_btrfs(const Window& window, CmdBlkid::Entry& entry)
+	{
+	    const uint8_t* sb = window.get(64 * KiB, 4 * KiB);
+	    if (!sb || memcmp(sb + 64, "_BHRfS_M", 8) != 0)
+		return false;
+
+	    entry.is_fs = true;
+	    entry.fs_type = FsType::BTRFS;
+	    entry.fs_uuid = format_uuid(sb + 32);
+	    entry.fs_label = get_string(sb + 299, 256);
+	    entry.fs_sub_uuid = format_uuid(sb + 267);
+
+	    return true;
+	}
+
+
+	bool
+	probe_xfs(const Window& window, CmdBlkid::Entry& entry)
+	{
+	    const uint8_t* sb = window.get(0, 512);
+	    if (!sb || memcmp(sb, "XFSB", 4) != 0)
+		return false;
+
+	    entry.is_fs = true;
+	    entry.fs_type = FsType::XFS;
+	    entry.fs_uuid = format_uuid(sb + 32);
+	    entry.fs_label = get_string(sb + 108, 12);
+
+	    return true;
+	}
+
+
+	/**
+	 * Detects swap version 1. Old swap and hibernation images are
+	 * reported as unsure.
+	 */
+	bool
+	probe_swap(const Window& window, CmdBlkid::Entry& entry, bool& unsure)
+	{
+	    for (uint64_t page_size = 4 * KiB; page_size <= 64 * KiB; page_size *= 2)
+	    {
+		if (window.has(page_size - 10, "SWAPSPACE2", 10))
+		{
+		    const uint8_t* p = window.get(1024, 44);
+		    if (get_le32(p) != 1)
+		    {
+			unsure = true;
+			return false;
+		    }
+
+		    entry.is_fs = true;
+		    entry.fs_type = FsType::SWAP;
+		    entry.fs_uuid = format_uuid(p + 12);
+		    entry.fs_label = get_string(p + 28, 16);
+
+		    return true;
+		}
+
+		for (const char* magic : { "SWAP-SPACE", "S1SUSPEND", "S2SUSPEND", "ULSUSPEND", "LINHIB0001" })
+		{
+		    if (window.has(page_size - 10, magic, strlen(magic)))
+		    {
+			unsure = true;
+			return false;
+		    }
+		}
+	    }
+
+	    return false;
+	}
+
+
+	bool
+	probe_luks(const Window& window, CmdBlkid::Entry& entry, bool& unsure)
+	{
+	    const uint8_t* hdr = window.get(0, 512);
+	    if (!hdr || memcmp(hdr, "LUKS\xba\xbe", 6) != 0)
+		return false;
+
+	    const uint16_t version = get_be16(hdr + 6);
+	    if (version != 1 && version != 2)
+	    {
+		unsure = true;
+		return false;
+	    }
+
+	    entry.is_luks = true;
+	    entry.luks_uuid = get_string(hdr + 168, 40);
+	    if (version == 2)
+		entry.luks_label = get_string(hdr + 24, 48);
+
+	    return true;
+	}
+
+
+	bool
+	probe_bcache(const Window& window, CmdBlkid::Entry& entry)
+	{
+	    const uint8_t* sb = window.get(4 * KiB, 512);
+	    if (!sb || memcmp(sb + 24, bcache_magic, 16) != 0)
+		return false;
+
+	    entry.is_bcache = true;
+	    entry.bcache_uuid = format_uuid(sb + 40);
+
+	    return true;
+	}
+
+
+	SignatureScanner::Result
+	detect(const Window& window)
+	{
+	    SignatureScanner::Result result;
+
+	    // Like for blkid RAID members take precedence over anything
+	    // else since the content of e.g. an MD RAID with metadata 1.0
+	    // also starts at the beginning of the device.
+
+	    CmdBlkid::Entry md_entry;
+	    CmdBlkid::Entry lvm_entry;
+	    bool md = probe_md(window, md_entry);
+	    bool lvm = probe_lvm(window, lvm_entry);
+
+	    bool fake_raid = has_fake_raid_signature(window);
+
+	    if (md || lvm || fake_raid)
+	    {
+		result.status = (md && lvm) || fake_raid ? SignatureScanner::Status::UNSURE :
+		    SignatureScanner::Status::FOUND;
+		result.entry = md ? md_entry : lvm_entry;
+		return result;
+	    }
+
+	    bool unsure = has_other_signature(window);
+
+	    vector<CmdBlkid::Entry> entries;
+
+	    CmdBlkid::Entry entry;
+	    if (probe_ext(window, entry, unsure))
+		entries.push_back(entry);
+
+	    entry = CmdBlkid::Entry();
+	    if (probe_btrfs(window, entry))
+		entries.push_back(entry);
+
+	    entry = CmdBlkid::Entry();
+	    if (probe_xfs(window, entry))
+		entries.push_back(entry);
+
+	    entry = CmdBlkid::Entry();
+	    if (probe_swap(window, entry, unsure))
+		entries.push_back(entry);
+
+	    entry = CmdBlkid::Entry();
+	    if (probe_luks(window, entry, unsure))
+		entries.push_back(entry);
+
+	    entry = CmdBlkid::Entry();
+	    if (probe_bcache(window, entry))
+		entries.push_back(entry);
+
+	    if (unsure || entries.size() > 1 || (entries.size() == 1 && has_partition_table(window)))
+	    {
+		result.status = SignatureScanner::Status::UNSURE;
+	    }
+	    else if (entries.size() == 1)
+	    {
+		result.status = SignatureScanner::Status::FOUND;
+		result.entry = entries.front();
+	    }
+
+	    return result;
+	}
+
+
+	string
+	read_sysfs(const string& path)
+	{
+	    string ret;
+
+	    std::ifstream s(path);
+	    getline(s, ret);
+
+	    return ret;
+	}
+
+
+	/**
+	 * Whether the device-mapper device is suspended or private, e.g. a
+	 * LVM thin-pool internal device or a crypt subdevice. blkid ignores
+	 * those.
+	 */
+	bool
+	is_dm_ignored(const string& sysfs_path)
+	{
+	    if (read_sysfs(sysfs_path + "/dm/suspended") == "1")
+		return true;
+
+	    string uuid = read_sysfs(sysfs_path + "/dm/uuid");
+	    if (boost::starts_with(uuid, "LVM-") && uuid.size() > 68)
+		return true;
+
+	    if (boost::starts_with(uuid, "CRYPT-SUBDEV"))
+		return true;
+
+	    return boost::ends_with(read_sysfs(sysfs_path + "/dm/name"), "-private");
+	}
+
+
+	/**
+	 * Builds the generation of a device, see SignatureScanner. Empty if
+	 * udev has no database entry for the device.
+	 */
+	string
+	get_generation(const string& sysfs_path, dev_t majorminor)
+	{
+	    struct stat st;
+	    if (stat(sformat("/run/udev/data/b%d:%d", major(majorminor), minor(majorminor)).c_str(), &st) != 0)
+		return "";
+
+	    string diskseq = read_sysfs(sysfs_path + "/diskseq");
+	    if (diskseq.empty())
+		diskseq = read_sysfs(sysfs_path + "/../diskseq");
+
+	    return sformat("%s:%s:%lld.%09ld", read_sysfs(sysfs_path + "/size"), diskseq,
+			   (long long)(st.st_mtim.tv_sec), (long)(st.st_mtim.tv_nsec));
+	}
+
+
+	struct CacheEntry
+	{
+	    string generation;
+	    SignatureScanner::Result result;
+	};
+
+
+	std::mutex cache_mutex;
+
+	map<dev_t, CacheEntry> cache;
+
+    }
+
+
+    SignatureScanner::SignatureScanner(int max_threads)
+    {
+	std::ifstream s(PROC_DIR "/partitions");
+	if (!s)
+	    ST_THROW(Exception("reading " PROC_DIR "/partitions failed"));
+
+	struct Line
+	{
+	    unsigned int major;
+	    unsigned int minor;
+	    string name;
+	};
+
+	vector<Line> lines;
+
+	string line;
+	while (getline(s, line))
+	{
+	    Line tmp;
+	    char name[NAME_MAX + 1];
+	    unsigned long long blocks;
+	    if (sscanf(line.c_str(), " %u %u %llu %255s", &tmp.major, &tmp.minor, &blocks, name) == 4)
+	    {
+		tmp.name = name;
+		lines.push_back(tmp);
+	    }
+	}
+
+	// Like blkid skip whole disks with partitions.
+
+	set<string> with_partitions;
+	vector<size_t> to_scan;
+
+	for (const Line& tmp : lines)
+	{
+	    const string sysfs_path = SYSFS_DIR "/class/block/" + tmp.name;
+
+	    if (access((sysfs_path + "/partition").c_str(), F_OK) != 0)
+		continue;
+
+	    char buffer[PATH_MAX];
+	    if (realpath((sysfs_path + "/..").c_str(), buffer))
+		with_partitions.insert(buffer);
+	}
+
+	for (const Line& tmp : lines)
+	{
+	    const string sysfs_path = SYSFS_DIR "/class/block/" + tmp.name;
+
+	    if (boost::starts_with(tmp.name, "ram"))
+		continue;
+
+	    char buffer[PATH_MAX];
+	    if (realpath(sysfs_path.c_str(), buffer) && with_partitions.count(buffer))
+		continue;
+
+	    Device device;
+	    device.majorminor = makedev(tmp.major, tmp.minor);
+
+	    if (boost::starts_with(tmp.name, "dm-"))
+	    {
+		if (is_dm_ignored(sysfs_path))
+		    continue;
+
+		device.name = DEV_MAPPER_DIR "/" + read_sysfs(sysfs_path + "/dm/name");
+	    }
+	    else
+	    {
+		device.name = DEV_DIR "/" + boost::replace_all_copy(tmp.name, "!", "/");
+	    }
+
+	    // blkid finds signatures of zoned btrfs at places depending on
+	    // the zones. Devices without medium have size 0.
+
+	    const string zoned = read_sysfs(sysfs_path + "/queue/zoned");
+	    if (!zoned.empty() && zoned != "none")
+		device.result.status = Status::UNSURE;
+	    else if (read_sysfs(sysfs_path + "/size") == "0")
+		device.result.status = Status::NONE;
+	    else
+	    {
+		device.generation = get_generation(sysfs_path, device.majorminor);
+		to_scan.push_back(devices.size());
+	    }
+
+	    devices.push_back(device);
+	}
+
+	vector<std::function<void()>> tasks;
+	int num_cached = 0;
+
+	for (size_t i : to_scan)
+	{
+	    Device& device = devices[i];
+
+	    if (!device.generation.empty())
+	    {
+		std::lock_guard<std::mutex> lock(cache_mutex);
+
+		map<dev_t, CacheEntry>::const_iterator it = cache.find(device.majorminor);
+		if (it != cache.end() && it->second.generation == device.generation)
+		{
+		    device.result = it->second.result;
+		    ++num_cached;
+		    continue;
+		}
+	    }
+
+	    tasks.push_back([&device]() {
+		try
+		{
+		    device.result = scan(device.name);
+
+		    if (!device.generation.empty())
+		    {
+			std::lock_guard<std::mutex> lock(cache_mutex);
+			cache[device.majorminor] = { device.generation, device.result };
+		    }
+		}
+		catch (const Exception& exception)
+		{
+		    ST_CAUGHT(exception);
+
+		    device.result.status = Status::UNSURE;
+		}
+	    });
+	}
+
+	run_in_worker_pool(tasks, max_threads);
+
+	y2mil("scanned " << tasks.size() << " devices, " << num_cached << " cached");
+    }
+
+
+    void
+    SignatureScanner::resolve(Device& device, const CmdBlkid::Entry* entry)
+    {
+	device.result.status = entry ? Status::FOUND : Status::NONE;
+	device.result.entry = entry ? *entry : CmdBlkid::Entry();
+
+	if (device.generation.empty())
+	    return;
+
+	std::lock_guard<std::mutex> lock(cache_mutex);
+	cache[device.majorminor] = { device.generation, device.result };
+    }
+
+
+    SignatureScanner::Result
+    SignatureScanner::scan(const string& name)
+    {
+	const Window window(name);
+
+	return detect(window);
+    }
+
+
+    void
+    SignatureScanner::clear_cache()
+    {
+	std::lock_guard<std::mutex> lock(cache_mutex);
+	cache.clear();
+    }
+
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2026 SUSE LLC
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#ifndef STORAGE_SIGNATURE_SCANNER_H
+#define STORAGE_SIGNATURE_SCANNER_H
+
+
+#include <sys/types.h>
+
+#include <string>
+#include <vector>
+
+#include "storage/SystemInfo/CmdBlkid.h"
+
+
+namespace storage
+{
+    using std::string;
+    using std::vector;
+
+
+    /**
+     * Detects filesystems, journals, LUKS, LVM PVs, MD members and bcache
+     * devices by reading the signatures from the start and the end of the
+     * block devices directly. Provides the same information as blkid.
+     *
+     * Only the signatures the scanner can decode completely are handled.
+     * Devices with other known signatures, several signatures or a
+     * signature next to a partition table are reported as unsure. The
+     * caller must then use blkid for them.
+     *
+     * The results are cached for the lifetime of the process keyed by
+     * the major and minor number of the device and a generation built
+     * from the size, the disk sequence number and the modification time
+     * of the udev database entry. udev watches block devices and
+     * processes a change event whenever a device opened for writing is
+     * closed, so the generation changes whenever the content might have
+     * changed.
+     *
+     * So a cached result avoids reading the device again. But building the
+     * generation still reads sysfs and the udev database and CmdBlkid
+     * still runs the global 'udevadm settle' before scanning.
+     */
+    class SignatureScanner
+    {
+    public:
+
+	enum class Status { NONE, FOUND, UNSURE };
+
+	struct Result
+	{
+	    Status status = Status::NONE;
+	    CmdBlkid::Entry entry;
+	};
+
+	struct Device
+	{
+	    // name as reported by blkid, e.g. "/dev/sda1" or "/dev/mapper/cr_test"
+	    string name;
+
+	    dev_t majorminor = 0;
+
+	    // empty if the result must not be cached
+	    string generation;
+
+	    Result result;
+	};
+
+	/**
+	 * Scans all block devices blkid would report using at most
+	 * max_threads threads.
+	 *
+	 * @throw Exception if the block devices cannot be enumerated
+	 */
+	SignatureScanner(int max_threads);
+
+	const vector<Device>& get_devices() const { return devices; }
+	vector<Device>& get_devices() { return devices; }
+
+	/**
+	 * Replaces the result of an unsure device by the entry reported by
+	 * blkid (or nullptr if blkid reported nothing) and caches it.
+	 */
+	static void resolve(Device& device, const CmdBlkid::Entry* entry);
+
+	/**
+	 * Scans a single block device or image file. Does not use the
+	 * cache.
+	 *
+	 * @throw Exception if the device cannot be read
+	 */
+	static Result scan(const string& name);
+
+	/**
+	 * Drops all cached results.
+	 */
+	static void clear_cache();
+
+    private:
+
+	vector<Device> devices;
+
+    };
+
+}
+
+
+#endif
@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2026 SUSE LLC
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <string.h>
+#include <limits.h>
+#include <sys/stat.h>
+
+#include "storage/Utils/LoggerImpl.h"
+#include "storage/Utils/ExceptionImpl.h"
+#include "storage/Utils/StorageDefines.h"
+#include "storage/SystemInfo/SysfsScanner.h"
+
+
+namespace storage
+{
+    using namespace std;
+
+
+    namespace
+    {
+
+	/**
+	 * Attributes read for every block device, see get_sysfs_file() in
+	 * BlkDevice::Impl and its callers. Attributes not present are skipped.
+	 */
+	const char* const attribute_names[] = {
+	    "size", "ro", "ext_range", "alignment_offset", "queue/rotational", "queue/dax",
+	    "queue/zoned", "queue/logical_block_size", "queue/optimal_io_size"
+	};
+
+
+	/**
+	 * Directories read for every block device, see has_kernel_holders().
+	 */
+	const char* const dir_names[] = {
+	    "holders"
+	};
+
+
+	/**
+	 * Reads the file name relative to dir_fd. The lines are split like
+	 * File does, so a last line without newline is dropped.
+	 */
+	bool
+	read_lines(int dir_fd, const char* name, vector<string>& lines)
+	{
+	    int fd = openat(dir_fd, name, O_RDONLY | O_CLOEXEC);
+	    if (fd < 0)
+		return false;
+
+	    string content;
+
+	    char buffer[4096];
+	    ssize_t n;
+	    while ((n = read(fd, buffer, sizeof(buffer))) > 0)
+		content.append(buffer, n);
+
+	    close(fd);
+
+	    if (n < 0)
+		return false;
+
+	    string::size_type pos1 = 0;
+	    for (string::size_type pos2; (pos2 = content.find('\n', pos1)) != string::npos; pos1 = pos2 + 1)
+		lines.push_back(content.substr(pos1, pos2 - pos1));
+
+	    return true;
+	}
+
+
+	/**
+	 * Reads the entries of the directory name relative to dir_fd. Like
+	 * 'ls' hidden entries are skipped.
+	 */
+	bool
+	read_entries(int dir_fd, const char* name, vector<string>& entries)
+	{
+	    int fd = openat(dir_fd, name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	    if (fd < 0)
+		return false;
+
+	    DIR* dir = fdopendir(fd);
+	    if (!dir)
+	    {
+		close(fd);
+		return false;
+	    }
+
+	    while (const struct dirent* dirent = readdir(dir))
+	    {
+		if (dirent->d_name[0] != '.')
+		    entries.push_back(dirent->d_name);
+	    }
+
+	    closedir(dir);
+
+	    return true;
+	}
+
+    }
+
+
+    SysfsScanner::SysfsScanner(Udevadm& udevadm, const string& root)
+    {
+	// See Dir::Dir().
+	udevadm.settle();
+
+	if (!read_entries(AT_FDCWD, (root + SYSFS_DIR "/block").c_str(), block_entries))
+	    ST_THROW(Exception("reading " SYSFS_DIR "/block failed"));
+
+	int class_fd = open((root + SYSFS_DIR "/class/block").c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if (class_fd < 0)
+	    ST_THROW(Exception("opening " SYSFS_DIR "/class/block failed"));
+
+	vector<string> names;
+	if (!read_entries(class_fd, ".", names))
+	{
+	    close(class_fd);
+	    ST_THROW(Exception("reading " SYSFS_DIR "/class/block failed"));
+	}
+
+	for (const string& name : names)
+	{
+	    // The entries are symbolic links to e.g. "../../devices/.../block/sda".
+
+	    char target[PATH_MAX];
+	    ssize_t n = readlinkat(class_fd, name.c_str(), target, sizeof(target) - 1);
+	    if (n < 0)
+		continue;
+
+	    const string link(target, n);
+	    string::size_type pos = link.find("/devices/");
+	    if (pos == string::npos)
+		continue;
+
+	    int fd = openat(class_fd, name.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	    if (fd < 0)
+		continue;
+
+	    Entry entry;
+	    entry.name = name;
+	    entry.sysfs_path = link.substr(pos);
+
+	    for (const char* attribute_name : attribute_names)
+	    {
+		vector<string> lines;
+		if (read_lines(fd, attribute_name, lines))
+		    entry.attributes[attribute_name] = lines;
+	    }
+
+	    for (const char* dir_name : dir_names)
+	    {
+		vector<string> tmp;
+		if (read_entries(fd, dir_name, tmp))
+		    entry.dirs[dir_name] = tmp;
+	    }
+
+	    close(fd);
+
+	    struct stat st;
+	    if (lstat((root + DEV_DIR "/" + name).c_str(), &st) == 0)
+		entry.dev_mode = st.st_mode;
+
+	    entries.push_back(entry);
+	}
+
+	close(class_fd);
+
+	y2mil(*this);
+    }
+
+
+    std::ostream&
+    operator<<(std::ostream& s, const SysfsScanner& sysfs_scanner)
+    {
+	s << "block-entries:" << sysfs_scanner.block_entries.size() << " entries:"
+	  << sysfs_scanner.entries.size() << '\n';
+
+	return s;
+    }
+
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2026 SUSE LLC
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+
+#ifndef STORAGE_SYSFS_SCANNER_H
+#define STORAGE_SYSFS_SCANNER_H
+
+
+#include <sys/types.h>
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include "storage/Utils/Udev.h"
+
+
+namespace storage
+{
+    using std::string;
+    using std::vector;
+    using std::map;
+
+
+    /**
+     * Reads the sysfs attributes of all block devices needed during probing in
+     * one pass over /sys/class/block without running any commands. Also checks
+     * the device nodes in /dev.
+     */
+    class SysfsScanner
+    {
+    public:
+
+	struct Entry
+	{
+	    // kernel name, e.g. "sda1"
+	    string name;
+
+	    // sysfs path as reported by udev, e.g. "/devices/.../block/sda/sda1"
+	    string sysfs_path;
+
+	    // attribute, e.g. "queue/rotational", to content
+	    map<string, vector<string>> attributes;
+
+	    // directory, e.g. "holders", to entries
+	    map<string, vector<string>> dirs;
+
+	    // mode of the device node, 0 if it does not exist
+	    mode_t dev_mode = 0;
+	};
+
+	/**
+	 * The root is prepended to the paths of sysfs and of the device
+	 * nodes. Only used by the testsuite.
+	 */
+	SysfsScanner(Udevadm& udevadm, const string& root = "");
+
+	/**
+	 * Entries of /sys/block.
+	 */
+	const vector<string>& get_block_entries() const { return block_entries; }
+
+	const vector<Entry>& get_entries() const { return entries; }
+
+	friend std::ostream& operator<<(std::ostream& s, const SysfsScanner& sysfs_scanner);
+
+    private:
+
+	vector<string> block_entries;
+
+	vector<Entry> entries;
+
+    };
+
+}
+
+
+#endif
@@ -22,6 +22,10 @@
 
 
 #include "storage/SystemInfo/SystemInfoImpl.h"
+#include "storage/Utils/StorageDefines.h"
+#include "storage/Utils/Mockup.h"
+#include "storage/Utils/BtrfsIoctl.h"
+#include "storage/EnvironmentImpl.h"
 
 
 namespace storage
@@ -42,18 +46,151 @@ namespace storage
     const CmdUdevadmInfo&
     SystemInfo::Impl::getCmdUdevadmInfo(const string& file)
     {
-	for (const auto& tmp : cmd_udevadm_infos.get_data())
 	{
-	    // does not have an object iff the constructor threw
-	    if (!tmp.second.has_object())
-		continue;
+	    std::lock_guard<std::mutex> lock(cmd_udevadm_info_aliases_mutex);
 
-	    const CmdUdevadmInfo& cmd_udevadm_info = tmp.second.get_object();
-	    if (cmd_udevadm_info.is_alias_of(file))
-		return cmd_udevadm_info;
+	    std::unordered_map<string, const CmdUdevadmInfo*>::const_iterator it = cmd_udevadm_info_aliases.find(file);
+	    if (it != cmd_udevadm_info_aliases.end())
+		return *it->second;
 	}
 
-	return cmd_udevadm_infos.get2(udevadm, file);
+	const CmdUdevadmInfo& cmd_udevadm_info = cmd_udevadm_infos.get2(udevadm, file);
+
+	add_cmd_udevadm_info_aliases(cmd_udevadm_info);
+
+	return cmd_udevadm_info;
+    }
+
+
+    void
+    SystemInfo::Impl::prefetchCmdUdevadmInfo(const vector<string>& files, int max_threads)
+    {
+	// Settle once here instead of in the threads.
+
+	udevadm.settle();
+
+	cmd_udevadm_infos.prefetch2(udevadm, files, max_threads);
+
+	for (const string& file : files)
+	{
+	    const CmdUdevadmInfo* cmd_udevadm_info = cmd_udevadm_infos.find_object(file);
+	    if (cmd_udevadm_info)
+		add_cmd_udevadm_info_aliases(*cmd_udevadm_info);
+	}
+    }
+
+
+    void
+    SystemInfo::Impl::prefetchCmdUdevadmInfoAll()
+    {
+	const CmdUdevadmExportDb cmd_udevadm_export_db(udevadm);
+
+	for (const CmdUdevadmInfo& tmp : cmd_udevadm_export_db.get_infos())
+	{
+	    const CmdUdevadmInfo* cmd_udevadm_info =
+		cmd_udevadm_infos.insert(DEV_DIR "/" + tmp.get_name(), std::make_unique<CmdUdevadmInfo>(tmp));
+	    if (cmd_udevadm_info)
+		add_cmd_udevadm_info_aliases(*cmd_udevadm_info);
+	}
+    }
+
+
+    void
+    SystemInfo::Impl::prefetchCmdLvmFullreport()
+    {
+	const CmdLvmFullreport cmd_lvm_fullreport;
+
+	cmd_pvs.set_object(std::make_unique<CmdPvs>(cmd_lvm_fullreport));
+	cmd_vgs.set_object(std::make_unique<CmdVgs>(cmd_lvm_fullreport));
+	cmd_lvs.set_object(std::make_unique<CmdLvs>(cmd_lvm_fullreport));
+    }
+
+
+    void
+    SystemInfo::Impl::prefetchSysfs()
+    {
+	if (Mockup::get_mode() == Mockup::Mode::PLAYBACK || get_remote_callbacks())
+	    return;
+
+	const SysfsScanner sysfs_scanner(udevadm);
+
+	prefetchSysfs(sysfs_scanner);
+    }
+
+
+    void
+    SystemInfo::Impl::prefetchSysfs(const SysfsScanner& sysfs_scanner)
+    {
+	dirs.insert(SYSFS_DIR "/block", std::make_unique<Dir>(SYSFS_DIR "/block",
+							      sysfs_scanner.get_block_entries()));
+
+	for (const SysfsScanner::Entry& entry : sysfs_scanner.get_entries())
+	{
+	    const string path = SYSFS_DIR + entry.sysfs_path + "/";
+
+	    for (const map<string, vector<string>>::value_type& attribute : entry.attributes)
+		files.insert(path + attribute.first, std::make_unique<File>(path + attribute.first,
+									    attribute.second));
+
+	    for (const map<string, vector<string>>::value_type& dir : entry.dirs)
+		dirs.insert(path + dir.first, std::make_unique<Dir>(path + dir.first, dir.second));
+
+	    const string name = DEV_DIR "/" + entry.name;
+
+	    cmd_stats.insert(name, std::make_unique<CmdStat>(name, entry.dev_mode));
+	}
+    }
+
+
+    void
+    SystemInfo::Impl::prefetchBtrfsSubvolumes(const string& device, const string& mount_point)
+    {
+	if (!native_access_possible())
+	    return;
+
+	const BtrfsIoctl::Subvolumes subvolumes = BtrfsIoctl::get_subvolumes(mount_point);
+
+	cmd_btrfs_subvolume_lists.insert(device, std::make_unique<CmdBtrfsSubvolumeList>(subvolumes));
+	cmd_btrfs_subvolume_shows.insert(device, std::make_unique<CmdBtrfsSubvolumeShow>(subvolumes));
+	cmd_btrfs_subvolume_get_defaults.insert(device, std::make_unique<CmdBtrfsSubvolumeGetDefault>(subvolumes));
+
+	for (const BtrfsIoctl::Subvolume& subvolume : subvolumes.subvolumes)
+	{
+	    try
+	    {
+		bool nocow = BtrfsIoctl::is_nocow(mount_point + "/" + subvolume.path);
+
+		cmd_lsattr.insert(CmdLsattr::key_t(device, subvolume.path),
+				  std::make_unique<CmdLsattr>(mount_point, subvolume.path, nocow));
+	    }
+	    catch (const Exception& exception)
+	    {
+		// Not fatal, lsattr is run for the subvolume later.
+		ST_CAUGHT(exception);
+	    }
+	}
+    }
+
+
+    void
+    SystemInfo::Impl::add_cmd_udevadm_info_aliases(const CmdUdevadmInfo& cmd_udevadm_info)
+    {
+	std::lock_guard<std::mutex> lock(cmd_udevadm_info_aliases_mutex);
+
+	for (const string& alias : cmd_udevadm_info.get_aliases())
+	    cmd_udevadm_info_aliases.emplace(alias, &cmd_udevadm_info);
+    }
+
+
+    void
+    SystemInfo::Impl::prefetchParted(const vector<string>& devices, int max_threads)
+    {
+	// The parted version is cached in static variables. Query it here to
+	// avoid doing so in the threads.
+
+	CmdPartedVersion::query_version();
+
+	parteds.prefetch2(udevadm, devices, max_threads);
     }
 
 }
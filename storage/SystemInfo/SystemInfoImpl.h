@@ -25,11 +25,19 @@
 #define STORAGE_SYSTEM_INFO_IMPL_H
 
 
+#include <mutex>
+#include <atomic>
+#include <array>
+#include <functional>
+#include <unordered_map>
+#include <boost/functional/hash.hpp>
+
 #include "storage/EtcFstab.h"
 #include "storage/EtcCrypttab.h"
 #include "storage/EtcMdadm.h"
 
 #include "storage/Utils/Udev.h"
+#include "storage/Utils/WorkerPool.h"
 #include "storage/SystemInfo/SystemInfo.h"
 #include "storage/SystemInfo/Arch.h"
 #include "storage/SystemInfo/ProcMounts.h"
@@ -52,6 +60,7 @@
 #include "storage/SystemInfo/CmdLvm.h"
 #include "storage/SystemInfo/CmdUdevadm.h"
 #include "storage/SystemInfo/DevAndSys.h"
+#include "storage/SystemInfo/SysfsScanner.h"
 
 
 namespace storage
@@ -140,6 +149,55 @@ namespace storage
 	 */
 	const CmdUdevadmInfo& getCmdUdevadmInfo(const string& file);
 
+	/* The prefetch functions run the commands for several arguments in
+	   parallel using up to max_threads threads. Afterwards the results (or
+	   exceptions) are available via the corresponding get functions. */
+
+	void prefetchCmdStat(const vector<string>& paths, int max_threads)
+	    { cmd_stats.prefetch(paths, max_threads); }
+	void prefetchCmdUdevadmInfo(const vector<string>& files, int max_threads);
+
+	/**
+	 * Fills the cache of getCmdUdevadmInfo() for all block devices using a single
+	 * 'udevadm info --export-db' call.
+	 */
+	void prefetchCmdUdevadmInfoAll();
+
+	/**
+	 * Fills the caches of getCmdPvs(), getCmdVgs() and getCmdLvs() using a
+	 * single 'lvm fullreport' call.
+	 */
+	void prefetchCmdLvmFullreport();
+
+	/**
+	 * Fills the caches of getDir(), getFile() and getCmdStat() for all block
+	 * devices using the SysfsScanner. Does nothing in mockup playback mode or
+	 * with remote callbacks.
+	 */
+	void prefetchSysfs();
+
+	/**
+	 * Fills the caches of getDir(), getFile() and getCmdStat() with the
+	 * result of the sysfs_scanner.
+	 */
+	void prefetchSysfs(const SysfsScanner& sysfs_scanner);
+
+	/**
+	 * Fills the caches of getCmdBtrfsSubvolumeList(),
+	 * getCmdBtrfsSubvolumeShow(), getCmdBtrfsSubvolumeGetDefault() and
+	 * getCmdLsattr() for the btrfs on device mounted at mount_point using
+	 * ioctls. Does nothing in mockup mode or with remote callbacks.
+	 */
+	void prefetchBtrfsSubvolumes(const string& device, const string& mount_point);
+
+	void prefetchCmdMdadmDetail(const vector<string>& devices, int max_threads)
+	    { cmd_mdadm_details.prefetch(devices, max_threads); }
+	void prefetchDasdview(const vector<string>& devices, int max_threads)
+	    { dasdviews.prefetch(devices, max_threads); }
+	void prefetchParted(const vector<string>& devices, int max_threads);
+	void prefetchCmdCryptsetupLuksDump(const vector<string>& names, int max_threads)
+	    { cmd_cryptsetup_luks_dumps.prefetch(names, max_threads); }
+
 	const CmdDf& getCmdDf(const string& mount_point) { return cmd_dfs.get(mount_point); }
 
 	// The device is only used for the cache-key.
@@ -150,7 +208,12 @@ namespace storage
 
 	/* LazyObject, LazyObjects and LazyObjectsWithKey cache the object and a potential
 	   exception during object construction. The object is constructed during the
-	   first call of get(), thus "lazy". HelperBase does the common part. */
+	   first call of get(), thus "lazy". HelperBase does the common part.
+
+	   All of them can be used from several threads. The object for a key is only
+	   constructed once, other threads asking for the same key wait. LazyObjects and
+	   LazyObjectsWithKey distribute the keys over several shards, each with its own
+	   mutex, so that threads working on different keys rarely block each other. */
 
 	template <class Object, typename... Args>
 	class HelperBase
@@ -159,6 +222,11 @@ namespace storage
 
 	    const Object& get(Args... args)
 	    {
+		if (const Object* tmp = published.load(std::memory_order_acquire))
+		    return *tmp;
+
+		std::lock_guard<std::mutex> lock(mutex);
+
 		if (ep)
 		    std::rethrow_exception(ep);
 
@@ -167,6 +235,7 @@ namespace storage
 		    try
 		    {
 			object = make_unique<Object>(args...);
+			published.store(object.get(), std::memory_order_release);
 		    }
 		    catch (const std::exception& e)
 		    {
@@ -183,6 +252,11 @@ namespace storage
 	     */
 	    const Object& get2(Udevadm& udevadm, Args... args)
 	    {
+		if (const Object* tmp = published.load(std::memory_order_acquire))
+		    return *tmp;
+
+		std::lock_guard<std::mutex> lock(mutex);
+
 		if (ep)
 		    std::rethrow_exception(ep);
 
@@ -191,6 +265,7 @@ namespace storage
 		    try
 		    {
 			object = make_unique<Object>(udevadm, args...);
+			published.store(object.get(), std::memory_order_release);
 		    }
 		    catch (const std::exception& e)
 		    {
@@ -202,23 +277,98 @@ namespace storage
 		return *object;
 	    }
 
-	    bool has_object() const { return (bool)(object); }
-	    const Object& get_object() const { return *object; }
+	    /**
+	     * Sets the object unless the object or an exception is already set.
+	     * Returns the object or nullptr if an exception is set.
+	     */
+	    const Object* set_object(std::unique_ptr<Object> tmp)
+	    {
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if (!object && !ep)
+		{
+		    object = std::move(tmp);
+		    published.store(object.get(), std::memory_order_release);
+		}
+
+		return object.get();
+	    }
+
+	    /**
+	     * Does not block while the object is constructed by another thread.
+	     */
+	    bool has_object() const { return published.load(std::memory_order_acquire); }
+	    const Object& get_object() const { return *published.load(std::memory_order_acquire); }
 
 	private:
 
+	    std::mutex mutex;
+
 	    std::unique_ptr<Object> object;
 	    std::exception_ptr ep;
 
+	    // Set once the object is constructed. Allows to return the object without
+	    // locking the mutex.
+	    std::atomic<const Object*> published { nullptr };
+
 	};
 
 
 	template <class Object>
-	class LazyObject : public HelperBase<Object>, private boost::noncopyable
+	class LazyObject : public HelperBase<Object>
 	{
 	};
 
 
+	/* A map from keys to helpers split into several shards. Since entries are
+	   never removed references to helpers stay valid. */
+
+	template <class Key, class Helper>
+	class ShardedMap
+	{
+	public:
+
+	    Helper& find_or_insert(const Key& key)
+	    {
+		Shard& shard = get_shard(key);
+
+		std::lock_guard<std::mutex> lock(shard.mutex);
+
+		typename map<Key, Helper>::iterator pos = shard.data.lower_bound(key);
+		if (pos == shard.data.end() || shard.data.key_comp()(key, pos->first))
+		    pos = shard.data.emplace_hint(pos, std::piecewise_construct, std::forward_as_tuple(key),
+						  std::forward_as_tuple());
+		return pos->second;
+	    }
+
+	    const Helper* find(const Key& key) const
+	    {
+		const Shard& shard = get_shard(key);
+
+		std::lock_guard<std::mutex> lock(shard.mutex);
+
+		typename map<Key, Helper>::const_iterator pos = shard.data.find(key);
+		return pos != shard.data.end() ? &pos->second : nullptr;
+	    }
+
+	private:
+
+	    static const size_t num_shards = 16;
+
+	    struct Shard
+	    {
+		mutable std::mutex mutex;
+		map<Key, Helper> data;
+	    };
+
+	    Shard& get_shard(const Key& key) { return shards[boost::hash<Key>()(key) % num_shards]; }
+	    const Shard& get_shard(const Key& key) const { return shards[boost::hash<Key>()(key) % num_shards]; }
+
+	    std::array<Shard, num_shards> shards;
+
+	};
+
+
 	template <class Object, class Arg = string>
 	class LazyObjects : private boost::noncopyable
 	{
@@ -228,25 +378,72 @@ namespace storage
 
 	    const Object& get(const Arg& arg)
 	    {
-		typename map<Arg, Helper>::iterator pos = data.lower_bound(arg);
-		if (pos == data.end() || typename map<Arg, Helper>::key_compare()(arg, pos->first))
-		    pos = data.insert(pos, typename map<Arg, Helper>::value_type(arg, Helper()));
-		return pos->second.get(arg);
+		return data.find_or_insert(arg).get(arg);
 	    }
 
 	    const Object& get2(Udevadm& udevadm, const Arg& arg)
 	    {
-		typename map<Arg, Helper>::iterator pos = data.lower_bound(arg);
-		if (pos == data.end() || typename map<Arg, Helper>::key_compare()(arg, pos->first))
-		    pos = data.insert(pos, typename map<Arg, Helper>::value_type(arg, Helper()));
-		return pos->second.get2(udevadm, arg);
+		return data.find_or_insert(arg).get2(udevadm, arg);
 	    }
 
-	    const map<Arg, Helper>& get_data() const { return data; }
+	    void prefetch(const vector<Arg>& args, int max_threads)
+	    {
+		prefetch_helper(args, max_threads, [this](const Arg& arg) {
+		    get(arg);
+		});
+	    }
+
+	    void prefetch2(Udevadm& udevadm, const vector<Arg>& args, int max_threads)
+	    {
+		prefetch_helper(args, max_threads, [this, &udevadm](const Arg& arg) {
+		    get2(udevadm, arg);
+		});
+	    }
+
+	    /**
+	     * Adds an object constructed elsewhere. If the cache already has an
+	     * entry for arg the object is discarded.
+	     */
+	    const Object* insert(const Arg& arg, std::unique_ptr<Object> object)
+	    {
+		return data.find_or_insert(arg).set_object(std::move(object));
+	    }
+
+	    /**
+	     * Returns the object for arg if it is already constructed, otherwise
+	     * nullptr. Never constructs the object.
+	     */
+	    const Object* find_object(const Arg& arg) const
+	    {
+		const Helper* helper = data.find(arg);
+		return helper && helper->has_object() ? &helper->get_object() : nullptr;
+	    }
 
 	private:
 
-	    map<Arg, Helper> data;
+	    template <typename Func>
+	    void prefetch_helper(const vector<Arg>& args, int max_threads, Func func)
+	    {
+		vector<std::function<void()>> tasks;
+
+		for (const Arg& arg : args)
+		{
+		    tasks.push_back([&arg, &func]() {
+			try
+			{
+			    func(arg);
+			}
+			catch (...)
+			{
+			    // the exception is cached in the helper
+			}
+		    });
+		}
+
+		run_in_worker_pool(tasks, max_threads);
+	    }
+
+	    ShardedMap<Arg, Helper> data;
 
 	};
 
@@ -262,21 +459,26 @@ namespace storage
 
 	    bool includes(const Key& key) const
 	    {
-		typename map<Key, Helper>::const_iterator pos = data.lower_bound(key);
-		return pos != data.end() && !typename map<Key, Helper>::key_compare()(key, pos->first);
+		return data.find(key);
 	    }
 
 	    const Object& get(const Key& key, Args... args)
 	    {
-		typename map<Key, Helper>::iterator pos = data.lower_bound(key);
-		if (pos == data.end() || typename map<Key, Helper>::key_compare()(key, pos->first))
-		    pos = data.insert(pos, typename map<Key, Helper>::value_type(key, Helper()));
-		return pos->second.get(key, args...);
+		return data.find_or_insert(key).get(key, args...);
+	    }
+
+	    /**
+	     * Adds an object constructed elsewhere. If the cache already has an
+	     * entry for key the object is discarded.
+	     */
+	    const Object* insert(const Key& key, std::unique_ptr<Object> object)
+	    {
+		return data.find_or_insert(key).set_object(std::move(object));
 	    }
 
 	private:
 
-	    map<Key, Helper> data;
+	    ShardedMap<Key, Helper> data;
 
 	};
 
@@ -319,6 +521,13 @@ namespace storage
 	LazyObject<CmdLvs> cmd_lvs;
 
 	LazyObjects<CmdUdevadmInfo> cmd_udevadm_infos;
+
+	/* Index from the links, e.g. /dev/disk/by-id/..., of all objects in
+	   cmd_udevadm_infos to the objects. */
+	std::unordered_map<string, const CmdUdevadmInfo*> cmd_udevadm_info_aliases;
+	std::mutex cmd_udevadm_info_aliases_mutex;
+
+	void add_cmd_udevadm_info_aliases(const CmdUdevadmInfo& cmd_udevadm_info);
 	LazyObjects<CmdDf> cmd_dfs;
 
 	LazyObjectsWithKey<CmdLsattr, string, string> cmd_lsattr;
@@ -0,0 +1,452 @@
+/*
+ * Copyright (c) 2026 SUSE LLC
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fstream>
+#include <map>
+
+#include "storage/Utils/BinaryXmlFile.h"
+#include "storage/Utils/ExceptionImpl.h"
+#include "storage/Utils/Format.h"
+
+
+namespace storage
+{
+    using namespace std;
+
+
+    namespace
+    {
+
+	const char magic[8] = { 'L', 'S', 'T', 'G', 'B', 'X', 'M', 'L' };
+
+	const uint32_t version = 1;
+
+	const size_t header_size = sizeof(magic) + 4 * 4;
+
+	// smallest possible encoding of an element: name index, kind and
+	// number of children
+	const size_t min_element_size = 4 + 1 + 4;
+
+	const uint8_t KIND_CHILDREN = 0;
+	const uint8_t KIND_TEXT = 1;
+
+	const unsigned int max_depth = 256;
+
+	// name libxml2 uses for text nodes
+	const xmlChar text_name[] = "text";
+
+
+	void
+	put_u32(string& out, uint32_t value)
+	{
+	    for (int i = 0; i < 4; ++i)
+		out += (char)(value >> (8 * i));
+	}
+
+
+	void
+	put_string(string& out, const char* value)
+	{
+	    size_t length = strlen(value);
+	    put_u32(out, length);
+	    out.append(value, length + 1);
+	}
+
+
+	/**
+	 * Returns the text of the node if it is the only child of the node.
+	 * Returns nullptr if the node has no children or only elements and
+	 * comments as children.
+	 *
+	 * @throw Exception if text and elements are mixed
+	 */
+	const xmlNode*
+	get_text_node(const xmlNode* node)
+	{
+	    const xmlNode* text_node = nullptr;
+	    bool has_elements = false;
+
+	    for (const xmlNode* child = node->children; child; child = child->next)
+	    {
+		if (child->type == XML_TEXT_NODE)
+		{
+		    if (text_node)
+			ST_THROW(Exception("several texts in xml element"));
+		    text_node = child;
+		}
+		else if (child->type == XML_ELEMENT_NODE)
+		{
+		    has_elements = true;
+		}
+	    }
+
+	    if (text_node && has_elements)
+		ST_THROW(Exception("mixed content in xml element"));
+
+	    return text_node;
+	}
+
+
+	class Writer
+	{
+
+	public:
+
+	    void collect(const xmlNode* node)
+	    {
+		++num_elements;
+
+		const string name = (const char*)(node->name);
+		if (names.find(name) == names.end())
+		    names.emplace(name, names.size());
+
+		if (get_text_node(node))
+		{
+		    ++num_texts;
+		    return;
+		}
+
+		for (const xmlNode* child = node->children; child; child = child->next)
+		{
+		    if (child->type == XML_ELEMENT_NODE)
+			collect(child);
+		}
+	    }
+
+	    void write_header(string& out) const
+	    {
+		out.append(magic, sizeof(magic));
+		put_u32(out, version);
+		put_u32(out, names.size());
+		put_u32(out, num_elements);
+		put_u32(out, num_texts);
+
+		vector<const string*> tmp(names.size());
+		for (const map<string, uint32_t>::value_type& name : names)
+		    tmp[name.second] = &name.first;
+
+		for (const string* name : tmp)
+		    put_string(out, name->c_str());
+	    }
+
+	    void write_element(string& out, const xmlNode* node) const
+	    {
+		put_u32(out, names.at((const char*)(node->name)));
+
+		const xmlNode* text_node = get_text_node(node);
+		if (text_node)
+		{
+		    out += (char)(KIND_TEXT);
+		    put_string(out, text_node->content ? (const char*)(text_node->content) : "");
+		    return;
+		}
+
+		uint32_t num_children = 0;
+		for (const xmlNode* child = node->children; child; child = child->next)
+		{
+		    if (child->type == XML_ELEMENT_NODE)
+			++num_children;
+		}
+
+		out += (char)(KIND_CHILDREN);
+		put_u32(out, num_children);
+
+		for (const xmlNode* child = node->children; child; child = child->next)
+		{
+		    if (child->type == XML_ELEMENT_NODE)
+			write_element(out, child);
+		}
+	    }
+
+	private:
+
+	    map<string, uint32_t> names;
+	    uint32_t num_elements = 0;
+	    uint32_t num_texts = 0;
+
+	};
+
+
+	class Reader
+	{
+
+	public:
+
+	    Reader(const uint8_t* data, size_t size)
+		: pos(data), end(data + size)
+	    {
+	    }
+
+	    uint8_t read_u8()
+	    {
+		check(1);
+		return *pos++;
+	    }
+
+	    uint32_t read_u32()
+	    {
+		check(4);
+		uint32_t value = (uint32_t)(pos[0]) | (uint32_t)(pos[1]) << 8 | (uint32_t)(pos[2]) << 16 |
+		    (uint32_t)(pos[3]) << 24;
+		pos += 4;
+		return value;
+	    }
+
+	    const xmlChar* read_string()
+	    {
+		uint32_t length = read_u32();
+		check((size_t)(length) + 1);
+
+		const uint8_t* value = pos;
+		if (value[length] != 0)
+		    ST_THROW(Exception("string not terminated in binary xml file"));
+
+		pos += length + 1;
+		return value;
+	    }
+
+	    bool at_end() const { return pos == end; }
+
+	    size_t remaining() const { return end - pos; }
+
+	private:
+
+	    void check(size_t length) const
+	    {
+		if ((size_t)(end - pos) < length)
+		    ST_THROW(Exception("binary xml file truncated"));
+	    }
+
+	    const uint8_t* pos;
+	    const uint8_t* const end;
+
+	};
+
+
+	class Builder
+	{
+
+	public:
+
+	    Builder(Reader& reader, const vector<const xmlChar*>& names, vector<xmlNode>& nodes)
+		: reader(reader), names(names), nodes(nodes)
+	    {
+	    }
+
+	    xmlNode* read_element(xmlNode* parent, unsigned int depth)
+	    {
+		if (depth > max_depth)
+		    ST_THROW(Exception("binary xml file nested too deeply"));
+
+		xmlNode* node = new_node();
+		node->type = XML_ELEMENT_NODE;
+		node->parent = parent;
+
+		uint32_t name_index = reader.read_u32();
+		if (name_index >= names.size())
+		    ST_THROW(Exception("invalid name index in binary xml file"));
+		node->name = names[name_index];
+
+		switch (reader.read_u8())
+		{
+		    case KIND_TEXT:
+		    {
+			xmlNode* text_node = new_node();
+			text_node->type = XML_TEXT_NODE;
+			text_node->name = text_name;
+			text_node->parent = node;
+			text_node->content = const_cast<xmlChar*>(reader.read_string());
+
+			node->children = node->last = text_node;
+		    }
+		    break;
+
+		    case KIND_CHILDREN:
+		    {
+			uint32_t num_children = reader.read_u32();
+
+			for (uint32_t i = 0; i < num_children; ++i)
+			{
+			    xmlNode* child = read_element(node, depth + 1);
+
+			    if (node->last)
+			    {
+				node->last->next = child;
+				child->prev = node->last;
+			    }
+			    else
+			    {
+				node->children = child;
+			    }
+
+			    node->last = child;
+			}
+		    }
+		    break;
+
+		    default:
+			ST_THROW(Exception("invalid element kind in binary xml file"));
+		}
+
+		return node;
+	    }
+
+	    bool complete() const { return used == nodes.size(); }
+
+	private:
+
+	    xmlNode* new_node()
+	    {
+		if (used == nodes.size())
+		    ST_THROW(Exception("too many nodes in binary xml file"));
+
+		return &nodes[used++];
+	    }
+
+	    Reader& reader;
+	    const vector<const xmlChar*>& names;
+	    vector<xmlNode>& nodes;
+	    size_t used = 0;
+
+	};
+
+    }
+
+
+    BinaryXmlFile::BinaryXmlFile(const string& filename)
+    {
+	int fd = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+	    ST_THROW(Exception(sformat("failed to open binary xml file %s, errno:%d", filename, errno)));
+
+	struct stat st;
+	if (fstat(fd, &st) != 0)
+	{
+	    close(fd);
+	    ST_THROW(Exception(sformat("fstat failed for %s, errno:%d", filename, errno)));
+	}
+
+	size = st.st_size;
+	if (size < header_size)
+	{
+	    close(fd);
+	    ST_THROW(Exception("not a binary xml file " + filename));
+	}
+
+	data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (data == MAP_FAILED)
+	{
+	    data = nullptr;
+	    ST_THROW(Exception(sformat("mmap failed for %s, errno:%d", filename, errno)));
+	}
+
+	try
+	{
+	    const uint8_t* p = (const uint8_t*)(data);
+
+	    if (memcmp(p, magic, sizeof(magic)) != 0)
+		ST_THROW(Exception("not a binary xml file " + filename));
+
+	    Reader reader(p + sizeof(magic), size - sizeof(magic));
+
+	    if (reader.read_u32() != version)
+		ST_THROW(Exception("unsupported version of binary xml file " + filename));
+
+	    const uint32_t num_names = reader.read_u32();
+	    const uint32_t num_elements = reader.read_u32();
+	    const uint32_t num_texts = reader.read_u32();
+
+	    // The counts are limited by the size of the file so that a
+	    // corrupt file cannot cause a huge allocation.
+
+	    if (num_elements == 0 || num_elements > reader.remaining() / min_element_size ||
+		num_texts > num_elements || num_names > num_elements)
+		ST_THROW(Exception("invalid counts in binary xml file " + filename));
+
+	    vector<const xmlChar*> names;
+	    names.reserve(num_names);
+	    for (uint32_t i = 0; i < num_names; ++i)
+		names.push_back(reader.read_string());
+
+	    nodes.resize((size_t)(num_elements) + num_texts);
+
+	    Builder builder(reader, names, nodes);
+	    builder.read_element(nullptr, 0);
+
+	    if (!builder.complete() || !reader.at_end())
+		ST_THROW(Exception("inconsistent binary xml file " + filename));
+	}
+	catch (const Exception&)
+	{
+	    munmap(data, size);
+	    data = nullptr;
+	    throw;
+	}
+    }
+
+
+    BinaryXmlFile::~BinaryXmlFile()
+    {
+	if (data)
+	    munmap(data, size);
+    }
+
+
+    void
+    BinaryXmlFile::save_to_file(const xmlNode* root_node, const string& filename)
+    {
+	Writer writer;
+	writer.collect(root_node);
+
+	string out;
+	writer.write_header(out);
+	writer.write_element(out, root_node);
+
+	std::ofstream s(filename, std::ios::binary | std::ios::trunc);
+	s.write(out.data(), out.size());
+	s.close();
+
+	if (!s)
+	    ST_THROW(Exception(sformat("failed to write '%s'", filename)));
+    }
+
+
+    bool
+    BinaryXmlFile::is_binary_xml_file(const string& filename)
+    {
+	char buffer[sizeof(magic)];
+
+	std::ifstream s(filename, std::ios::binary);
+	s.read(buffer, sizeof(buffer));
+
+	return s && memcmp(buffer, magic, sizeof(magic)) == 0;
+    }
+
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2026 SUSE LLC
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#ifndef STORAGE_BINARY_XML_FILE_H
+#define STORAGE_BINARY_XML_FILE_H
+
+
+#include <libxml/tree.h>
+#include <string>
+#include <vector>
+#include <boost/noncopyable.hpp>
+
+
+namespace storage
+{
+    using std::string;
+    using std::vector;
+
+
+    /**
+     * Compact binary encoding of the element trees used by XmlFile.
+     *
+     * The file consists of a header, a table of the distinct element names
+     * and the elements in pre-order. Each element refers to its name by
+     * index and either has a list of child elements or a text. All strings
+     * are stored NUL terminated.
+     *
+     * Loading maps the file and builds the nodes in a single array in one
+     * pass over the data. The names and texts of the nodes point directly
+     * into the mapping. Thus the nodes can be used with the getChildNode()
+     * and getChildValue() functions like the nodes of an XmlFile but
+     * neither parsing of XML nor a libxml2 document is involved.
+     */
+    class BinaryXmlFile : private boost::noncopyable
+    {
+
+    public:
+
+	/**
+	 * Loads the file.
+	 *
+	 * @throw Exception if the file cannot be read or is invalid
+	 */
+	BinaryXmlFile(const string& filename);
+
+	~BinaryXmlFile();
+
+	const xmlNode* getRootElement() const { return nodes.empty() ? nullptr : &nodes.front(); }
+
+	/**
+	 * Saves the element tree starting at root_node. Comments are
+	 * skipped.
+	 *
+	 * @throw Exception if the file cannot be written
+	 */
+	static void save_to_file(const xmlNode* root_node, const string& filename);
+
+	/**
+	 * Checks whether the file starts with the magic of the binary
+	 * format.
+	 */
+	static bool is_binary_xml_file(const string& filename);
+
+    private:
+
+	void* data = nullptr;
+	size_t size = 0;
+
+	vector<xmlNode> nodes;
+
+    };
+
+}
+
+
+#endif
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2026 SUSE LLC
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <linux/fs.h>
+#include <algorithm>
+
+#include "storage/Utils/ExceptionImpl.h"
+#include "storage/Utils/Format.h"
+#include "storage/Utils/BlockReader.h"
+
+
+namespace storage
+{
+    using namespace std;
+
+
+    BlockReader::BlockReader(const string& name)
+	: name(name)
+    {
+	// O_NONBLOCK avoids waiting for e.g. the medium of a removable
+	// device.
+
+	fd = open(name.c_str(), O_RDONLY | O_CLOEXEC | O_NONBLOCK | O_DIRECT);
+	if (fd < 0 && errno == EINVAL)
+	    fd = open(name.c_str(), O_RDONLY | O_CLOEXEC | O_NONBLOCK);
+	if (fd < 0)
+	    ST_THROW(Exception(sformat("open failed for %s, errno:%d", name, errno)));
+
+	struct stat st;
+	if (fstat(fd, &st) != 0)
+	{
+	    close(fd);
+	    ST_THROW(Exception(sformat("fstat failed for %s, errno:%d", name, errno)));
+	}
+
+	if (S_ISBLK(st.st_mode))
+	{
+	    int logical_sector_size = 0;
+	    if (ioctl(fd, BLKGETSIZE64, &size) != 0 || ioctl(fd, BLKSSZGET, &logical_sector_size) != 0)
+	    {
+		close(fd);
+		ST_THROW(Exception(sformat("ioctl failed for %s, errno:%d", name, errno)));
+	    }
+
+	    sector_size = logical_sector_size;
+	}
+	else
+	{
+	    size = st.st_size;
+	}
+    }
+
+
+    BlockReader::~BlockReader()
+    {
+	close(fd);
+    }
+
+
+    vector<uint8_t>
+    BlockReader::read(uint64_t offset, size_t length) const
+    {
+	if (offset > size || length > size - offset)
+	    ST_THROW(Exception(sformat("read beyond end of %s", name)));
+
+	// O_DIRECT needs an aligned buffer, offset and length. At the end of
+	// the device the read can be short.
+
+	const uint64_t alignment = max(4096U, sector_size);
+
+	const uint64_t start = offset - offset % alignment;
+	const uint64_t end = (offset + length + alignment - 1) / alignment * alignment;
+	const uint64_t needed = offset + length - start;
+
+	void* buffer = nullptr;
+	if (posix_memalign(&buffer, alignment, end - start) != 0)
+	    ST_THROW(Exception("posix_memalign failed"));
+
+	size_t done = 0;
+	while (done < needed)
+	{
+	    ssize_t n = pread(fd, (char*)(buffer) + done, end - start - done, start + done);
+	    if (n < 0 && errno == EINTR)
+		continue;
+
+	    if (n <= 0)
+	    {
+		free(buffer);
+		ST_THROW(Exception(sformat("read failed for %s, errno:%d", name, errno)));
+	    }
+
+	    done += n;
+	}
+
+	const uint8_t* p = (const uint8_t*)(buffer) + (offset - start);
+	vector<uint8_t> ret(p, p + length);
+
+	free(buffer);
+
+	return ret;
+    }
+
+}
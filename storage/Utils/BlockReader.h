@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2026 SUSE LLC
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+
+#ifndef STORAGE_BLOCK_READER_H
+#define STORAGE_BLOCK_READER_H
+
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <boost/noncopyable.hpp>
+
+
+namespace storage
+{
+    using std::string;
+    using std::vector;
+
+
+    /**
+     * Reads from a block device or image file. O_DIRECT is used when
+     * available so that the data does not pollute the page cache and
+     * cannot be stale. The device is only opened read-only, so in contrast
+     * to e.g. parted no udev change event is triggered.
+     */
+    class BlockReader : private boost::noncopyable
+    {
+
+    public:
+
+	BlockReader(const string& name);
+	~BlockReader();
+
+	const string& get_name() const { return name; }
+
+	/**
+	 * The size in bytes.
+	 */
+	uint64_t get_size() const { return size; }
+
+	/**
+	 * The logical sector size. 512 for image files.
+	 */
+	unsigned int get_sector_size() const { return sector_size; }
+
+	/**
+	 * Reads length bytes at offset in one request. The request is
+	 * extended to aligned blocks as needed for O_DIRECT. Throws if the
+	 * range is not within the device.
+	 */
+	vector<uint8_t> read(uint64_t offset, size_t length) const;
+
+    private:
+
+	const string name;
+
+	int fd = -1;
+
+	uint64_t size = 0;
+	unsigned int sector_size = 512;
+
+    };
+
+}
+
+
+#endif
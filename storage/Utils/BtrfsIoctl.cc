@@ -0,0 +1,468 @@
+/*
+ * Copyright (c) 2026 SUSE LLC
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <endian.h>
+#include <stddef.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#include <linux/btrfs.h>
+#include <linux/btrfs_tree.h>
+#include <map>
+#include <functional>
+#include <algorithm>
+
+#include "storage/Utils/BtrfsIoctl.h"
+#include "storage/Utils/ExceptionImpl.h"
+#include "storage/Utils/LoggerImpl.h"
+
+
+namespace storage
+{
+
+    namespace BtrfsIoctl
+    {
+
+	namespace
+	{
+
+	    // objectid of the root directory of every subvolume
+	    const __u64 first_free_objectid = 256;
+
+
+	    /**
+	     * RAII for a file descriptor opened for a directory.
+	     */
+	    class DirFd
+	    {
+	    public:
+
+		DirFd(const string& path)
+		    : fd(open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC))
+		{
+		    if (fd < 0)
+			ST_THROW(Exception(Exception::strErrno(errno, "open of " + path + " failed")));
+		}
+
+		~DirFd() { close(fd); }
+
+		DirFd(const DirFd&) = delete;
+		DirFd& operator=(const DirFd&) = delete;
+
+		int get() const { return fd; }
+
+	    private:
+
+		const int fd;
+
+	    };
+
+
+	    string
+	    format_uuid(const __u8 uuid[BTRFS_UUID_SIZE])
+	    {
+		static const char hex[] = "0123456789abcdef";
+
+		if (std::all_of(uuid, uuid + BTRFS_UUID_SIZE, [](__u8 c) { return c == 0; }))
+		    return "";
+
+		string ret;
+
+		for (int i = 0; i < BTRFS_UUID_SIZE; ++i)
+		{
+		    if (i == 4 || i == 6 || i == 8 || i == 10)
+			ret += '-';
+
+		    ret += hex[uuid[i] >> 4];
+		    ret += hex[uuid[i] & 0x0f];
+		}
+
+		return ret;
+	    }
+
+
+	    using search_func_t = std::function<void(const btrfs_ioctl_search_header& header,
+						     const char* item)>;
+
+	    /**
+	     * Calls func for all items of the tree with keys between
+	     * (min_objectid, min_type, 0) and (max_objectid, max_type, -1). Since
+	     * keys are compared as a whole func also gets items with other types.
+	     */
+	    void
+	    search_tree(int fd, __u64 tree_id, __u64 min_objectid, __u64 max_objectid, __u32 min_type,
+			__u32 max_type, const search_func_t& func)
+	    {
+		const size_t buf_size = 64 * 1024;
+
+		vector<__u64> buffer((sizeof(btrfs_ioctl_search_args_v2) + buf_size) / sizeof(__u64));
+
+		btrfs_ioctl_search_args_v2* args = (btrfs_ioctl_search_args_v2*)(buffer.data());
+
+		btrfs_ioctl_search_key& key = args->key;
+		key.tree_id = tree_id;
+		key.min_objectid = min_objectid;
+		key.max_objectid = max_objectid;
+		key.min_type = min_type;
+		key.max_type = max_type;
+		key.min_offset = 0;
+		key.max_offset = (__u64)(-1);
+		key.min_transid = 0;
+		key.max_transid = (__u64)(-1);
+
+		while (true)
+		{
+		    key.nr_items = (__u32)(-1);
+		    args->buf_size = buf_size;
+
+		    if (ioctl(fd, BTRFS_IOC_TREE_SEARCH_V2, args) != 0)
+			ST_THROW(Exception(Exception::strErrno(errno, "tree search failed")));
+
+		    if (key.nr_items == 0)
+			return;
+
+		    const char* pos = (const char*)(args->buf);
+
+		    btrfs_ioctl_search_header header;
+
+		    for (__u32 i = 0; i < key.nr_items; ++i)
+		    {
+			// the headers are not necessarily aligned
+			memcpy(&header, pos, sizeof(header));
+			pos += sizeof(header);
+
+			func(header, pos);
+			pos += header.len;
+		    }
+
+		    // continue after the last item
+
+		    if (header.offset != (__u64)(-1))
+		    {
+			key.min_objectid = header.objectid;
+			key.min_type = header.type;
+			key.min_offset = header.offset + 1;
+		    }
+		    else if (header.type < max_type)
+		    {
+			key.min_objectid = header.objectid;
+			key.min_type = header.type + 1;
+			key.min_offset = 0;
+		    }
+		    else if (header.objectid < max_objectid)
+		    {
+			key.min_objectid = header.objectid + 1;
+			key.min_type = min_type;
+			key.min_offset = 0;
+		    }
+		    else
+		    {
+			return;
+		    }
+		}
+	    }
+
+
+	    /**
+	     * Returns the path of the directory dirid in the subvolume tree_id
+	     * relative to the subvolume, with a trailing slash unless empty.
+	     */
+	    string
+	    lookup_directory(int fd, __u64 tree_id, __u64 dirid)
+	    {
+		if (dirid == first_free_objectid)
+		    return "";
+
+		struct btrfs_ioctl_ino_lookup_args args;
+		memset(&args, 0, sizeof(args));
+		args.treeid = tree_id;
+		args.objectid = dirid;
+
+		if (ioctl(fd, BTRFS_IOC_INO_LOOKUP, &args) != 0)
+		    ST_THROW(Exception(Exception::strErrno(errno, "lookup of directory failed")));
+
+		return args.name;
+	    }
+
+
+	    struct RootInfo
+	    {
+		string uuid;
+		string parent_uuid;
+
+		bool has_ref = false;
+		__u64 parent_id = 0;
+		__u64 dirid = 0;
+		string name;
+	    };
+
+
+	    void
+	    parse_root_item(const btrfs_ioctl_search_header& header, const char* item, RootInfo& root_info)
+	    {
+		// Old kernels wrote a shorter root item without UUIDs. Also the
+		// UUIDs are only valid if generation_v2 matches generation.
+
+		if (header.len < offsetof(btrfs_root_item, ctransid))
+		    return;
+
+		btrfs_root_item root_item;
+		memcpy(&root_item, item, offsetof(btrfs_root_item, ctransid));
+
+		if (root_item.generation_v2 != root_item.generation)
+		    return;
+
+		root_info.uuid = format_uuid(root_item.uuid);
+		root_info.parent_uuid = format_uuid(root_item.parent_uuid);
+	    }
+
+
+	    void
+	    parse_root_backref(const btrfs_ioctl_search_header& header, const char* item, RootInfo& root_info)
+	    {
+		btrfs_root_ref root_ref;
+
+		if (header.len < sizeof(root_ref))
+		    ST_THROW(Exception("root backref too short"));
+
+		memcpy(&root_ref, item, sizeof(root_ref));
+
+		const __u16 name_len = le16toh(root_ref.name_len);
+		if (header.len < sizeof(root_ref) + name_len)
+		    ST_THROW(Exception("root backref too short"));
+
+		root_info.has_ref = true;
+		root_info.parent_id = header.offset;
+		root_info.dirid = le64toh(root_ref.dirid);
+		root_info.name = string(item + sizeof(root_ref), name_len);
+	    }
+
+
+	    /**
+	     * Returns the id from the dir item named "default" or 0 if there is
+	     * none. An item may contain several dir items.
+	     */
+	    __u64
+	    parse_default_dir_item(const btrfs_ioctl_search_header& header, const char* item)
+	    {
+		const char* pos = item;
+		const char* end = item + header.len;
+
+		while ((size_t)(end - pos) >= sizeof(btrfs_dir_item))
+		{
+		    btrfs_dir_item dir_item;
+		    memcpy(&dir_item, pos, sizeof(dir_item));
+		    pos += sizeof(dir_item);
+
+		    const __u16 name_len = le16toh(dir_item.name_len);
+		    const __u16 data_len = le16toh(dir_item.data_len);
+		    if ((size_t)(end - pos) < (size_t)(name_len) + data_len)
+			ST_THROW(Exception("dir item too short"));
+
+		    if (string(pos, name_len) == "default")
+			return le64toh(dir_item.location.objectid);
+
+		    pos += name_len + data_len;
+		}
+
+		return 0;
+	    }
+
+	}
+
+
+	void
+	create_subvolume(const string& dir, const string& name)
+	{
+	    y2mil("create subvolume " << name << " in " << dir);
+
+	    struct btrfs_ioctl_vol_args args;
+	    memset(&args, 0, sizeof(args));
+
+	    if (name.empty() || name.size() > BTRFS_PATH_NAME_MAX || name.find('/') != string::npos)
+		ST_THROW(Exception("invalid subvolume name " + name));
+
+	    name.copy(args.name, name.size());
+
+	    DirFd dir_fd(dir);
+
+	    if (ioctl(dir_fd.get(), BTRFS_IOC_SUBVOL_CREATE, &args) != 0)
+		ST_THROW(Exception(Exception::strErrno(errno, "creating subvolume " + name + " in " +
+						       dir + " failed")));
+	}
+
+
+	unsigned long long
+	get_subvolume_id(const string& path)
+	{
+	    // With treeid 0 the lookup is done in the subvolume of the file
+	    // descriptor and the id of that subvolume is returned in treeid.
+
+	    struct btrfs_ioctl_ino_lookup_args args;
+	    memset(&args, 0, sizeof(args));
+	    args.treeid = 0;
+	    args.objectid = first_free_objectid;
+
+	    DirFd dir_fd(path);
+
+	    if (ioctl(dir_fd.get(), BTRFS_IOC_INO_LOOKUP, &args) != 0)
+		ST_THROW(Exception(Exception::strErrno(errno, "lookup of subvolume id of " + path +
+						       " failed")));
+
+	    y2mil("subvolume id of " << path << " is " << args.treeid);
+
+	    return args.treeid;
+	}
+
+
+	bool
+	is_nocow(const string& path)
+	{
+	    DirFd dir_fd(path);
+
+	    int flags = 0;
+	    if (ioctl(dir_fd.get(), FS_IOC_GETFLAGS, &flags) != 0)
+		ST_THROW(Exception(Exception::strErrno(errno, "getting flags of " + path + " failed")));
+
+	    return flags & FS_NOCOW_FL;
+	}
+
+
+	void
+	set_nocow(const string& path, bool nocow)
+	{
+	    y2mil("set nocow of " << path << " to " << nocow);
+
+	    DirFd dir_fd(path);
+
+	    int flags = 0;
+	    if (ioctl(dir_fd.get(), FS_IOC_GETFLAGS, &flags) != 0)
+		ST_THROW(Exception(Exception::strErrno(errno, "getting flags of " + path + " failed")));
+
+	    const int new_flags = nocow ? (flags | FS_NOCOW_FL) : (flags & ~FS_NOCOW_FL);
+	    if (new_flags == flags)
+		return;
+
+	    if (ioctl(dir_fd.get(), FS_IOC_SETFLAGS, &new_flags) != 0)
+		ST_THROW(Exception(Exception::strErrno(errno, "setting flags of " + path + " failed")));
+	}
+
+
+	Subvolumes
+	get_subvolumes(const string& mount_point)
+	{
+	    DirFd dir_fd(mount_point);
+
+	    Subvolumes subvolumes;
+	    subvolumes.default_id = BTRFS_FS_TREE_OBJECTID;
+
+	    std::map<__u64, RootInfo> root_infos;
+
+	    // The root tree contains the root items and backrefs of all
+	    // subvolumes as well as the dir item for the default subvolume.
+	    // Other objects in that range, e.g. free space cache inodes, are
+	    // skipped.
+
+	    search_tree(dir_fd.get(), BTRFS_ROOT_TREE_OBJECTID, BTRFS_FS_TREE_OBJECTID,
+			BTRFS_LAST_FREE_OBJECTID, BTRFS_DIR_ITEM_KEY, BTRFS_ROOT_BACKREF_KEY,
+			[&subvolumes, &root_infos](const btrfs_ioctl_search_header& header, const char* item) {
+
+		if (header.objectid == BTRFS_FS_TREE_OBJECTID && header.type == BTRFS_ROOT_ITEM_KEY)
+		{
+		    RootInfo root_info;
+		    parse_root_item(header, item, root_info);
+		    subvolumes.top_level_uuid = root_info.uuid;
+		}
+		else if (header.objectid == BTRFS_ROOT_TREE_DIR_OBJECTID && header.type == BTRFS_DIR_ITEM_KEY)
+		{
+		    __u64 id = parse_default_dir_item(header, item);
+		    if (id != 0)
+			subvolumes.default_id = id;
+		}
+		else if (header.objectid >= first_free_objectid && header.type == BTRFS_ROOT_ITEM_KEY)
+		{
+		    parse_root_item(header, item, root_infos[header.objectid]);
+		}
+		else if (header.objectid >= first_free_objectid && header.type == BTRFS_ROOT_BACKREF_KEY)
+		{
+		    parse_root_backref(header, item, root_infos[header.objectid]);
+		}
+	    });
+
+	    // The backref only contains the directory within the parent
+	    // subvolume. So the path must be assembled from the paths of all
+	    // ancestors. Deleted subvolumes have no backref.
+
+	    std::map<__u64, string> paths;
+	    paths[BTRFS_FS_TREE_OBJECTID] = "";
+
+	    for (const std::map<__u64, RootInfo>::value_type& value : root_infos)
+	    {
+		if (!value.second.has_ref)
+		    continue;
+
+		vector<__u64> chain;
+
+		for (__u64 id = value.first; paths.find(id) == paths.end(); )
+		{
+		    std::map<__u64, RootInfo>::const_iterator it = root_infos.find(id);
+		    if (it == root_infos.end() || !it->second.has_ref || chain.size() > root_infos.size())
+			ST_THROW(Exception("parent of subvolume " + std::to_string(value.first) + " not found"));
+
+		    chain.push_back(id);
+		    id = it->second.parent_id;
+		}
+
+		for (vector<__u64>::const_reverse_iterator it = chain.rbegin(); it != chain.rend(); ++it)
+		{
+		    const RootInfo& root_info = root_infos[*it];
+
+		    const string& parent_path = paths[root_info.parent_id];
+
+		    paths[*it] = (parent_path.empty() ? "" : parent_path + "/") +
+			lookup_directory(dir_fd.get(), root_info.parent_id, root_info.dirid) +
+			root_info.name;
+		}
+
+		Subvolume subvolume;
+		subvolume.id = value.first;
+		subvolume.parent_id = value.second.parent_id;
+		subvolume.path = paths[value.first];
+		subvolume.uuid = value.second.uuid;
+		subvolume.parent_uuid = value.second.parent_uuid;
+
+		subvolumes.subvolumes.push_back(subvolume);
+	    }
+
+	    y2mil("found " << subvolumes.subvolumes.size() << " subvolumes on " << mount_point <<
+		  ", default id " << subvolumes.default_id);
+
+	    return subvolumes;
+	}
+
+    }
+
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2026 SUSE LLC
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+
+#ifndef STORAGE_BTRFS_IOCTL_H
+#define STORAGE_BTRFS_IOCTL_H
+
+
+#include <string>
+#include <vector>
+
+
+namespace storage
+{
+    using std::string;
+    using std::vector;
+
+
+    /**
+     * Functions to operate on a mounted btrfs using the ioctls directly
+     * instead of running the btrfs and chattr commands. All functions throw
+     * an Exception if the operation fails.
+     */
+    namespace BtrfsIoctl
+    {
+
+	/**
+	 * Creates a subvolume with the given name in the directory dir. The
+	 * directory must be on a mounted btrfs.
+	 */
+	void create_subvolume(const string& dir, const string& name);
+
+	/**
+	 * Returns the id of the subvolume at path.
+	 */
+	unsigned long long get_subvolume_id(const string& path);
+
+	/**
+	 * Returns whether the nocow attribute is set for path.
+	 */
+	bool is_nocow(const string& path);
+
+	/**
+	 * Sets or clears the nocow attribute for path.
+	 */
+	void set_nocow(const string& path, bool nocow);
+
+	/**
+	 * A subvolume as found in the root tree. The path is relative to the
+	 * top-level subvolume. UUIDs are empty if not available.
+	 */
+	struct Subvolume
+	{
+	    unsigned long long id = 0;
+	    unsigned long long parent_id = 0;
+	    string path;
+	    string uuid;
+	    string parent_uuid;
+	};
+
+	/**
+	 * Information about all subvolumes of a btrfs.
+	 */
+	struct Subvolumes
+	{
+	    string top_level_uuid;
+	    unsigned long long default_id = 0;
+
+	    /**
+	     * All subvolumes except the top-level and deleted subvolumes,
+	     * sorted by id.
+	     */
+	    vector<Subvolume> subvolumes;
+	};
+
+	/**
+	 * Reads the subvolumes, the UUID of the top-level subvolume and the
+	 * default subvolume from the root tree of the btrfs mounted at
+	 * mount_point. Provides the same information as 'btrfs subvolume
+	 * list', 'btrfs subvolume show' and 'btrfs subvolume get-default'.
+	 */
+	Subvolumes get_subvolumes(const string& mount_point);
+
+    }
+
+}
+
+
+#endif
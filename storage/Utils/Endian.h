@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2026 SUSE LLC
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+
+#ifndef STORAGE_ENDIAN_H
+#define STORAGE_ENDIAN_H
+
+
+#include <stdint.h>
+
+
+namespace storage
+{
+
+    /**
+     * Functions to get integers stored in little or big endian byte order,
+     * e.g. in on-disk structures. The pointers need no alignment.
+     */
+
+    inline uint16_t
+    get_le16(const uint8_t* p)
+    {
+	return p[0] | p[1] << 8;
+    }
+
+
+    inline uint32_t
+    get_le32(const uint8_t* p)
+    {
+	return (uint32_t)(p[0]) | (uint32_t)(p[1]) << 8 | (uint32_t)(p[2]) << 16 |
+	    (uint32_t)(p[3]) << 24;
+    }
+
+
+    inline uint64_t
+    get_le64(const uint8_t* p)
+    {
+	return (uint64_t)(get_le32(p)) | (uint64_t)(get_le32(p + 4)) << 32;
+    }
+
+
+    inline uint16_t
+    get_be16(const uint8_t* p)
+    {
+	return p[0] << 8 | p[1];
+    }
+
+
+    inline uint32_t
+    get_be32(const uint8_t* p)
+    {
+	return (uint32_t)(p[0]) << 24 | (uint32_t)(p[1]) << 16 | (uint32_t)(p[2]) << 8 |
+	    (uint32_t)(p[3]);
+    }
+
+
+    inline uint64_t
+    get_be64(const uint8_t* p)
+    {
+	return (uint64_t)(get_be32(p)) << 32 | (uint64_t)(get_be32(p + 4));
+    }
+
+}
+
+
+#endif
@@ -129,6 +129,8 @@ namespace storage
 		  location.line(),
 		  location.func().c_str(),
 		  prefix << " " << exception.asString() );
+
+	flush_logger();
     }
 
 }
@@ -25,13 +25,14 @@
 
 
 #include <vector>
-#include <map>
+#include <boost/graph/properties.hpp>
+#include <boost/graph/depth_first_search.hpp>
+#include <boost/graph/breadth_first_search.hpp>
 
 
 namespace storage
 {
     using std::vector;
-    using std::map;
 
 
     class CycleDetector : public boost::default_dfs_visitor
@@ -75,42 +76,52 @@ namespace storage
 
 
     /*
-     * Generates a vertex index (0 <= index < number of vertices) map.
+     * Maintains a dense vertex index (0 <= index < number of vertices) in the
+     * interior vertex_index property of a graph.
      *
      * With VertexList=listS the adjacency_list does not automatically have a
      * vertex_index property.  Since some algorithm we use need that property
-     * we have to create it ourself.  See:
+     * the graph must have it as interior property and all functions adding or
+     * removing vertices must call add() respectively remove(). When a vertex
+     * is removed the vertex with the highest index takes over its index. See:
      * http://www.boost.org/doc/libs/1_56_0/libs/graph/doc/faq.html
+     *
+     * Algorithms then use the vertex_index property by default and thus flat
+     * vectors for e.g. the color map. This also works for filtered and
+     * reversed graphs.
      */
     template <typename Graph>
-    class VertexIndexMapGenerator
+    class DenseVertexIndex
     {
     public:
 
-	typedef map<typename Graph::vertex_descriptor, typename Graph::vertices_size_type> vertex_index_map_t;
+	typedef typename Graph::vertex_descriptor vertex_descriptor;
 
-	VertexIndexMapGenerator(const Graph& graph)
-	    : graph(graph), vertex_index_property_map(vertex_index_map)
+	void add(Graph& graph, vertex_descriptor vertex)
 	{
-	    typename Graph::vertices_size_type cnt = 0;
-
-	    typename Graph::vertex_iterator vi, vi_end;
-	    for (boost::tie(vi, vi_end) = boost::vertices(graph); vi != vi_end; ++vi)
-		boost::put(vertex_index_property_map, *vi, cnt++);
+	    boost::put(boost::vertex_index, graph, vertex, vertices.size());
+	    vertices.push_back(vertex);
 	}
 
-	const boost::associative_property_map<vertex_index_map_t>& get() const
+	void remove(Graph& graph, vertex_descriptor vertex)
 	{
-	    return vertex_index_property_map;
-	}
+	    const size_t index = boost::get(boost::vertex_index, graph, vertex);
 
-    private:
+	    const vertex_descriptor last = vertices.back();
+	    vertices[index] = last;
+	    boost::put(boost::vertex_index, graph, last, index);
 
-	const Graph& graph;
+	    vertices.pop_back();
+	}
+
+	void clear() { vertices.clear(); }
 
-	vertex_index_map_t vertex_index_map;
+    private:
 
-	boost::associative_property_map<vertex_index_map_t> vertex_index_property_map;
+	/**
+	 * The vertices by index.
+	 */
+	vector<vertex_descriptor> vertices;
 
     };
 
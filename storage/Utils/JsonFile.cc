@@ -83,6 +83,26 @@ namespace storage
     }
 
 
+    JsonFile::JsonFile(string_view data)
+    {
+	JsonTokener tokener;
+
+	root = json_tokener_parse_ex(tokener.get(), data.data(), data.size());
+
+	switch (json_tokener_error jerr = json_tokener_get_error(tokener.get()))
+	{
+	    case json_tokener_success:
+		return;
+
+	    case json_tokener_continue:
+		ST_THROW(Exception(sformat("json parser failed: runaway")));
+
+	    default:
+		ST_THROW(Exception(sformat("json parser failed: %s", json_tokener_error_desc(jerr))));
+	}
+    }
+
+
     JsonFile::JsonFile(const string& filename)
     {
 	FILE* fp = fopen(filename.c_str(), "r");
@@ -26,6 +26,7 @@
 
 #include <json-c/json.h>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <boost/noncopyable.hpp>
 
@@ -49,6 +50,12 @@ namespace storage
 
 	JsonFile(const vector<string>& lines);
 
+	/**
+	 * Parses the json data in one pass without copying it, e.g. the
+	 * contiguous stdout of a SystemCmd.
+	 */
+	JsonFile(string_view data);
+
 	JsonFile(const string& filename);
 
 	~JsonFile();
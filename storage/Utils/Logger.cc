@@ -26,8 +26,13 @@
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <errno.h>
 
 #include <iostream>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
 
 #include "storage/Utils/Logger.h"
 #include "storage/Utils/AppUtil.h"
@@ -152,6 +157,221 @@ namespace storage
     }
 
 
+    class BufferedLogfileLogger : public Logger
+    {
+
+    public:
+
+	BufferedLogfileLogger(const string& filename, int permissions = DEFAULT_PERMISSIONS);
+	virtual ~BufferedLogfileLogger();
+
+	virtual void write(LogLevel log_level, const string& component, const string& file,
+			   int line, const string& function, const string& content) override;
+
+	/**
+	 * Writes the buffered log lines to the file.
+	 */
+	void flush();
+
+    private:
+
+	// log file should not be world-readable
+	static const int DEFAULT_PERMISSIONS = 0640;
+
+	// size of the buffer that triggers writing by the background thread
+	static constexpr size_t FLUSH_SIZE = 64 * 1024;
+
+	// interval for writing by the background thread
+	static constexpr int FLUSH_INTERVAL = 1;
+
+	void run();
+
+	void write_to_file(const string& data);
+
+	const string filename;
+	const int permissions;
+
+	// protects buffer, stop and the cached datetime
+	std::mutex buffer_mutex;
+	std::condition_variable buffer_cv;
+	string buffer;
+	bool stop = false;
+
+	time_t last_time = 0;
+	string last_datetime;
+
+	// serialises writing so that batches are written in order, also
+	// protects fd
+	std::mutex file_mutex;
+	int fd = -1;
+
+	std::thread thread;
+
+    };
+
+
+    BufferedLogfileLogger::BufferedLogfileLogger(const string& filename, int permissions)
+	: filename(filename), permissions(permissions)
+    {
+	thread = std::thread(&BufferedLogfileLogger::run, this);
+    }
+
+
+    BufferedLogfileLogger::~BufferedLogfileLogger()
+    {
+	if (get_logger() == this)
+	    set_logger(nullptr);
+
+	{
+	    std::lock_guard<std::mutex> lock(buffer_mutex);
+	    stop = true;
+	}
+
+	buffer_cv.notify_one();
+	thread.join();
+
+	flush();
+
+	if (fd >= 0)
+	    close(fd);
+    }
+
+
+    void
+    BufferedLogfileLogger::write(LogLevel log_level, const string& component, const string& file,
+				 int line, const string& function, const string& content)
+    {
+	const time_t now = time(nullptr);
+
+	bool notify = false;
+
+	{
+	    std::lock_guard<std::mutex> lock(buffer_mutex);
+
+	    if (now != last_time)
+	    {
+		last_time = now;
+		last_datetime = datetime(now);
+	    }
+
+	    buffer += last_datetime;
+	    buffer += " <";
+	    buffer += std::to_string(static_cast<log_level_underlying_type>(log_level));
+	    buffer += "> [";
+	    buffer += component;
+	    buffer += "] ";
+	    buffer += file;
+	    buffer += "(";
+	    buffer += function;
+	    buffer += "):";
+	    buffer += std::to_string(line);
+	    buffer += " ";
+	    buffer += content;
+	    buffer += "\n";
+
+	    notify = buffer.size() >= FLUSH_SIZE;
+	}
+
+	if (notify)
+	    buffer_cv.notify_one();
+    }
+
+
+    void
+    BufferedLogfileLogger::flush()
+    {
+	std::lock_guard<std::mutex> file_lock(file_mutex);
+
+	string data;
+
+	{
+	    std::lock_guard<std::mutex> buffer_lock(buffer_mutex);
+	    data.swap(buffer);
+	}
+
+	if (!data.empty())
+	    write_to_file(data);
+    }
+
+
+    void
+    BufferedLogfileLogger::run()
+    {
+	while (true)
+	{
+	    {
+		std::unique_lock<std::mutex> lock(buffer_mutex);
+
+		buffer_cv.wait_for(lock, std::chrono::seconds(FLUSH_INTERVAL), [this]() {
+		    return stop || buffer.size() >= FLUSH_SIZE;
+		});
+
+		if (stop)
+		    return;
+	    }
+
+	    flush();
+	}
+    }
+
+
+    void
+    BufferedLogfileLogger::write_to_file(const string& data)
+    {
+	// Reopen the file if it was removed, e.g. by logrotate.
+
+	struct stat st;
+	if (fd >= 0 && (fstat(fd, &st) != 0 || st.st_nlink == 0))
+	{
+	    close(fd);
+	    fd = -1;
+	}
+
+	if (fd < 0)
+	{
+	    fd = open(filename.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, permissions);
+	    if (fd < 0)
+		return;
+	}
+
+	const char* pos = data.data();
+	size_t remaining = data.size();
+
+	while (remaining > 0)
+	{
+	    ssize_t ret = ::write(fd, pos, remaining);
+	    if (ret < 0)
+	    {
+		if (errno == EINTR)
+		    continue;
+
+		return;
+	    }
+
+	    pos += ret;
+	    remaining -= ret;
+	}
+    }
+
+
+    Logger*
+    get_buffered_logfile_logger(const string& filename)
+    {
+	static BufferedLogfileLogger buffered_logfile_logger(filename);
+
+	return &buffered_logfile_logger;
+    }
+
+
+    void
+    flush_logger()
+    {
+	BufferedLogfileLogger* buffered_logfile_logger = dynamic_cast<BufferedLogfileLogger*>(get_logger());
+	if (buffered_logfile_logger)
+	    buffered_logfile_logger->flush();
+    }
+
+
     Silencer::Silencer()
 	: active(false)
     {
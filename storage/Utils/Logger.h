@@ -93,6 +93,28 @@ namespace storage
     Logger* get_logfile_logger(const std::string& filename = "/var/log/libstorage.log");
 
 
+    /**
+     * Returns a Logger that logs to the standard libstorage log file
+     * ("/var/log/libstorage.log") or to a given file. Unlike the Logger from
+     * get_logfile_logger() the file is kept open and the log lines are
+     * buffered and written in batches by a background thread. The buffer
+     * is also written when an exception is thrown, at the end of probing
+     * and committing and by flush_logger().
+     *
+     * Note that this method only uses the given filename the first time
+     * it is called.
+     */
+    Logger* get_buffered_logfile_logger(const std::string& filename = "/var/log/libstorage.log");
+
+
+    /**
+     * Writes the log lines buffered by the Logger from
+     * get_buffered_logfile_logger() if that is the current logger object.
+     * Does nothing otherwise.
+     */
+    void flush_logger();
+
+
     /**
      * Class to make some exceptions log-level DEBUG instead of WARNING.
      */
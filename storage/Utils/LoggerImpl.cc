@@ -21,6 +21,9 @@
  */
 
 
+#include <mutex>
+#include <memory>
+
 #include "storage/Utils/LoggerImpl.h"
 
 
@@ -32,13 +35,21 @@ namespace storage
     static const string& component = "libstorage";
 
 
+    // Loggers are not required to be thread-safe but logging can happen from
+    // several threads during probing.
+    static mutex logger_mutex;
+
+
     bool
     query_log_level(LogLevel log_level)
     {
 	Logger* logger = get_logger();
 
 	if (logger)
+	{
+	    lock_guard<mutex> lock(logger_mutex);
 	    return logger->test(log_level, component);
+	}
 
 	return false;
     }
@@ -47,20 +58,38 @@ namespace storage
     namespace
     {
 
+	void
+	reset_log_stream(ostringstream& stream)
+	{
+	    stream.flags(std::ios::dec | std::ios::skipws | std::ios::boolalpha | std::ios::showbase);
+	    stream.precision(6);
+	    stream.width(0);
+	    stream.fill(' ');
+	}
+
+
 	void
 	prepare_log_stream(ostringstream& stream)
 	{
 	    stream.imbue(std::locale::classic());
-	    stream.setf(std::ios::boolalpha);
-	    stream.setf(std::ios::showbase);
+	    reset_log_stream(stream);
 	}
 
+
+	// Constructing and imbuing a stream for every log line is expensive so
+	// each thread keeps one stream for reuse. Nested logging, e.g. from
+	// an output operator, gets a new stream.
+	thread_local unique_ptr<ostringstream> cached_log_stream;
+
     }
 
 
     ostringstream*
     open_log_stream()
     {
+	if (cached_log_stream)
+	    return cached_log_stream.release();
+
 	std::ostringstream* stream = new ostringstream;
 	prepare_log_stream(*stream);
 	return stream;
@@ -78,19 +107,39 @@ namespace storage
 
 	const string content = stream->str();
 
-	string::size_type pos1 = 0;
-	while (true)
 	{
-	    string::size_type pos2 = content.find('\n', pos1);
-	    if (pos1 == 0 || pos2 != string::npos || pos1 != content.length())
-		logger->write(log_level, component, file, line, func,
-			      content.substr(pos1, pos2 - pos1));
-	    if (pos2 == string::npos)
-		break;
-	    pos1 = pos2 + 1;
+	    lock_guard<mutex> lock(logger_mutex);
+
+	    if (content.find('\n') == string::npos)
+	    {
+		logger->write(log_level, component, file, line, func, content);
+	    }
+	    else
+	    {
+		string::size_type pos1 = 0;
+		while (true)
+		{
+		    string::size_type pos2 = content.find('\n', pos1);
+		    if (pos1 == 0 || pos2 != string::npos || pos1 != content.length())
+			logger->write(log_level, component, file, line, func,
+				      content.substr(pos1, pos2 - pos1));
+		    if (pos2 == string::npos)
+			break;
+		    pos1 = pos2 + 1;
+		}
+	    }
+	}
+
+	if (cached_log_stream)
+	{
+	    delete stream;
+	    return;
 	}
 
-	delete stream;
+	stream->str(string());
+	stream->clear();
+	reset_log_stream(*stream);
+	cached_log_stream.reset(stream);
     }
 
 }
@@ -173,6 +173,8 @@ namespace storage
     bool
     Mockup::has_command(const string& name)
     {
+	std::lock_guard<std::mutex> lock(mutex);
+
 	return commands.find(name) != commands.end();
     }
 
@@ -180,6 +182,8 @@ namespace storage
     const Mockup::Command&
     Mockup::get_command(const string& name)
     {
+	std::lock_guard<std::mutex> lock(mutex);
+
 	map<string, Command>::const_iterator it = commands.find(name);
 	if (it == commands.end())
 	    ST_THROW(Exception("no mockup found for command '" + name + "'"));
@@ -195,6 +199,8 @@ namespace storage
     void
     Mockup::set_command(const string& name, const Command& command)
     {
+	std::lock_guard<std::mutex> lock(mutex);
+
 	commands[name] = command;
     }
 
@@ -202,6 +208,8 @@ namespace storage
     void
     Mockup::set_command(const vector<string>& name, const Command& command)
     {
+	std::lock_guard<std::mutex> lock(mutex);
+
 	commands[boost::join(name, " ")] = command;
     }
 
@@ -209,6 +217,8 @@ namespace storage
     void
     Mockup::erase_command(const string& name)
     {
+	std::lock_guard<std::mutex> lock(mutex);
+
 	commands.erase(name);
     }
 
@@ -216,6 +226,8 @@ namespace storage
     bool
     Mockup::has_file(const string& name)
     {
+	std::lock_guard<std::mutex> lock(mutex);
+
 	return files.find(name) != files.end();
     }
 
@@ -223,6 +235,8 @@ namespace storage
     const Mockup::File&
     Mockup::get_file(const string& name)
     {
+	std::lock_guard<std::mutex> lock(mutex);
+
 	map<string, File>::const_iterator it = files.find(name);
 	if (it == files.end())
 	    ST_THROW(Exception("no mockup found for file '" + name + "'"));
@@ -238,6 +252,8 @@ namespace storage
     void
     Mockup::set_file(const string& name, const File& file)
     {
+	std::lock_guard<std::mutex> lock(mutex);
+
 	files[name] = file;
     }
 
@@ -245,6 +261,8 @@ namespace storage
     void
     Mockup::erase_file(const string& name)
     {
+	std::lock_guard<std::mutex> lock(mutex);
+
 	files.erase(name);
     }
 
@@ -286,6 +304,8 @@ namespace storage
     map<string, Mockup::Command> Mockup::commands;
     map<string, Mockup::File> Mockup::files;
 
+    std::mutex Mockup::mutex;
+
 #ifdef OCCAMS_RAZOR
     set<string> Mockup::used_commands;
     set<string> Mockup::used_files;
@@ -29,6 +29,7 @@
 #include <vector>
 #include <map>
 #include <set>
+#include <mutex>
 
 #include "storage/Utils/Remote.h"
 
@@ -91,6 +92,10 @@ namespace storage
 	static map<string, Command> commands;
 	static map<string, File> files;
 
+	// Protects commands, files and the used sets since commands may be run
+	// in parallel during probing.
+	static std::mutex mutex;
+
 #ifdef OCCAMS_RAZOR
 	const static size_t threshold = 4;
 
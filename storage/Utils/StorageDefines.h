@@ -95,6 +95,7 @@
 #define VGS_BIN "/sbin/vgs"
 #define VGCHANGE_BIN "/sbin/vgchange"
 
+#define LVM_BIN "/sbin/lvm"
 #define LVMDEVICES_BIN "/usr/sbin/lvmdevices"
 
 #define CRYPTSETUP_BIN "/sbin/cryptsetup"
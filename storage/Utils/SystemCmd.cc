@@ -27,9 +27,11 @@
 #include <fcntl.h>
 #include <poll.h>
 #include <langinfo.h>
+#include <spawn.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <sstream>
+#include <mutex>
 #include <boost/algorithm/string.hpp>
 
 #include "storage/Utils/ExceptionImpl.h"
@@ -40,6 +42,7 @@
 #include "storage/Utils/StorageDefines.h"
 #include "storage/Utils/AppUtil.h"
 #include "storage/Utils/StorageTmpl.h"
+#include "storage/EnvironmentImpl.h"
 
 
 #define SYSCALL_FAILED(SYSCALL_MSG) \
@@ -53,6 +56,13 @@
 #define SHELL_RET_SIGNAL			128
 
 
+// posix_spawn_file_actions_addclosefrom_np is needed to close all file descriptors in
+// the child
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 34)
+#define HAVE_POSIX_SPAWN_CLOSEFROM 1
+#endif
+
+
 namespace storage
 {
     using namespace std;
@@ -114,17 +124,76 @@ namespace storage
     }
 
 
+    namespace
+    {
+
+	/**
+	 * The default environment for the child processes is only prepared again if the
+	 * environment of the process changed. setenv(3) and putenv(3) replace the
+	 * pointers in environ so comparing the pointers is enough.
+	 */
+	struct DefaultEnvs
+	{
+	    std::mutex mutex;
+
+	    vector<const char*> snapshot;
+	    bool utf8 = false;
+
+	    vector<string> envs;
+
+	    bool is_valid(bool utf8) const;
+	};
+
+
+	bool
+	DefaultEnvs::is_valid(bool utf8) const
+	{
+	    if (snapshot.empty() || utf8 != DefaultEnvs::utf8)
+		return false;
+
+	    size_t i = 0;
+
+	    for (char** v = environ; *v != NULL; ++v, ++i)
+	    {
+		if (i == snapshot.size() || snapshot[i] != *v)
+		    return false;
+	    }
+
+	    return i == snapshot.size();
+	}
+
+
+	DefaultEnvs default_envs;
+
+    }
+
+
     void
     SystemCmd::Options::init_envs()
     {
+	const bool utf8 = strcmp(nl_langinfo(CODESET), "UTF-8") == 0;
+
+	std::lock_guard<std::mutex> lock(default_envs.mutex);
+
+	if (default_envs.is_valid(utf8))
+	{
+	    envs = default_envs.envs;
+	    return;
+	}
+
+	default_envs.snapshot.clear();
+
 	for (char** v = environ; *v != NULL; ++v)
+	{
+	    default_envs.snapshot.push_back(*v);
 	    envs.push_back(*v);
+	}
 
 	// parted needs UTF-8 to decode partition names with non-ASCII characters. Might
 	// be the case for other programs as well. Running in non-UTF-8 is not really
 	// supported.
 
-	if (strcmp(nl_langinfo(CODESET), "UTF-8") == 0)
+	if (utf8)
 	{
 	    setenv("LC_ALL", "C.UTF-8");
 	    setenv("LANGUAGE", "C.UTF-8");
@@ -134,6 +203,9 @@ namespace storage
 	    setenv("LC_ALL", "C");
 	    setenv("LANGUAGE", "C");
 	}
+
+	default_envs.utf8 = utf8;
+	default_envs.envs = envs;
     }
 
 
@@ -161,6 +233,9 @@ namespace storage
 	    if (!stdout().empty())
 		s += "stdout:\n" + boost::join(stdout(), "\n") + "\n\n";
 
+	    if (!stdout_buffer().empty())
+		s += "stdout:\n" + stdout_buffer() + "\n";
+
 	    if (!stderr().empty())
 		s += "stderr:\n" + boost::join(stderr(), "\n") + "\n\n";
 
@@ -217,7 +292,7 @@ namespace storage
 	if (Mockup::get_mode() == Mockup::Mode::PLAYBACK)
 	{
 	    const Mockup::Command mockup_command = Mockup::get_command(mockup_key());
-	    stdout_lines = mockup_command.stdout;
+	    set_stdout(mockup_command.stdout);
 	    stderr_lines = mockup_command.stderr;
 	    child_retcode = mockup_command.exit_code;
 
@@ -234,7 +309,7 @@ namespace storage
 	    if (args().empty())
 	    {
 		const RemoteCommand remote_command = remote_callbacks->get_command(command());
-		stdout_lines = remote_command.stdout;
+		set_stdout(remote_command.stdout);
 		stderr_lines = remote_command.stderr;
 		child_retcode = remote_command.exit_code;
 	    }
@@ -245,7 +320,7 @@ namespace storage
 		    ST_THROW(Exception("old RemoteCallback"));
 
 		const RemoteCommand remote_command = remote_callbacks_v2->get_command_v2(args());
-		stdout_lines = remote_command.stdout;
+		set_stdout(remote_command.stdout);
 		stderr_lines = remote_command.stderr;
 		child_retcode = remote_command.exit_code;
 	    }
@@ -257,7 +332,67 @@ namespace storage
 
 	if (Mockup::get_mode() == Mockup::Mode::RECORD)
 	{
-	    Mockup::set_command(mockup_key(), Mockup::Command(stdout(), stderr(), retcode()));
+	    if (options.contiguous_stdout)
+	    {
+		const vector<string> lines(stdout_views.begin(), stdout_views.end());
+		Mockup::set_command(mockup_key(), Mockup::Command(lines, stderr(), retcode()));
+	    }
+	    else
+	    {
+		Mockup::set_command(mockup_key(), Mockup::Command(stdout(), stderr(), retcode()));
+	    }
+	}
+    }
+
+
+    void
+    SystemCmd::set_stdout(const vector<string>& lines)
+    {
+	if (!options.contiguous_stdout)
+	{
+	    stdout_lines = lines;
+	    return;
+	}
+
+	string::size_type size = 0;
+	for (const string& line : lines)
+	    size += line.size() + 1;
+
+	stdout_data.reserve(size);
+	for (const string& line : lines)
+	{
+	    stdout_data += line;
+	    stdout_data += '\n';
+	}
+
+	split_stdout_data();
+    }
+
+
+    void
+    SystemCmd::split_stdout_data()
+    {
+	stdout_views.clear();
+
+	const string_view data(stdout_data);
+
+	string_view::size_type start = 0;
+	while (start < data.size())
+	{
+	    string_view::size_type pos = data.find('\n', start);
+	    if (pos == string_view::npos)
+		pos = data.size();
+
+	    const string_view line = data.substr(start, pos - start);
+
+	    if (stdout_views.size() < options.log_line_limit)
+		y2mil("line stdout[" << stdout_views.size() << "] '" << line << "'");
+	    else
+		y2deb("line stdout[" << stdout_views.size() << "] '" << line << "'");
+
+	    stdout_views.push_back(line);
+
+	    start = pos + 1;
 	}
     }
 
@@ -341,6 +476,17 @@ namespace storage
 	    int fork();
 	    int waitpid(int* wstatus);
 
+#ifdef HAVE_POSIX_SPAWN_CLOSEFROM
+
+	    /**
+	     * Spawns the child with posix_spawnp(3) or posix_spawn(3). Returns the
+	     * error number, e.g. of a failed exec.
+	     */
+	    int spawn(bool search, const char* file, const posix_spawn_file_actions_t* file_actions,
+		      const char* const* argv, const char* const* envp);
+
+#endif
+
 	private:
 
 	    int pid = -1;
@@ -356,6 +502,29 @@ namespace storage
 	}
 
 
+#ifdef HAVE_POSIX_SPAWN_CLOSEFROM
+
+	int
+	Child::spawn(bool search, const char* file, const posix_spawn_file_actions_t* file_actions,
+		     const char* const* argv, const char* const* envp)
+	{
+	    // The const_casts below should be fine for the same reason as for the exec
+	    // functions.
+
+	    pid_t tmp;
+
+	    int ret = (search ? posix_spawnp : ::posix_spawn)(&tmp, file, file_actions, nullptr,
+							      const_cast<char* const *>(argv),
+							      const_cast<char* const *>(envp));
+	    if (ret == 0)
+		pid = tmp;
+
+	    return ret;
+	}
+
+#endif
+
+
 	int
 	Child::waitpid(int* wstatus)
 	{
@@ -370,6 +539,53 @@ namespace storage
 	    return ret;
 	}
 
+
+#ifdef HAVE_POSIX_SPAWN_CLOSEFROM
+
+	/**
+	 * RAII for posix_spawn_file_actions_t.
+	 */
+	class SpawnFileActions : boost::noncopyable
+	{
+	public:
+
+	    SpawnFileActions()
+	    {
+		if (posix_spawn_file_actions_init(&file_actions) != 0)
+		    ST_THROW(Exception("posix_spawn_file_actions_init failed"));
+	    }
+
+	    ~SpawnFileActions() { posix_spawn_file_actions_destroy(&file_actions); }
+
+	    const posix_spawn_file_actions_t* get() const { return &file_actions; }
+
+	    void add_dup2(int fd, int new_fd);
+	    void add_closefrom(int from);
+
+	private:
+
+	    posix_spawn_file_actions_t file_actions;
+
+	};
+
+
+	void
+	SpawnFileActions::add_dup2(int fd, int new_fd)
+	{
+	    if (posix_spawn_file_actions_adddup2(&file_actions, fd, new_fd) != 0)
+		ST_THROW(Exception("posix_spawn_file_actions_adddup2 failed"));
+	}
+
+
+	void
+	SpawnFileActions::add_closefrom(int from)
+	{
+	    if (posix_spawn_file_actions_addclosefrom_np(&file_actions, from) != 0)
+		ST_THROW(Exception("posix_spawn_file_actions_addclosefrom_np failed"));
+	}
+
+#endif
+
     }
 
 
@@ -390,11 +606,29 @@ namespace storage
 	void step_poll();
 	void step_wait();
 
+#ifdef HAVE_POSIX_SPAWN_CLOSEFROM
+
+	/**
+	 * Alternative to step_fork_and_exec() using posix_spawn. Avoids copying
+	 * the page tables of the process. Returns false if the exec failed, in
+	 * that case the exit code is already set like the child of
+	 * step_fork_and_exec() would do.
+	 */
+	bool step_spawn();
+
+#endif
+
+	void set_nonblocking();
+	void close_child_ends();
+
+	void handle_exit_code(int exit_code);
+
 	void write_stdin();
 	void read_stdout();
 	void read_stderr();
 
 	void fill_buffer(const char* name, int fd, string& buffer, vector<string>& lines) const;
+	void fill_contiguous(int fd, string& data) const;
 	void split_buffer(const char* name, string& buffer, vector<string>& lines, bool finito = false) const;
 	void add_line(const char* name, const string& line, vector<string>& lines) const;
 
@@ -447,17 +681,26 @@ namespace storage
     SystemCmd::Executor::Executor(SystemCmd& system_cmd)
 	: system_cmd(system_cmd)
     {
-	step_fork_and_exec();
+#ifdef HAVE_POSIX_SPAWN_CLOSEFROM
+	if (posix_spawn_backend())
+	{
+	    if (!step_spawn())
+		return;
+	}
+	else
+#endif
+	{
+	    step_fork_and_exec();
+	}
+
 	step_poll();
 	step_wait();
     }
 
 
     void
-    SystemCmd::Executor::step_fork_and_exec()
+    SystemCmd::Executor::set_nonblocking()
     {
-	y2deb("step fork and exec");
-
 	if (fcntl(stdin_pipe.write_end.fd, F_SETFL, O_NONBLOCK) != 0)
 	    SYSCALL_FAILED("fcntl stdin O_NONBLOCK failed");
 
@@ -466,6 +709,29 @@ namespace storage
 
 	if (fcntl(stderr_pipe.read_end.fd, F_SETFL, O_NONBLOCK) != 0)
 	    SYSCALL_FAILED("fcntl stderr O_NONBLOCK failed");
+    }
+
+
+    void
+    SystemCmd::Executor::close_child_ends()
+    {
+	if (stdin_pipe.read_end.close() != 0)
+	    SYSCALL_FAILED("close stdin in parent failed");
+
+	if (stdout_pipe.write_end.close() != 0)
+	    SYSCALL_FAILED("close stdout in parent failed");
+
+	if (stderr_pipe.write_end.close() != 0)
+	    SYSCALL_FAILED("close stderr in parent failed");
+    }
+
+
+    void
+    SystemCmd::Executor::step_fork_and_exec()
+    {
+	y2deb("step fork and exec");
+
+	set_nonblocking();
 
 	Pipe child_failure_info_pipe;
 
@@ -547,14 +813,7 @@ namespace storage
 
 	y2mil("child.pid:" << child.get_pid());
 
-	if (stdin_pipe.read_end.close() != 0)
-	    SYSCALL_FAILED("close stdin in parent failed");
-
-	if (stdout_pipe.write_end.close() != 0)
-	    SYSCALL_FAILED("close stdout in parent failed");
-
-	if (stderr_pipe.write_end.close() != 0)
-	    SYSCALL_FAILED("close stderr in parent failed");
+	close_child_ends();
 
 	if (child_failure_info_pipe.write_end.close() != 0)
 	    SYSCALL_FAILED("close child_failure_info_pipe failed");
@@ -581,6 +840,81 @@ namespace storage
     }
 
 
+#ifdef HAVE_POSIX_SPAWN_CLOSEFROM
+
+    bool
+    SystemCmd::Executor::step_spawn()
+    {
+	y2deb("step spawn");
+
+	set_nonblocking();
+
+	// The pipes have O_CLOEXEC but the duplicates do not. Other file descriptors
+	// might have been opened without O_CLOEXEC (e.g. by the application), so close
+	// them explicitly.
+
+	SpawnFileActions file_actions;
+	file_actions.add_dup2(stdin_pipe.read_end.fd, STDIN_FILENO);
+	file_actions.add_dup2(stdout_pipe.write_end.fd, STDOUT_FILENO);
+	file_actions.add_dup2(stderr_pipe.write_end.fd, STDERR_FILENO);
+	file_actions.add_closefrom(3);
+
+	const vector<const char*> env_p(make_env());
+
+	int errnum;
+
+	if (system_cmd.args().empty())
+	{
+	    const char* const args_p[] = { SH_BIN, "-c", system_cmd.command().c_str(), nullptr };
+	    errnum = child.spawn(false, SH_BIN, file_actions.get(), args_p, env_p.data());
+	}
+	else
+	{
+	    const vector<const char*> args_p(make_args());
+	    errnum = child.spawn(true, args_p[0], file_actions.get(), args_p.data(), env_p.data());
+	}
+
+	// Like fork failing in step_fork_and_exec().
+
+	if (errnum == EAGAIN || errnum == ENOMEM)
+	{
+	    errno = errnum;
+	    SYSCALL_FAILED("posix_spawn failed");
+	}
+
+	close_child_ends();
+
+	if (errnum != 0)
+	{
+	    // The exec has failed (posix_spawn reports that). Set the exit code like
+	    // the child in step_fork_and_exec() does.
+
+	    y2err("exec failed: " << errnum);
+
+	    stdin_pipe.write_end.close();
+	    stdout_pipe.read_end.close();
+	    stderr_pipe.read_end.close();
+
+	    if (errnum == ENOENT)
+		handle_exit_code(SHELL_RET_COMMAND_NOT_FOUND);
+	    else if (errnum == ENOEXEC || errnum == EACCES || errnum == EISDIR)
+		handle_exit_code(SHELL_RET_COMMAND_NOT_EXECUTABLE);
+	    else
+		handle_exit_code(125);
+
+	    y2mil("child_retcode:" << system_cmd.child_retcode);
+
+	    return false;
+	}
+
+	y2mil("child.pid:" << child.get_pid());
+
+	return true;
+    }
+
+#endif
+
+
     void
     SystemCmd::Executor::step_poll()
     {
@@ -623,9 +957,18 @@ namespace storage
 	}
 
 	stdout_pipe.read_end.close();
-	split_buffer("stdout", stdout_buffer, system_cmd.stdout_lines, true);
-	if (system_cmd.stdout_lines.size() >= system_cmd.options.log_line_limit)
-	    y2mil("stdout lines:" << system_cmd.stdout_lines.size());
+	if (system_cmd.options.contiguous_stdout)
+	{
+	    system_cmd.split_stdout_data();
+	    if (system_cmd.stdout_views.size() >= system_cmd.options.log_line_limit)
+		y2mil("stdout lines:" << system_cmd.stdout_views.size());
+	}
+	else
+	{
+	    split_buffer("stdout", stdout_buffer, system_cmd.stdout_lines, true);
+	    if (system_cmd.stdout_lines.size() >= system_cmd.options.log_line_limit)
+		y2mil("stdout lines:" << system_cmd.stdout_lines.size());
+	}
 
 	stderr_pipe.read_end.close();
 	split_buffer("stderr", stderr_buffer, system_cmd.stderr_lines, true);
@@ -648,17 +991,7 @@ namespace storage
 
 	if (WIFEXITED(wstatus))
 	{
-	    system_cmd.child_retcode = WEXITSTATUS(wstatus);
-	    if (system_cmd.child_retcode == SHELL_RET_COMMAND_NOT_EXECUTABLE)
-		ST_MAYBE_THROW(SystemCmdException(&system_cmd, "Command not executable"), system_cmd.do_throw());
-	    else if (system_cmd.child_retcode == SHELL_RET_COMMAND_NOT_FOUND)
-		ST_MAYBE_THROW(CommandNotFoundException(&system_cmd), system_cmd.do_throw());
-	    else if (system_cmd.child_retcode > SHELL_RET_SIGNAL)
-	    {
-		std::stringstream msg;
-		msg << "Caught signal #" << (system_cmd.child_retcode - SHELL_RET_SIGNAL);
-		ST_MAYBE_THROW(SystemCmdException(&system_cmd, msg.str()), system_cmd.do_throw());
-	    }
+	    handle_exit_code(WEXITSTATUS(wstatus));
 	}
 	else if (WIFSIGNALED(wstatus))
 	{
@@ -677,6 +1010,24 @@ namespace storage
     }
 
 
+    void
+    SystemCmd::Executor::handle_exit_code(int exit_code)
+    {
+	system_cmd.child_retcode = exit_code;
+
+	if (exit_code == SHELL_RET_COMMAND_NOT_EXECUTABLE)
+	    ST_MAYBE_THROW(SystemCmdException(&system_cmd, "Command not executable"), system_cmd.do_throw());
+	else if (exit_code == SHELL_RET_COMMAND_NOT_FOUND)
+	    ST_MAYBE_THROW(CommandNotFoundException(&system_cmd), system_cmd.do_throw());
+	else if (exit_code > SHELL_RET_SIGNAL)
+	{
+	    std::stringstream msg;
+	    msg << "Caught signal #" << (exit_code - SHELL_RET_SIGNAL);
+	    ST_MAYBE_THROW(SystemCmdException(&system_cmd, msg.str()), system_cmd.do_throw());
+	}
+    }
+
+
     void
     SystemCmd::Executor::write_stdin()
     {
@@ -709,7 +1060,10 @@ namespace storage
     void
     SystemCmd::Executor::read_stdout()
     {
-	fill_buffer("stdout", stdout_pipe.read_end.fd, stdout_buffer, system_cmd.stdout_lines);
+	if (system_cmd.options.contiguous_stdout)
+	    fill_contiguous(stdout_pipe.read_end.fd, system_cmd.stdout_data);
+	else
+	    fill_buffer("stdout", stdout_pipe.read_end.fd, stdout_buffer, system_cmd.stdout_lines);
     }
 
 
@@ -749,6 +1103,38 @@ namespace storage
     }
 
 
+    void
+    SystemCmd::Executor::fill_contiguous(int fd, string& data) const
+    {
+	// Read directly into the growing buffer. Splitting into lines is done
+	// once at the end.
+
+	const string::size_type chunk = 64 * 1024;
+
+	while (true)
+	{
+	    const string::size_type size = data.size();
+	    data.resize(size + chunk);
+
+	    ssize_t read_ret = TEMP_FAILURE_RETRY(read(fd, &data[size], chunk));
+	    if (read_ret < 0)
+	    {
+		data.resize(size);
+
+		if (errno == EAGAIN)
+		    break;
+
+		SYSCALL_FAILED("read");
+	    }
+
+	    data.resize(size + read_ret);
+
+	    if ((size_t)(read_ret) < chunk)
+		break;
+	}
+    }
+
+
     void
     SystemCmd::Executor::split_buffer(const char* name, string& buffer, vector<string>& lines, bool finito) const
     {
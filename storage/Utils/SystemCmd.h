@@ -126,6 +126,14 @@ namespace storage
 	     */
 	    std::function<bool(int)> verify = [](int exit_code) { return exit_code == 0; };
 
+	    /**
+	     * Collect stdout in one contiguous buffer instead of separate
+	     * lines. The output is then available via stdout_buffer() and
+	     * stdout_line_views() while stdout() is empty. Avoids copying
+	     * large outputs line by line.
+	     */
+	    bool contiguous_stdout = false;
+
 	    /**
 	     * Environment variables for child. Per default this includes the original
 	     * environment and LC_ALL=C[.UTF-8] and LANGUAGE=C[.UTF-8].
@@ -176,6 +184,19 @@ namespace storage
 	 */
 	const vector<string>& stdout() const { return stdout_lines; }
 
+	/**
+	 * Return the output collected on stdout if contiguous_stdout is
+	 * set in the options.
+	 */
+	const string& stdout_buffer() const { return stdout_data; }
+
+	/**
+	 * Return the lines of the output collected on stdout if
+	 * contiguous_stdout is set in the options. The lines point into
+	 * stdout_buffer().
+	 */
+	const vector<string_view>& stdout_line_views() const { return stdout_views; }
+
 	/**
 	 * Return the output lines collected on stderr.
 	 */
@@ -217,9 +238,24 @@ namespace storage
 
 	string mockup_key() const;
 
+	/**
+	 * Sets stdout from lines, e.g. from mockup, respecting
+	 * contiguous_stdout.
+	 */
+	void set_stdout(const vector<string>& lines);
+
+	/**
+	 * Splits stdout_data into stdout_views.
+	 */
+	void split_stdout_data();
+
 	const Options options;
 
 	vector<string> stdout_lines;
+
+	string stdout_data;
+	vector<string_view> stdout_views;
+
 	vector<string> stderr_lines;
 
 	int child_retcode = -1;
@@ -21,29 +21,421 @@
  */
 
 
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <arpa/inet.h>
+#include <linux/netlink.h>
+#include <chrono>
+#include <boost/algorithm/string.hpp>
+
 #include "storage/Utils/Udev.h"
 #include "storage/Utils/SystemCmd.h"
 #include "storage/Utils/StorageDefines.h"
+#include "storage/Utils/ExceptionImpl.h"
+#include "storage/Utils/LoggerImpl.h"
+#include "storage/Utils/Format.h"
 
 
 namespace storage
 {
+    using namespace std;
+
 
     void
     udev_settle()
     {
+	UdevMonitor* udev_monitor = UdevMonitor::get_current();
+	if (udev_monitor && udev_monitor->wait())
+	    return;
+
 	SystemCmd({ UDEVADM_BIN_SETTLE }, SystemCmd::NoThrow);
     }
 
 
     void
-    Udevadm::settle()
+    udev_settle(const vector<string>& names)
+    {
+	UdevMonitor* udev_monitor = UdevMonitor::get_current();
+	if (udev_monitor && udev_monitor->wait(names))
+	    return;
+
+	SystemCmd({ UDEVADM_BIN_SETTLE }, SystemCmd::NoThrow);
+    }
+
+
+    namespace
     {
-	if (settle_needed)
+
+	// netlink multicast groups of the kernel and of udev
+	const unsigned int GROUP_KERNEL = 1;
+	const unsigned int GROUP_UDEV = 2;
+
+	// same timeout as used for 'udevadm settle'
+	const chrono::seconds default_timeout(20);
+
+
+	/**
+	 * Header of the messages sent by udev, see monitor_netlink_header in
+	 * systemd.
+	 */
+	struct UdevHeader
 	{
-	    udev_settle();
-	    settle_needed = false;
+	    char prefix[8];
+	    uint32_t magic;
+	    uint32_t header_size;
+	    uint32_t properties_off;
+	    uint32_t properties_len;
+	    uint32_t filter_subsystem_hash;
+	    uint32_t filter_devtype_hash;
+	    uint32_t filter_tag_bloom_hi;
+	    uint32_t filter_tag_bloom_lo;
+	};
+
+	const uint32_t udev_magic = 0xfeedcafe;
+
+
+	/**
+	 * Returns the devpath (e.g. /devices/virtual/block/dm-0) of the block
+	 * device or an empty string if the name does not resolve to a block
+	 * device.
+	 */
+	string
+	get_devpath(const string& name)
+	{
+	    struct stat st;
+	    if (stat(name.c_str(), &st) != 0 || !S_ISBLK(st.st_mode))
+		return "";
+
+	    string path = sformat("/sys/dev/block/%d:%d", major(st.st_rdev), minor(st.st_rdev));
+
+	    char* real_path = realpath(path.c_str(), nullptr);
+	    if (!real_path)
+		return "";
+
+	    string devpath = real_path;
+	    free(real_path);
+
+	    if (!boost::starts_with(devpath, "/sys/"))
+		return "";
+
+	    return devpath.substr(4);
 	}
+
+    }
+
+
+    UdevMonitor* UdevMonitor::current = nullptr;
+
+
+    UdevMonitor::UdevMonitor()
+	: timeout(default_timeout)
+    {
+	if (current)
+	    ST_THROW(LogicException("udev monitor already active"));
+
+	// Without udevd the events would never be processed.
+
+	if (access("/run/udev/control", F_OK) != 0)
+	    ST_THROW(Exception("udevd not running"));
+
+	fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_KOBJECT_UEVENT);
+	if (fd < 0)
+	    ST_THROW(Exception(sformat("socket for udev monitor failed, errno:%d", errno)));
+
+	const int on = 1;
+	setsockopt(fd, SOL_SOCKET, SO_PASSCRED, &on, sizeof(on));
+
+	// Large buffer to reduce the risk of losing events while no wait is
+	// running.
+
+	const int buffer_size = 16 * 1024 * 1024;
+	if (setsockopt(fd, SOL_SOCKET, SO_RCVBUFFORCE, &buffer_size, sizeof(buffer_size)) != 0)
+	    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size));
+
+	struct sockaddr_nl addr = {};
+	addr.nl_family = AF_NETLINK;
+	addr.nl_groups = GROUP_KERNEL | GROUP_UDEV;
+
+	if (bind(fd, (struct sockaddr*)(&addr), sizeof(addr)) != 0)
+	{
+	    int errnum = errno;
+	    close(fd);
+	    ST_THROW(Exception(sformat("bind for udev monitor failed, errno:%d", errnum)));
+	}
+
+	current = this;
+
+	y2mil("udev monitor started");
+    }
+
+
+    UdevMonitor::UdevMonitor(int fd, chrono::milliseconds timeout)
+	: fd(fd), timeout(timeout)
+    {
+	if (current)
+	    ST_THROW(LogicException("udev monitor already active"));
+
+	current = this;
+    }
+
+
+    UdevMonitor::~UdevMonitor()
+    {
+	current = nullptr;
+
+	close(fd);
+
+	y2mil("udev monitor stopped");
+    }
+
+
+    bool
+    UdevMonitor::wait(const vector<string>& names)
+    {
+	vector<string> devpaths;
+
+	for (const string& name : names)
+	{
+	    string devpath = get_devpath(name);
+	    if (devpath.empty())
+	    {
+		y2deb("no devpath for " << name);
+		return wait({}, true);
+	    }
+
+	    devpaths.push_back(devpath);
+	}
+
+	return wait(devpaths, false);
+    }
+
+
+    bool
+    UdevMonitor::wait()
+    {
+	return wait({}, true);
+    }
+
+
+    bool
+    UdevMonitor::wait(const vector<string>& devpaths, bool all)
+    {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	// The kernel sends the uevents synchronously so the events caused
+	// by commands already run are queued in the socket.
+
+	if (!receive())
+	    return false;
+
+	if (pending.empty())
+	    return true;
+
+	// Only wait for events seen so far. Otherwise a busy system could
+	// keep the wait running.
+
+	const unsigned long long last = pending.rbegin()->first;
+
+	auto relevant = [&devpaths, all, last](const map<unsigned long long, string>::value_type& event) {
+	    if (event.first > last)
+		return false;
+
+	    if (all)
+		return true;
+
+	    for (const string& devpath : devpaths)
+	    {
+		if (event.second == devpath || boost::starts_with(event.second, devpath + "/"))
+		    return true;
+	    }
+
+	    return false;
+	};
+
+	auto has_relevant = [this, &relevant]() {
+	    for (const map<unsigned long long, string>::value_type& event : pending)
+	    {
+		if (relevant(event))
+		    return true;
+	    }
+
+	    return false;
+	};
+
+	const chrono::steady_clock::time_point deadline = chrono::steady_clock::now() + timeout;
+
+	while (has_relevant())
+	{
+	    chrono::milliseconds remaining = chrono::duration_cast<chrono::milliseconds>(deadline -
+										       chrono::steady_clock::now());
+	    if (remaining.count() <= 0)
+	    {
+		y2war("timeout waiting for udev");
+
+		for (map<unsigned long long, string>::iterator it = pending.begin(); it != pending.end(); )
+		{
+		    if (relevant(*it))
+			it = pending.erase(it);
+		    else
+			++it;
+		}
+
+		return true;
+	    }
+
+	    struct pollfd pfd = { fd, POLLIN, 0 };
+	    if (poll(&pfd, 1, remaining.count()) < 0 && errno != EINTR)
+	    {
+		y2war("poll for udev monitor failed, errno:" << errno);
+		return false;
+	    }
+
+	    if (!receive())
+		return false;
+	}
+
+	return true;
+    }
+
+
+    bool
+    UdevMonitor::receive()
+    {
+	char buffer[8192];
+	char control[CMSG_SPACE(sizeof(struct ucred))];
+
+	while (true)
+	{
+	    struct iovec iov = { buffer, sizeof(buffer) };
+	    struct sockaddr_nl addr = {};
+
+	    struct msghdr msg = {};
+	    msg.msg_name = &addr;
+	    msg.msg_namelen = sizeof(addr);
+	    msg.msg_iov = &iov;
+	    msg.msg_iovlen = 1;
+	    msg.msg_control = control;
+	    msg.msg_controllen = sizeof(control);
+
+	    ssize_t size = recvmsg(fd, &msg, 0);
+	    if (size < 0)
+	    {
+		if (errno == EAGAIN || errno == EWOULDBLOCK)
+		    return true;
+
+		if (errno == EINTR)
+		    continue;
+
+		// ENOBUFS: Events were lost so nothing is known about the
+		// pending events anymore.
+
+		y2war("recvmsg for udev monitor failed, errno:" << errno);
+
+		pending.clear();
+
+		return false;
+	    }
+
+	    if (msg.msg_flags & MSG_TRUNC)
+		continue;
+
+	    if (addr.nl_groups == GROUP_KERNEL && addr.nl_pid == 0)
+	    {
+		process(buffer, size, true);
+	    }
+	    else if (addr.nl_groups == GROUP_UDEV && addr.nl_pid != 0)
+	    {
+		// Only trust messages from root.
+
+		struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+		if (!cmsg || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_CREDENTIALS)
+		    continue;
+
+		const struct ucred* cred = (const struct ucred*)(CMSG_DATA(cmsg));
+		if (cred->uid != 0)
+		    continue;
+
+		process(buffer, size, false);
+	    }
+	}
+    }
+
+
+    void
+    UdevMonitor::process(const char* data, size_t size, bool from_kernel)
+    {
+	const char* p = data;
+	const char* end = data + size;
+
+	if (from_kernel)
+	{
+	    // the kernel message starts with "action@devpath"
+
+	    if (!memchr(data, '@', strnlen(data, size)))
+		return;
+
+	    p += strnlen(data, size) + 1;
+	}
+	else
+	{
+	    UdevHeader header;
+	    if (size < sizeof(header))
+		return;
+
+	    memcpy(&header, data, sizeof(header));
+
+	    if (memcmp(header.prefix, "libudev", 8) != 0 || ntohl(header.magic) != udev_magic)
+		return;
+
+	    if (header.properties_off < sizeof(header) || header.properties_off > size ||
+		header.properties_len > size - header.properties_off)
+		return;
+
+	    p = data + header.properties_off;
+	    end = p + header.properties_len;
+	}
+
+	string subsystem;
+	string devpath;
+	unsigned long long seqnum = 0;
+
+	while (p < end)
+	{
+	    size_t length = strnlen(p, end - p);
+	    const string property(p, length);
+	    p += length + 1;
+
+	    if (boost::starts_with(property, "SUBSYSTEM="))
+		subsystem = property.substr(10);
+	    else if (boost::starts_with(property, "DEVPATH="))
+		devpath = property.substr(8);
+	    else if (boost::starts_with(property, "SEQNUM="))
+		seqnum = strtoull(property.c_str() + 7, nullptr, 10);
+	}
+
+	if (subsystem != "block" || seqnum == 0)
+	    return;
+
+	if (from_kernel)
+	    pending[seqnum] = devpath;
+	else
+	    pending.erase(seqnum);
+    }
+
+
+    void
+    Udevadm::settle()
+    {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (settle_needed.exchange(false))
+	    udev_settle();
     }
 
 
@@ -26,15 +26,110 @@
 
 
 #include <string>
+#include <vector>
+#include <map>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <boost/noncopyable.hpp>
 
 
 namespace storage
 {
     using std::string;
+    using std::vector;
 
 
+    /**
+     * Waits for udev to process its events. If a UdevMonitor is active only
+     * the events seen by the monitor so far are considered, otherwise
+     * 'udevadm settle' is run.
+     */
     void udev_settle();
 
+    /**
+     * Waits for udev to process the events of the block devices with the
+     * given names (including their partitions). If no UdevMonitor is active
+     * 'udevadm settle' is run.
+     */
+    void udev_settle(const vector<string>& names);
+
+
+    /**
+     * Monitors the kernel and udev uevents of block devices via netlink to
+     * know which events udev has not yet processed. Thus waiting can be
+     * limited to the events of specific devices instead of the whole udev
+     * queue which on busy systems may never be empty.
+     *
+     * While an object exists udev_settle() uses it. At most one object may
+     * exist at a time.
+     */
+    class UdevMonitor : private boost::noncopyable
+    {
+
+    public:
+
+	/**
+	 * @throw Exception if the netlink socket cannot be opened
+	 */
+	UdevMonitor();
+
+	~UdevMonitor();
+
+	static UdevMonitor* get_current() { return current; }
+
+	/**
+	 * Waits until udev has processed the events seen so far of the
+	 * block devices with the given names. If a name does not resolve to
+	 * a block device all events seen so far are considered. Can be
+	 * called from several threads.
+	 *
+	 * Returns false if events were lost, in that case the caller has to
+	 * fall back to 'udevadm settle'.
+	 */
+	bool wait(const vector<string>& names);
+
+	/**
+	 * Waits until udev has processed all events seen so far.
+	 */
+	bool wait();
+
+    protected:
+
+	/**
+	 * Uses the given socket instead of opening a netlink socket and waits
+	 * at most timeout for udev. Only for the testsuite.
+	 */
+	UdevMonitor(int fd, std::chrono::milliseconds timeout);
+
+	bool wait(const vector<string>& devpaths, bool all);
+
+	void process(const char* data, size_t size, bool from_kernel);
+
+	/**
+	 * Events seen from the kernel but not yet from udev, mapping the
+	 * sequence number to the devpath.
+	 */
+	std::map<unsigned long long, string> pending;
+
+    private:
+
+	/**
+	 * Reads and processes all queued messages. Returns false if
+	 * messages were lost.
+	 */
+	bool receive();
+
+	int fd = -1;
+
+	const std::chrono::milliseconds timeout;
+
+	std::mutex mutex;
+
+	static UdevMonitor* current;
+
+    };
+
 
     class Udevadm
     {
@@ -42,7 +137,7 @@ namespace storage
     public:
 
 	/**
-	 * Settle iff flag is set.
+	 * Settle iff flag is set. Can be called from several threads.
 	 */
 	void settle();
 
@@ -50,7 +145,9 @@ namespace storage
 
     private:
 
-	bool settle_needed = true;
+	std::atomic<bool> settle_needed { true };
+
+	std::mutex mutex;
 
     };
 
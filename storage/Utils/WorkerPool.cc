@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2026 SUSE LLC
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#include <atomic>
+#include <thread>
+#include <system_error>
+
+#include "storage/Utils/WorkerPool.h"
+#include "storage/Utils/Remote.h"
+#include "storage/Utils/LoggerImpl.h"
+
+
+namespace storage
+{
+    using namespace std;
+
+
+    void
+    run_in_worker_pool(const vector<std::function<void()>>& tasks, int max_threads)
+    {
+	size_t num_threads = max_threads > 1 ? min<size_t>(max_threads, tasks.size()) : 1;
+
+	if (num_threads <= 1 || get_remote_callbacks())
+	{
+	    for (const std::function<void()>& task : tasks)
+		task();
+
+	    return;
+	}
+
+	y2mil("running " << tasks.size() << " tasks on " << num_threads << " threads");
+
+	atomic<size_t> next(0);
+
+	auto worker = [&tasks, &next]() {
+	    for (size_t i = next++; i < tasks.size(); i = next++)
+		tasks[i]();
+	};
+
+	// The calling thread is one of the workers. So even if starting threads
+	// fails all tasks are run.
+
+	vector<thread> threads;
+	threads.reserve(num_threads - 1);
+
+	try
+	{
+	    for (size_t i = 1; i < num_threads; ++i)
+		threads.emplace_back(worker);
+	}
+	catch (const system_error& e)
+	{
+	    y2war("starting thread failed: " << e.what());
+	}
+
+	worker();
+
+	for (thread& thread : threads)
+	    thread.join();
+    }
+
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2026 SUSE LLC
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#ifndef STORAGE_WORKER_POOL_H
+#define STORAGE_WORKER_POOL_H
+
+
+#include <vector>
+#include <functional>
+
+
+namespace storage
+{
+    using std::vector;
+
+
+    /**
+     * Runs the tasks on at most max_threads threads and returns once all
+     * tasks have finished. With max_threads below 2 or a single task the
+     * tasks are run on the calling thread.
+     *
+     * The tasks must not throw. Running the tasks concurrently is only
+     * possible if no remote callbacks are installed since those are not
+     * required to be thread-safe, otherwise the tasks are also run on the
+     * calling thread.
+     */
+    void run_in_worker_pool(const vector<std::function<void()>>& tasks, int max_threads);
+
+}
+
+
+#endif
@@ -22,6 +22,7 @@
 
 
 #include <cstring>
+#include <algorithm>
 #include <libxml/parser.h>
 
 #include "storage/Utils/XmlFile.h"
@@ -178,6 +179,18 @@ namespace storage
     }
 
 
+    bool
+    is_plain_decimal(const string& s)
+    {
+	string::size_type pos = !s.empty() && s[0] == '-' ? 1 : 0;
+
+	if (pos == s.size() || (s[pos] == '0' && s.size() > pos + 1))
+	    return false;
+
+	return all_of(s.begin() + pos, s.end(), [](char c) { return c >= '0' && c <= '9'; });
+    }
+
+
     void
     setChildValue(xmlNode* node, const char* name, const char* value)
     {
@@ -31,6 +31,7 @@
 #include <sstream>
 #include <iomanip>
 #include <optional>
+#include <charconv>
 #include <boost/noncopyable.hpp>
 
 #include "storage/Utils/AppUtil.h"
@@ -84,6 +85,13 @@ namespace storage
     bool getChildValue(const xmlNode* node, const char* name, bool& value);
 
 
+    /**
+     * Whether the string is a decimal number without leading zeros, the
+     * format written by setChildValue().
+     */
+    bool is_plain_decimal(const string& s);
+
+
     template<typename Type>
     bool getChildValue(const xmlNode* node, const char* name, Type& value)
     {
@@ -93,6 +101,13 @@ namespace storage
 	if (!getChildValue(node, name, tmp))
 	    return false;
 
+	if (is_plain_decimal(tmp))
+	{
+	    std::from_chars_result result = std::from_chars(tmp.data(), tmp.data() + tmp.size(), value);
+	    if (result.ec == std::errc() && result.ptr == tmp.data() + tmp.size())
+		return true;
+	}
+
 	std::istringstream istr(tmp);
 	classic(istr);
 	istr >> std::setbase(0) >> value;
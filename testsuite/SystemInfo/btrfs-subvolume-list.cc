@@ -61,3 +61,30 @@ BOOST_AUTO_TEST_CASE(parse_empty)
 {
     check({}, {});
 }
+
+
+BOOST_AUTO_TEST_CASE(from_ioctl)
+{
+    BtrfsIoctl::Subvolumes subvolumes;
+    subvolumes.top_level_uuid = "d6b02b4f-368c-4c49-b749-60ccbafeaa9a";
+    subvolumes.default_id = 259;
+    subvolumes.subvolumes = {
+	{ 256, 5, "1a", "a3dc5067-ec7e-f046-8538-e768583d1f4e", "d6b02b4f-368c-4c49-b749-60ccbafeaa9a" },
+	{ 258, 259, "2b/2a", "19e6acf1-5fbe-8345-be44-8cd6685d39a2", "" },
+	{ 259, 5, "2b", "2c58057e-640b-dc48-92d5-9d1c35185d7a", "19e6acf1-5fbe-8345-be44-8cd6685d39a2" }
+    };
+
+    vector<string> output = {
+	"id:256 parent-id:5 path:1a uuid:a3dc5067-ec7e-f046-8538-e768583d1f4e parent-uuid:d6b02b4f-368c-4c49-b749-60ccbafeaa9a",
+	"id:258 parent-id:259 path:2b/2a uuid:19e6acf1-5fbe-8345-be44-8cd6685d39a2",
+	"id:259 parent-id:5 path:2b uuid:2c58057e-640b-dc48-92d5-9d1c35185d7a parent-uuid:19e6acf1-5fbe-8345-be44-8cd6685d39a2"
+    };
+
+    ostringstream parsed;
+    parsed << CmdBtrfsSubvolumeList(subvolumes);
+
+    BOOST_CHECK_EQUAL(parsed.str(), boost::join(output, "\n") + "\n");
+
+    BOOST_CHECK_EQUAL(CmdBtrfsSubvolumeShow(subvolumes).get_uuid(), "d6b02b4f-368c-4c49-b749-60ccbafeaa9a");
+    BOOST_CHECK_EQUAL(CmdBtrfsSubvolumeGetDefault(subvolumes).get_id(), 259);
+}
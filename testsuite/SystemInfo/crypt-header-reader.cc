@@ -0,0 +1,132 @@
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <boost/test/unit_test.hpp>
+
+#include <string.h>
+
+#include "storage/SystemInfo/CryptHeaderReader.h"
+#include "testsuite/helpers/Image.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+CryptHeaderReader
+read(const Image& image)
+{
+    image.write();
+
+    return CryptHeaderReader(image.get_name());
+}
+
+
+const char* uuid = "f0b3c940-6bf1-4afa-8ba4-fa4d97b026b6";
+
+
+const char* json =
+    "{\"keyslots\":{"
+    "\"1\":{\"type\":\"luks2\",\"key_size\":32,\"kdf\":{\"type\":\"pbkdf2\"}},"
+    "\"0\":{\"type\":\"luks2\",\"key_size\":64,\"kdf\":{\"type\":\"argon2id\"}}},"
+    "\"segments\":{\"0\":{\"type\":\"crypt\",\"offset\":\"16777216\",\"size\":\"dynamic\","
+    "\"encryption\":\"aes-xts-plain64\",\"sector_size\":4096,"
+    "\"integrity\":{\"type\":\"hmac(sha256)\"}}},"
+    "\"digests\":{},\"config\":{\"json_size\":\"12288\",\"keyslots_size\":\"16744448\"}}";
+
+
+void
+put_luks2(Image& image, uint64_t offset, const char* magic, uint64_t seqid)
+{
+    const uint64_t hdr_size = 16 * 1024;
+
+    image.put(offset, magic, 6);
+    put_be(image.at(offset + 6, 2), 2, 2);
+    put_be(image.at(offset + 8, 8), hdr_size, 8);
+    put_be(image.at(offset + 16, 8), seqid, 8);
+    image.put(offset + 168, uuid);
+    image.put(offset + 4096, json);
+}
+
+
+BOOST_AUTO_TEST_CASE(none)
+{
+    Image image("crypt-header-reader", 1024 * 1024);
+
+    CryptHeaderReader reader = read(image);
+
+    BOOST_CHECK(!reader.is_supported());
+}
+
+
+BOOST_AUTO_TEST_CASE(luks1)
+{
+    Image image("crypt-header-reader", 1024 * 1024);
+    image.put(0, "LUKS\xba\xbe\x00\x01", 8);
+    image.put(8, "aes");
+    image.put(40, "xts-plain64");
+    put_be(image.at(108, 4), 64, 4);
+    image.put(168, uuid);
+
+    CryptHeaderReader reader = read(image);
+
+    BOOST_REQUIRE(reader.is_supported());
+    BOOST_CHECK(reader.get_encryption_type() == EncryptionType::LUKS1);
+    BOOST_CHECK_EQUAL(reader.get_uuid(), uuid);
+    BOOST_CHECK_EQUAL(reader.get_cipher(), "aes-xts-plain64");
+    BOOST_CHECK_EQUAL(reader.get_key_size(), 64);
+    BOOST_CHECK_EQUAL(reader.get_pbkdf(), "");
+}
+
+
+BOOST_AUTO_TEST_CASE(luks2)
+{
+    Image image("crypt-header-reader", 1024 * 1024);
+    put_luks2(image, 0, "LUKS\xba\xbe", 3);
+    put_luks2(image, 16 * 1024, "SKUL\xba\xbe", 3);
+
+    CryptHeaderReader reader = read(image);
+
+    BOOST_REQUIRE(reader.is_supported());
+    BOOST_CHECK(reader.get_encryption_type() == EncryptionType::LUKS2);
+    BOOST_CHECK_EQUAL(reader.get_uuid(), uuid);
+    BOOST_CHECK_EQUAL(reader.get_cipher(), "aes-xts-plain64");
+    BOOST_CHECK_EQUAL(reader.get_key_size(), 64);
+    BOOST_CHECK_EQUAL(reader.get_pbkdf(), "argon2id");
+    BOOST_CHECK_EQUAL(reader.get_integrity(), "hmac(sha256)");
+}
+
+
+BOOST_AUTO_TEST_CASE(luks2_mismatch)
+{
+    // The headers differ in the sequence id, e.g. during an update.
+
+    Image image("crypt-header-reader", 1024 * 1024);
+    put_luks2(image, 0, "LUKS\xba\xbe", 4);
+    put_luks2(image, 16 * 1024, "SKUL\xba\xbe", 3);
+
+    BOOST_CHECK(!read(image).is_supported());
+}
+
+
+BOOST_AUTO_TEST_CASE(bitlocker)
+{
+    Image image("crypt-header-reader", 1024 * 1024);
+    image.put(3, "-FVE-FS-", 8);
+    put_le(image.at(160, 8), 0x21000, 8);
+
+    uint8_t* fve = image.at(0x21000, 512);
+    memcpy(fve, "-FVE-FS-", 8);
+    put_le(fve + 10, 2, 2);
+    memcpy(fve + 80, "\xdb\x41\x25\xdc\x5b\x27\x84\x4c\x85\xe0\x0a\x74\x3b\x3f\xf2\x29", 16);
+    put_le(fve + 100, 0x8004, 2);
+
+    CryptHeaderReader reader = read(image);
+
+    BOOST_REQUIRE(reader.is_supported());
+    BOOST_CHECK(reader.get_encryption_type() == EncryptionType::BITLOCKER);
+    BOOST_CHECK_EQUAL(reader.get_uuid(), "dc2541db-275b-4c84-85e0-0a743b3ff229");
+    BOOST_CHECK_EQUAL(reader.get_cipher(), "aes-xts-plain64");
+    BOOST_CHECK_EQUAL(reader.get_key_size(), 32);
+}
@@ -0,0 +1,132 @@
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <boost/test/unit_test.hpp>
+#include <boost/algorithm/string.hpp>
+
+#include "storage/SystemInfo/CmdLvm.h"
+#include "storage/Utils/Mockup.h"
+#include "storage/Utils/StorageDefines.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+template <typename Type>
+string
+to_string(const Type& cmd)
+{
+    ostringstream parsed;
+    parsed.setf(std::ios::boolalpha);
+    parsed << cmd;
+
+    return parsed.str();
+}
+
+
+void
+check(const vector<string>& input, const vector<string>& output_pvs, const vector<string>& output_vgs,
+      const vector<string>& output_lvs)
+{
+    Mockup::set_mode(Mockup::Mode::PLAYBACK);
+    Mockup::set_command({ LVM_BIN, "fullreport", "--reportformat", "json", "--config",
+	    "log { command_names = 0 prefix = \"\" }", "--units", "b", "--nosuffix", "--all",
+	    "--configreport", "pv", "--options", "pv_name,pv_uuid,vg_name,vg_uuid,pv_attr,pe_start",
+	    "--configreport", "vg", "--options", "vg_name,vg_uuid,vg_attr,vg_extent_size,vg_extent_count,"
+	    "vg_free_count", "--configreport", "lv", "--options", "lv_name,lv_uuid,vg_name,vg_uuid,lv_role,"
+	    "lv_attr,lv_size,origin_size,pool_lv,pool_lv_uuid,origin,origin_uuid,data_lv,data_lv_uuid,"
+	    "metadata_lv,metadata_lv_uuid", "--configreport", "seg", "--options", "lv_uuid,segtype,stripes,"
+	    "stripe_size,chunk_size" }, input);
+
+    CmdLvmFullreport cmd_lvm_fullreport;
+
+    BOOST_CHECK_EQUAL(to_string(CmdPvs(cmd_lvm_fullreport)), boost::join(output_pvs, "\n") + "\n");
+    BOOST_CHECK_EQUAL(to_string(CmdVgs(cmd_lvm_fullreport)), boost::join(output_vgs, "\n") + "\n");
+    BOOST_CHECK_EQUAL(to_string(CmdLvs(cmd_lvm_fullreport)), boost::join(output_lvs, "\n") + "\n");
+}
+
+
+BOOST_AUTO_TEST_CASE(parse1)
+{
+    // Two VGs and an orphan PV. The LV "normal" has two segments, the LV
+    // "cache" needs the segtype of its segment to get the type.
+
+    vector<string> input = {
+	"  {",
+	"      \"report\": [",
+	"          {",
+	"              \"vg\": [",
+	"                  {\"vg_name\":\"system\", \"vg_uuid\":\"OMPzXF-m3am-1zIl-AVdQ-i5Wx-tmyN-cevmRn\", \"vg_attr\":\"wz--n-\", \"vg_extent_size\":\"4194304\", \"vg_extent_count\":\"10239\", \"vg_free_count\":\"1535\"}",
+	"              ]",
+	"              ,",
+	"              \"pv\": [",
+	"                  {\"pv_name\":\"/dev/sda2\", \"pv_uuid\":\"qquP1P-bCd0-Wmad-7e8r-KJOn-1qNv-vxAqbK\", \"vg_name\":\"system\", \"vg_uuid\":\"OMPzXF-m3am-1zIl-AVdQ-i5Wx-tmyN-cevmRn\", \"pv_attr\":\"a--\", \"pe_start\":\"1048576\"}",
+	"              ]",
+	"              ,",
+	"              \"lv\": [",
+	"                  {\"lv_name\":\"root\", \"lv_uuid\":\"89Crg8-K5dO-0Vvj-Vwur-vCLK-4efh-WCtRfN\", \"vg_name\":\"system\", \"vg_uuid\":\"OMPzXF-m3am-1zIl-AVdQ-i5Wx-tmyN-cevmRn\", \"lv_role\":\"public\", \"lv_attr\":\"-wi-ao----\", \"lv_size\":\"34359738368\", \"pool_lv\":\"\", \"pool_lv_uuid\":\"\"},",
+	"                  {\"lv_name\":\"normal\", \"lv_uuid\":\"3Kzffs-MSVL-qrEM-1Oca-t286-VtBJ-VIa2Xw\", \"vg_name\":\"system\", \"vg_uuid\":\"OMPzXF-m3am-1zIl-AVdQ-i5Wx-tmyN-cevmRn\", \"lv_role\":\"public\", \"lv_attr\":\"-wi-a-----\", \"lv_size\":\"8589934592\", \"pool_lv\":\"\", \"pool_lv_uuid\":\"\"}",
+	"              ]",
+	"              ,",
+	"              \"pvseg\": [",
+	"              ]",
+	"              ,",
+	"              \"seg\": [",
+	"                  {\"lv_uuid\":\"89Crg8-K5dO-0Vvj-Vwur-vCLK-4efh-WCtRfN\", \"segtype\":\"linear\", \"stripes\":\"1\", \"stripe_size\":\"0\", \"chunk_size\":\"0\"},",
+	"                  {\"lv_uuid\":\"3Kzffs-MSVL-qrEM-1Oca-t286-VtBJ-VIa2Xw\", \"segtype\":\"linear\", \"stripes\":\"1\", \"stripe_size\":\"0\", \"chunk_size\":\"0\"},",
+	"                  {\"lv_uuid\":\"3Kzffs-MSVL-qrEM-1Oca-t286-VtBJ-VIa2Xw\", \"segtype\":\"striped\", \"stripes\":\"2\", \"stripe_size\":\"65536\", \"chunk_size\":\"0\"}",
+	"              ]",
+	"          }",
+	"          ,",
+	"          {",
+	"              \"vg\": [",
+	"                  {\"vg_name\":\"test\", \"vg_uuid\":\"55auVT-aQ8G-MPiA-uXy1-dvJa-XNOs-6BWsXC\", \"vg_attr\":\"wz--n-\", \"vg_extent_size\":\"4194304\", \"vg_extent_count\":\"2559\", \"vg_free_count\":\"0\"}",
+	"              ]",
+	"              ,",
+	"              \"pv\": [",
+	"                  {\"pv_name\":\"/dev/sdb\", \"pv_uuid\":\"Zp3QqA-3sMe-7iSa-bCVi-lGMV-7KZu-cSXsdz\", \"vg_name\":\"test\", \"vg_uuid\":\"55auVT-aQ8G-MPiA-uXy1-dvJa-XNOs-6BWsXC\", \"pv_attr\":\"a--\", \"pe_start\":\"1048576\"}",
+	"              ]",
+	"              ,",
+	"              \"lv\": [",
+	"                  {\"lv_name\":\"cache\", \"lv_uuid\":\"N123dc-RYSs-YEAG-KcLk-kgki-Dvlx-Iwgj3L\", \"vg_name\":\"test\", \"vg_uuid\":\"55auVT-aQ8G-MPiA-uXy1-dvJa-XNOs-6BWsXC\", \"lv_role\":\"public\", \"lv_attr\":\"Cwi-a-C---\", \"lv_size\":\"10737418240\", \"pool_lv\":\"[cache-pool]\", \"pool_lv_uuid\":\"DfS7Ct-j41n-oz2e-C8vE-RuSt-blac-NjJwkW\"}",
+	"              ]",
+	"              ,",
+	"              \"seg\": [",
+	"                  {\"lv_uuid\":\"N123dc-RYSs-YEAG-KcLk-kgki-Dvlx-Iwgj3L\", \"segtype\":\"cache\", \"stripes\":\"1\", \"stripe_size\":\"0\", \"chunk_size\":\"65536\"}",
+	"              ]",
+	"          }",
+	"          ,",
+	"          {",
+	"              \"vg\": [",
+	"                  {\"vg_name\":\"\", \"vg_uuid\":\"\", \"vg_attr\":\"\", \"vg_extent_size\":\"0\", \"vg_extent_count\":\"0\", \"vg_free_count\":\"0\"}",
+	"              ]",
+	"              ,",
+	"              \"pv\": [",
+	"                  {\"pv_name\":\"/dev/sdc\", \"pv_uuid\":\"kW3Qbx-OBbB-9UxK-3JBt-Pm9i-rsLp-tTb1Ee\", \"vg_name\":\"\", \"vg_uuid\":\"\", \"pv_attr\":\"---\", \"pe_start\":\"1048576\"}",
+	"              ]",
+	"          }",
+	"      ]",
+	"  }"
+    };
+
+    vector<string> output_pvs = {
+	"pv:{ pv-name:/dev/sda2 pv-uuid:qquP1P-bCd0-Wmad-7e8r-KJOn-1qNv-vxAqbK vg-name:system vg-uuid:OMPzXF-m3am-1zIl-AVdQ-i5Wx-tmyN-cevmRn pe-start:1048576 }",
+	"pv:{ pv-name:/dev/sdb pv-uuid:Zp3QqA-3sMe-7iSa-bCVi-lGMV-7KZu-cSXsdz vg-name:test vg-uuid:55auVT-aQ8G-MPiA-uXy1-dvJa-XNOs-6BWsXC pe-start:1048576 }",
+	"pv:{ pv-name:/dev/sdc pv-uuid:kW3Qbx-OBbB-9UxK-3JBt-Pm9i-rsLp-tTb1Ee vg-name: vg-uuid: pe-start:1048576 }"
+    };
+
+    vector<string> output_vgs = {
+	"vg:{ vg-name:system vg-uuid:OMPzXF-m3am-1zIl-AVdQ-i5Wx-tmyN-cevmRn extent-size:4194304 extent-count:10239 free-extent-count:1535 }",
+	"vg:{ vg-name:test vg-uuid:55auVT-aQ8G-MPiA-uXy1-dvJa-XNOs-6BWsXC extent-size:4194304 extent-count:2559 free-extent-count:0 }"
+    };
+
+    vector<string> output_lvs = {
+	"lv:{ lv-name:cache lv-uuid:N123dc-RYSs-YEAG-KcLk-kgki-Dvlx-Iwgj3L vg-name:test vg-uuid:55auVT-aQ8G-MPiA-uXy1-dvJa-XNOs-6BWsXC lv-type:cache role:public active:true size:10737418240 pool-name:[cache-pool] pool-uuid:DfS7Ct-j41n-oz2e-C8vE-RuSt-blac-NjJwkW segments:<stripes:1 chunk-size:65536> }",
+	"lv:{ lv-name:normal lv-uuid:3Kzffs-MSVL-qrEM-1Oca-t286-VtBJ-VIa2Xw vg-name:system vg-uuid:OMPzXF-m3am-1zIl-AVdQ-i5Wx-tmyN-cevmRn lv-type:normal role:public active:true size:8589934592 segments:<stripes:1 stripes:2 stripe-size:65536> }",
+	"lv:{ lv-name:root lv-uuid:89Crg8-K5dO-0Vvj-Vwur-vCLK-4efh-WCtRfN vg-name:system vg-uuid:OMPzXF-m3am-1zIl-AVdQ-i5Wx-tmyN-cevmRn lv-type:normal role:public active:true size:34359738368 segments:<stripes:1> }"
+    };
+
+    check(input, output_pvs, output_vgs, output_lvs);
+}
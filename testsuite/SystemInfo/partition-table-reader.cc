@@ -0,0 +1,253 @@
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <boost/test/unit_test.hpp>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "storage/SystemInfo/PartitionTableReader.h"
+#include "storage/Devices/Partition.h"
+#include "testsuite/helpers/Image.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+void
+put_mbr_entry(uint8_t* mbr, int i, uint8_t boot, uint8_t id, uint32_t start, uint32_t length)
+{
+    uint8_t* p = mbr + 446 + 16 * i;
+
+    p[0] = boot;
+    p[4] = id;
+    put_le32(p + 8, start);
+    put_le32(p + 12, length);
+
+    mbr[510] = 0x55;
+    mbr[511] = 0xaa;
+}
+
+
+void
+put_guid(uint8_t* p, const string& guid)
+{
+    unsigned int a, b, c, d[8];
+    sscanf(guid.c_str(), "%8x-%4x-%4x-%2x%2x-%2x%2x%2x%2x%2x%2x", &a, &b, &c, &d[0], &d[1],
+	   &d[2], &d[3], &d[4], &d[5], &d[6], &d[7]);
+
+    put_le32(p, a);
+    put_le16(p + 4, b);
+    put_le16(p + 6, c);
+    for (int i = 0; i < 8; ++i)
+	p[8 + i] = d[i];
+}
+
+
+/**
+ * Writes a GPT header and its partition entry array with 128 entries of
+ * which the first two are given.
+ */
+void
+put_gpt(Image& image, uint64_t sector, uint64_t alternate, uint64_t array_sector,
+	const uint8_t (&array)[2][128])
+{
+    vector<uint8_t> tmp(128 * 128, 0);
+    memcpy(tmp.data(), array, sizeof(array));
+
+    for (int i = 0; i < 32; ++i)
+	memcpy(image.sector(array_sector + i), tmp.data() + 512 * i, 512);
+
+    uint8_t* p = image.sector(sector);
+
+    memcpy(p, "EFI PART", 8);
+    put_le32(p + 8, 0x00010000);
+    put_le32(p + 12, 92);
+    put_le64(p + 24, sector);
+    put_le64(p + 32, alternate);
+    put_le64(p + 40, 34);
+    put_le64(p + 48, 204800 - 34);
+    put_le64(p + 72, array_sector);
+    put_le32(p + 80, 128);
+    put_le32(p + 84, 128);
+    put_le32(p + 88, PartitionTableReader::crc32(tmp.data(), tmp.size()));
+    put_le32(p + 16, PartitionTableReader::crc32(p, 92));
+}
+
+
+void
+put_gpt_entries(uint8_t (&array)[2][128])
+{
+    memset(array, 0, sizeof(array));
+
+    put_guid(array[0], "c12a7328-f81f-11d2-ba4b-00a0c93ec93b");
+    put_le64(array[0] + 32, 2048);
+    put_le64(array[0] + 40, 4095);
+    put_le16(array[0] + 56, 'E');
+    put_le16(array[0] + 58, 'F');
+    put_le16(array[0] + 60, 'I');
+
+    put_guid(array[1], "0fc63daf-8483-4772-8e79-3d69d8477de4");
+    put_le64(array[1] + 32, 4096);
+    put_le64(array[1] + 40, 100000);
+    put_le64(array[1] + 48, 1ULL << 2);
+    put_le16(array[1] + 56, 0xe4);	// a umlaut
+}
+
+
+BOOST_AUTO_TEST_CASE(crc32)
+{
+    BOOST_CHECK_EQUAL(PartitionTableReader::crc32("123456789", 9), 0xcbf43926);
+}
+
+
+BOOST_AUTO_TEST_CASE(no_partition_table)
+{
+    Image image("partition-table-reader", 2048 * 512);
+    image.sector(0);
+    image.write();
+
+    PartitionTableReader partition_table_reader(image.get_name());
+
+    BOOST_CHECK(!partition_table_reader.is_supported());
+}
+
+
+BOOST_AUTO_TEST_CASE(msdos)
+{
+    Image image("partition-table-reader", 204800 * 512);
+
+    uint8_t* mbr = image.sector(0);
+    put_mbr_entry(mbr, 0, 0x80, 0x83, 2048, 4096);
+    put_mbr_entry(mbr, 1, 0x00, 0x0f, 8192, 16384);
+
+    uint8_t* ebr1 = image.sector(8192);
+    put_mbr_entry(ebr1, 0, 0x00, 0x82, 2048, 2048);
+    put_mbr_entry(ebr1, 1, 0x00, 0x05, 6144, 6144);
+
+    uint8_t* ebr2 = image.sector(8192 + 6144);
+    put_mbr_entry(ebr2, 0, 0x00, 0x8e, 2048, 4096);
+
+    image.write();
+
+    PartitionTableReader partition_table_reader(image.get_name());
+
+    BOOST_REQUIRE(partition_table_reader.is_supported());
+
+    BOOST_CHECK(partition_table_reader.get_label() == PtType::MSDOS);
+    BOOST_CHECK_EQUAL(partition_table_reader.get_region(), Region(0, 204800, 512));
+    BOOST_CHECK_EQUAL(partition_table_reader.get_primary_slots(), 4);
+
+    const vector<CmdParted::Entry>& entries = partition_table_reader.get_entries();
+    BOOST_REQUIRE_EQUAL(entries.size(), 4);
+
+    BOOST_CHECK_EQUAL(entries[0].number, 1);
+    BOOST_CHECK_EQUAL(entries[0].region, Region(2048, 4096, 512));
+    BOOST_CHECK(entries[0].type == PartitionType::PRIMARY);
+    BOOST_CHECK_EQUAL(entries[0].id, ID_LINUX);
+    BOOST_CHECK(entries[0].boot);
+
+    BOOST_CHECK_EQUAL(entries[1].number, 2);
+    BOOST_CHECK_EQUAL(entries[1].region, Region(8192, 16384, 512));
+    BOOST_CHECK(entries[1].type == PartitionType::EXTENDED);
+    BOOST_CHECK_EQUAL(entries[1].id, ID_EXTENDED);
+
+    BOOST_CHECK_EQUAL(entries[2].number, 5);
+    BOOST_CHECK_EQUAL(entries[2].region, Region(10240, 2048, 512));
+    BOOST_CHECK(entries[2].type == PartitionType::LOGICAL);
+    BOOST_CHECK_EQUAL(entries[2].id, ID_SWAP);
+
+    BOOST_CHECK_EQUAL(entries[3].number, 6);
+    BOOST_CHECK_EQUAL(entries[3].region, Region(16384, 4096, 512));
+    BOOST_CHECK(entries[3].type == PartitionType::LOGICAL);
+    BOOST_CHECK_EQUAL(entries[3].id, ID_LVM);
+}
+
+
+BOOST_AUTO_TEST_CASE(gpt)
+{
+    Image image("partition-table-reader", 204800 * 512);
+
+    put_mbr_entry(image.sector(0), 0, 0x00, 0xee, 1, 204799);
+
+    uint8_t array[2][128];
+    put_gpt_entries(array);
+
+    put_gpt(image, 1, 204799, 2, array);
+    put_gpt(image, 204799, 1, 204799 - 32, array);
+
+    image.write();
+
+    PartitionTableReader partition_table_reader(image.get_name());
+
+    BOOST_REQUIRE(partition_table_reader.is_supported());
+
+    BOOST_CHECK(partition_table_reader.get_label() == PtType::GPT);
+    BOOST_CHECK_EQUAL(partition_table_reader.get_region(), Region(0, 204800, 512));
+    BOOST_CHECK_EQUAL(partition_table_reader.get_primary_slots(), 128);
+    BOOST_CHECK(!partition_table_reader.is_gpt_undersized());
+    BOOST_CHECK(!partition_table_reader.is_gpt_backup_broken());
+    BOOST_CHECK(!partition_table_reader.is_gpt_pmbr_boot());
+
+    const vector<CmdParted::Entry>& entries = partition_table_reader.get_entries();
+    BOOST_REQUIRE_EQUAL(entries.size(), 2);
+
+    BOOST_CHECK_EQUAL(entries[0].number, 1);
+    BOOST_CHECK_EQUAL(entries[0].region, Region(2048, 2048, 512));
+    BOOST_CHECK_EQUAL(entries[0].id, ID_ESP);
+    BOOST_CHECK_EQUAL(entries[0].name, "EFI");
+    BOOST_CHECK(!entries[0].legacy_boot);
+
+    BOOST_CHECK_EQUAL(entries[1].number, 2);
+    BOOST_CHECK_EQUAL(entries[1].region, Region(4096, 95905, 512));
+    BOOST_CHECK_EQUAL(entries[1].id, ID_LINUX);
+    BOOST_CHECK_EQUAL(entries[1].name, "\xc3\xa4");
+    BOOST_CHECK(entries[1].legacy_boot);
+}
+
+
+BOOST_AUTO_TEST_CASE(gpt_undersized_and_backup_broken)
+{
+    Image image("partition-table-reader", 204800 * 512);
+
+    put_mbr_entry(image.sector(0), 0, 0x80, 0xee, 1, 204799);
+
+    uint8_t array[2][128];
+    put_gpt_entries(array);
+
+    put_gpt(image, 1, 102399, 2, array);
+
+    image.write();
+
+    PartitionTableReader partition_table_reader(image.get_name());
+
+    BOOST_REQUIRE(partition_table_reader.is_supported());
+
+    BOOST_CHECK(partition_table_reader.is_gpt_undersized());
+    BOOST_CHECK(partition_table_reader.is_gpt_backup_broken());
+    BOOST_CHECK(partition_table_reader.is_gpt_pmbr_boot());
+}
+
+
+BOOST_AUTO_TEST_CASE(gpt_primary_broken)
+{
+    Image image("partition-table-reader", 204800 * 512);
+
+    put_mbr_entry(image.sector(0), 0, 0x00, 0xee, 1, 204799);
+
+    uint8_t array[2][128];
+    put_gpt_entries(array);
+
+    put_gpt(image, 1, 204799, 2, array);
+    put_gpt(image, 204799, 1, 204799 - 32, array);
+
+    image.sector(1)[60] ^= 0xff;
+
+    image.write();
+
+    PartitionTableReader partition_table_reader(image.get_name());
+
+    BOOST_CHECK(!partition_table_reader.is_supported());
+}
@@ -0,0 +1,279 @@
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <boost/test/unit_test.hpp>
+
+#include <string.h>
+
+#include "storage/SystemInfo/SignatureScanner.h"
+#include "testsuite/helpers/Image.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+SignatureScanner::Result
+scan(const Image& image)
+{
+    image.write();
+
+    return SignatureScanner::scan(image.get_name());
+}
+
+
+void
+put_uuid(uint8_t* p)
+{
+    for (int i = 0; i < 16; ++i)
+	p[i] = 0x11 * i;
+}
+
+
+const char* uuid = "00112233-4455-6677-8899-aabbccddeeff";
+
+
+void
+put_ext(Image& image, uint32_t compat, uint32_t incompat)
+{
+    uint8_t* sb = image.at(1024, 1024);
+
+    put_le16(sb + 56, 0xef53);
+    put_le32(sb + 92, compat);
+    put_le32(sb + 96, incompat);
+    put_uuid(sb + 104);
+    memcpy(sb + 120, "test", 4);
+}
+
+
+BOOST_AUTO_TEST_CASE(none)
+{
+    Image image("signature-scanner", 1024 * 1024);
+
+    SignatureScanner::Result result = scan(image);
+
+    BOOST_CHECK(result.status == SignatureScanner::Status::NONE);
+}
+
+
+BOOST_AUTO_TEST_CASE(ext2)
+{
+    Image image("signature-scanner", 1024 * 1024);
+    put_ext(image, 0x0000, 0x0002);
+
+    SignatureScanner::Result result = scan(image);
+
+    BOOST_REQUIRE(result.status == SignatureScanner::Status::FOUND);
+    BOOST_CHECK(result.entry.is_fs);
+    BOOST_CHECK(result.entry.fs_type == FsType::EXT2);
+    BOOST_CHECK_EQUAL(result.entry.fs_uuid, uuid);
+    BOOST_CHECK_EQUAL(result.entry.fs_label, "test");
+}
+
+
+BOOST_AUTO_TEST_CASE(ext4)
+{
+    Image image("signature-scanner", 1024 * 1024);
+    put_ext(image, 0x0004, 0x0002 | 0x0040);
+
+    SignatureScanner::Result result = scan(image);
+
+    BOOST_REQUIRE(result.status == SignatureScanner::Status::FOUND);
+    BOOST_CHECK(result.entry.is_fs);
+    BOOST_CHECK(result.entry.fs_type == FsType::EXT4);
+    BOOST_CHECK_EQUAL(result.entry.fs_uuid, uuid);
+    BOOST_CHECK_EQUAL(result.entry.fs_label, "test");
+    BOOST_CHECK_EQUAL(result.entry.fs_journal_uuid, "");
+}
+
+
+BOOST_AUTO_TEST_CASE(jbd)
+{
+    Image image("signature-scanner", 1024 * 1024);
+    put_ext(image, 0x0000, 0x0008);
+
+    SignatureScanner::Result result = scan(image);
+
+    BOOST_REQUIRE(result.status == SignatureScanner::Status::FOUND);
+    BOOST_CHECK(result.entry.is_journal);
+    BOOST_CHECK_EQUAL(result.entry.journal_uuid, uuid);
+}
+
+
+BOOST_AUTO_TEST_CASE(btrfs)
+{
+    Image image("signature-scanner", 1024 * 1024);
+    uint8_t* sb = image.at(64 * 1024, 4096);
+    memcpy(sb + 64, "_BHRfS_M", 8);
+    put_uuid(sb + 32);
+    put_uuid(sb + 267);
+    memcpy(sb + 299, "root", 4);
+
+    SignatureScanner::Result result = scan(image);
+
+    BOOST_REQUIRE(result.status == SignatureScanner::Status::FOUND);
+    BOOST_CHECK(result.entry.fs_type == FsType::BTRFS);
+    BOOST_CHECK_EQUAL(result.entry.fs_uuid, uuid);
+    BOOST_CHECK_EQUAL(result.entry.fs_sub_uuid, uuid);
+    BOOST_CHECK_EQUAL(result.entry.fs_label, "root");
+}
+
+
+BOOST_AUTO_TEST_CASE(xfs)
+{
+    Image image("signature-scanner", 1024 * 1024);
+    image.put(0, "XFSB", 4);
+    put_uuid(image.at(32, 16));
+    image.put(108, "data", 4);
+
+    SignatureScanner::Result result = scan(image);
+
+    BOOST_REQUIRE(result.status == SignatureScanner::Status::FOUND);
+    BOOST_CHECK(result.entry.fs_type == FsType::XFS);
+    BOOST_CHECK_EQUAL(result.entry.fs_uuid, uuid);
+    BOOST_CHECK_EQUAL(result.entry.fs_label, "data");
+}
+
+
+BOOST_AUTO_TEST_CASE(swap_v1)
+{
+    Image image("signature-scanner", 1024 * 1024);
+    put_le32(image.at(1024, 4), 1);
+    put_uuid(image.at(1036, 16));
+    image.put(1052, "swap", 4);
+    image.put(4096 - 10, "SWAPSPACE2", 10);
+
+    SignatureScanner::Result result = scan(image);
+
+    BOOST_REQUIRE(result.status == SignatureScanner::Status::FOUND);
+    BOOST_CHECK(result.entry.fs_type == FsType::SWAP);
+    BOOST_CHECK_EQUAL(result.entry.fs_uuid, uuid);
+    BOOST_CHECK_EQUAL(result.entry.fs_label, "swap");
+}
+
+
+BOOST_AUTO_TEST_CASE(luks2)
+{
+    Image image("signature-scanner", 1024 * 1024);
+    image.put(0, "LUKS\xba\xbe\x00\x02", 8);
+    image.put(24, "secret", 6);
+    image.put(168, uuid, 36);
+
+    SignatureScanner::Result result = scan(image);
+
+    BOOST_REQUIRE(result.status == SignatureScanner::Status::FOUND);
+    BOOST_CHECK(result.entry.is_luks);
+    BOOST_CHECK_EQUAL(result.entry.luks_uuid, uuid);
+    BOOST_CHECK_EQUAL(result.entry.luks_label, "secret");
+}
+
+
+BOOST_AUTO_TEST_CASE(lvm)
+{
+    Image image("signature-scanner", 1024 * 1024);
+    image.put(512, "LABELONE", 8);
+    image.put(512 + 24, "LVM2 001", 8);
+
+    SignatureScanner::Result result = scan(image);
+
+    BOOST_REQUIRE(result.status == SignatureScanner::Status::FOUND);
+    BOOST_CHECK(result.entry.is_lvm);
+}
+
+
+BOOST_AUTO_TEST_CASE(md_at_end)
+{
+    // Metadata 1.0 is located at the end, the content of the RAID starts
+    // at the beginning of the device. The RAID takes precedence.
+
+    Image image("signature-scanner", 1024 * 1024);
+    put_le32(image.at(1024 * 1024 - 8 * 1024, 4), 0xa92b4efc);
+    put_le32(image.at(1024 * 1024 - 8 * 1024 + 4, 4), 1);
+    image.put(0, "XFSB", 4);
+
+    SignatureScanner::Result result = scan(image);
+
+    BOOST_REQUIRE(result.status == SignatureScanner::Status::FOUND);
+    BOOST_CHECK(result.entry.is_md);
+}
+
+
+BOOST_AUTO_TEST_CASE(bcache)
+{
+    Image image("signature-scanner", 1024 * 1024);
+    image.put(4096 + 24, "\xc6\x85\x73\xf6\x4e\x1a\x45\xca\x82\x65\xf5\x7f\x48\xba\x6d\x81", 16);
+    put_uuid(image.at(4096 + 40, 16));
+
+    SignatureScanner::Result result = scan(image);
+
+    BOOST_REQUIRE(result.status == SignatureScanner::Status::FOUND);
+    BOOST_CHECK(result.entry.is_bcache);
+    BOOST_CHECK_EQUAL(result.entry.bcache_uuid, uuid);
+}
+
+
+BOOST_AUTO_TEST_CASE(unsure)
+{
+    // vfat is left to blkid
+
+    Image image1("signature-scanner", 1024 * 1024);
+    image1.put(0x52, "FAT32   ", 8);
+
+    BOOST_CHECK(scan(image1).status == SignatureScanner::Status::UNSURE);
+
+    // several signatures
+
+    Image image2("signature-scanner", 1024 * 1024);
+    put_ext(image2, 0x0004, 0x0002 | 0x0040);
+    image2.put(0, "XFSB", 4);
+
+    BOOST_CHECK(scan(image2).status == SignatureScanner::Status::UNSURE);
+
+    // signature next to a partition table
+
+    Image image3("signature-scanner", 1024 * 1024);
+    image3.put(0, "XFSB", 4);
+    image3.put(510, "\x55\xaa", 2);
+
+    BOOST_CHECK(scan(image3).status == SignatureScanner::Status::UNSURE);
+}
+
+
+BOOST_AUTO_TEST_CASE(fake_raid)
+{
+    // Fake RAIDs are left to blkid even with a filesystem at the
+    // beginning of the device.
+
+    const size_t size = 4 * 1024 * 1024;
+
+    const vector<pair<size_t, string>> signatures = {
+	{ size - 512, string("\x55\xaa", 2) },
+	{ size - 512, "JM" },
+	{ size - 512, "$XIDE$" },
+	{ size - 512, "\x37\xfc\x4d\x1e" },
+	{ size - 512 + 0x60, string("\x00\x00\x00\x2f", 4) },
+	{ size - 2 * 512, "NVIDIA" },
+	{ size - 11 * 512 + 32, "\xf3\x16\x78\x5a" },
+	{ 9 * 512 + 32, "\xf0\x16\x78\x5a" },
+	{ size - 63 * 512, "Promise Technology, Inc." },
+	{ size - 3087 * 512, "Promise Technology, Inc." },
+    };
+
+    for (const pair<size_t, string>& signature : signatures)
+    {
+	Image image("signature-scanner", size);
+	put_ext(image, 0x0004, 0x0002 | 0x0040);
+	image.put(signature.first, signature.second.data(), signature.second.size());
+
+	BOOST_CHECK_MESSAGE(scan(image).status == SignatureScanner::Status::UNSURE,
+			    "signature at " << signature.first);
+    }
+
+    // Without any fake RAID signature ext4 is found.
+
+    Image image("signature-scanner", size);
+    put_ext(image, 0x0004, 0x0002 | 0x0040);
+
+    BOOST_CHECK(scan(image).status == SignatureScanner::Status::FOUND);
+}
@@ -0,0 +1,278 @@
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <boost/test/unit_test.hpp>
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <ftw.h>
+#include <sys/stat.h>
+#include <fstream>
+
+#include "storage/SystemInfo/SystemInfoImpl.h"
+#include "storage/SystemInfo/SysfsScanner.h"
+#include "storage/Devices/DiskImpl.h"
+#include "storage/Devices/PartitionImpl.h"
+#include "storage/Devices/PartitionTable.h"
+#include "storage/Utils/AppUtil.h"
+#include "storage/Utils/Mockup.h"
+#include "storage/Utils/StorageDefines.h"
+#include "storage/Environment.h"
+#include "storage/Storage.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+const string sda_path = "/devices/pci0000:00/0000:00:1f.2/ata1/host0/target0:0:0/0:0:0:0/block/sda";
+const string sda1_path = sda_path + "/sda1";
+
+
+/**
+ * Fake sysfs with the disk sda and its partition sda1, which is used by
+ * dm-0, and fake device nodes below a temporary directory.
+ */
+class FakeSysfs
+{
+public:
+
+    FakeSysfs()
+	: root(make_root())
+    {
+	make_dirs(SYSFS_DIR "/block");
+	make_dirs(SYSFS_DIR "/class/block");
+	make_dirs(DEV_DIR);
+
+	make_link(SYSFS_DIR "/block/sda", "../devices" + sda_path.substr(strlen("/devices")));
+	make_link(SYSFS_DIR "/class/block/sda", "../.." + sda_path);
+	make_link(SYSFS_DIR "/class/block/sda1", "../.." + sda1_path);
+
+	make_dirs(SYSFS_DIR + sda_path + "/queue");
+	make_dirs(SYSFS_DIR + sda_path + "/holders");
+
+	make_file(SYSFS_DIR + sda_path + "/size", "2097152\n");
+	make_file(SYSFS_DIR + sda_path + "/ro", "0\n");
+	make_file(SYSFS_DIR + sda_path + "/ext_range", "256\n");
+	make_file(SYSFS_DIR + sda_path + "/alignment_offset", "0\n");
+	make_file(SYSFS_DIR + sda_path + "/queue/rotational", "1\n");
+	make_file(SYSFS_DIR + sda_path + "/queue/dax", "0\n");
+	make_file(SYSFS_DIR + sda_path + "/queue/zoned", "none\n");
+	make_file(SYSFS_DIR + sda_path + "/queue/logical_block_size", "4096\n");
+	make_file(SYSFS_DIR + sda_path + "/queue/optimal_io_size", "0\n");
+
+	make_dirs(SYSFS_DIR + sda1_path + "/holders");
+
+	make_file(SYSFS_DIR + sda1_path + "/size", "1048576\n");
+	make_file(SYSFS_DIR + sda1_path + "/ro", "1\n");
+	make_file(SYSFS_DIR + sda1_path + "/alignment_offset", "512\n");
+	make_file(SYSFS_DIR + sda1_path + "/holders/dm-0", "");
+
+	make_file(DEV_DIR "/sda", "");
+	make_file(DEV_DIR "/sda1", "");
+    }
+
+    ~FakeSysfs()
+    {
+	nftw(root.c_str(), remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+    }
+
+    const string root;
+
+private:
+
+    static string
+    make_root()
+    {
+	char tmp[] = "/tmp/libstorage-sysfs-XXXXXX";
+	if (!mkdtemp(tmp))
+	    throw runtime_error("mkdtemp failed");
+
+	return tmp;
+    }
+
+    void
+    make_dirs(const string& path) const
+    {
+	for (string::size_type pos = 1; pos != string::npos; )
+	{
+	    pos = path.find('/', pos + 1);
+	    mkdir((root + path.substr(0, pos)).c_str(), 0755);
+	}
+    }
+
+    void
+    make_link(const string& path, const string& target) const
+    {
+	if (symlink(target.c_str(), (root + path).c_str()) != 0)
+	    throw runtime_error("symlink failed");
+    }
+
+    void
+    make_file(const string& path, const string& content) const
+    {
+	ofstream s(root + path);
+	s << content;
+    }
+
+    static int
+    remove_entry(const char* path, const struct stat*, int, struct FTW*)
+    {
+	return remove(path);
+    }
+
+};
+
+
+/**
+ * Scans the fake sysfs and fills the caches of system_info in the given
+ * mockup mode. udevadm settle is the only command run.
+ */
+void
+scan(const FakeSysfs& fake_sysfs, SystemInfo::Impl& system_info, Mockup::Mode mode)
+{
+    Mockup::set_mode(Mockup::Mode::PLAYBACK);
+    Mockup::set_command({ UDEVADM_BIN_SETTLE }, {});
+
+    Udevadm udevadm;
+
+    const SysfsScanner sysfs_scanner(udevadm, fake_sysfs.root);
+
+    BOOST_CHECK_EQUAL(sysfs_scanner.get_block_entries().size(), 1);
+    BOOST_CHECK_EQUAL(sysfs_scanner.get_entries().size(), 2);
+
+    Mockup::set_mode(mode);
+
+    system_info.prefetchSysfs(sysfs_scanner);
+
+    Mockup::set_mode(Mockup::Mode::PLAYBACK);
+}
+
+
+BOOST_AUTO_TEST_CASE(lookups)
+{
+    // After scanning, the lookups of the prober, of BlkDevice::Impl and
+    // its subclasses and of has_kernel_holders() hit the cache. Otherwise
+    // they would throw since the mockup has no files.
+
+    FakeSysfs fake_sysfs;
+
+    SystemInfo::Impl system_info;
+
+    scan(fake_sysfs, system_info, Mockup::Mode::PLAYBACK);
+
+    Mockup::set_command({ UDEVADM_BIN, "info", "/dev/sda" }, RemoteCommand({
+	"P: " + sda_path, "N: sda", "E: DEVTYPE=disk"
+    }, {}, 0));
+
+    Mockup::set_command({ UDEVADM_BIN, "info", "/dev/sda1" }, RemoteCommand({
+	"P: " + sda1_path, "N: sda1", "E: DEVTYPE=partition"
+    }, {}, 0));
+
+    // see probe_sys_block_entries()
+
+    const Dir& block_dir = system_info.getDir(SYSFS_DIR "/block");
+    BOOST_CHECK(vector<string>(block_dir.begin(), block_dir.end()) == vector<string>({ "sda" }));
+
+    BOOST_CHECK(system_info.getCmdStat(DEV_DIR "/sda").is_reg());
+    BOOST_CHECK(system_info.getCmdStat(DEV_DIR "/sda1").is_reg());
+
+    BOOST_CHECK_EQUAL(system_info.getFile(SYSFS_DIR + system_info.getCmdUdevadmInfo(DEV_DIR "/sda").get_path() +
+					  "/ext_range").get<int>(), 256);
+
+    // see BlkDevice::Impl and its subclasses
+
+    Environment environment(true, ProbeMode::NONE, TargetMode::DIRECT);
+
+    Storage storage(environment);
+
+    Devicegraph* staging = storage.get_staging();
+
+    Disk* sda = Disk::create(staging, DEV_DIR "/sda");
+    sda->get_impl().set_sysfs_path(sda_path);
+
+    Partition* sda1 = sda->create_partition_table(PtType::GPT)->create_partition(DEV_DIR "/sda1",
+				Region(2048, 2048, 512), PartitionType::PRIMARY);
+    sda1->get_impl().set_sysfs_path(sda1_path);
+
+    const Disk::Impl& sda_impl = sda->get_impl();
+
+    BOOST_CHECK_EQUAL(sda_impl.get_sysfs_file(system_info, "size").get<unsigned long long>(), 2097152);
+    BOOST_CHECK_EQUAL(sda_impl.get_sysfs_file(system_info, "ro").get<bool>(), false);
+    BOOST_CHECK_EQUAL(sda_impl.get_sysfs_file(system_info, "ext_range").get<int>(), 256);
+    BOOST_CHECK_EQUAL(sda_impl.get_sysfs_file(system_info, "alignment_offset").get<long>(), 0);
+    BOOST_CHECK_EQUAL(sda_impl.get_sysfs_file(system_info, "queue/rotational").get<bool>(), true);
+    BOOST_CHECK_EQUAL(sda_impl.get_sysfs_file(system_info, "queue/dax").get<bool>(), false);
+    BOOST_CHECK_EQUAL(sda_impl.get_sysfs_file(system_info, "queue/zoned").get<string>(), "none");
+    BOOST_CHECK_EQUAL(sda_impl.get_sysfs_file(system_info, "queue/logical_block_size").get<unsigned long>(), 4096);
+    BOOST_CHECK_EQUAL(sda_impl.get_sysfs_file(system_info, "queue/optimal_io_size").get<unsigned long>(), 0);
+
+    const Partition::Impl& sda1_impl = sda1->get_impl();
+
+    BOOST_CHECK_EQUAL(sda1_impl.get_sysfs_file(system_info, "size").get<unsigned long long>(), 1048576);
+    BOOST_CHECK_EQUAL(sda1_impl.get_sysfs_file(system_info, "ro").get<bool>(), true);
+    BOOST_CHECK_EQUAL(sda1_impl.get_sysfs_file(system_info, "alignment_offset").get<long>(), 512);
+
+    // see has_kernel_holders()
+
+    BOOST_CHECK(!has_kernel_holders(DEV_DIR "/sda", system_info));
+    BOOST_CHECK(has_kernel_holders(DEV_DIR "/sda1", system_info));
+
+    Mockup::erase_command(UDEVADM_BIN " info /dev/sda");
+    Mockup::erase_command(UDEVADM_BIN " info /dev/sda1");
+    Mockup::erase_command(UDEVADM_BIN " settle --timeout=20");
+}
+
+
+BOOST_AUTO_TEST_CASE(keys)
+{
+    // The objects put into the caches record themselves in the mockup
+    // under their keys. Check that these are exactly the keys looked up.
+
+    FakeSysfs fake_sysfs;
+
+    SystemInfo::Impl system_info;
+
+    scan(fake_sysfs, system_info, Mockup::Mode::RECORD);
+
+    const vector<string> files = {
+	SYSFS_DIR + sda_path + "/size", SYSFS_DIR + sda_path + "/ro", SYSFS_DIR + sda_path + "/ext_range",
+	SYSFS_DIR + sda_path + "/alignment_offset", SYSFS_DIR + sda_path + "/queue/rotational",
+	SYSFS_DIR + sda_path + "/queue/dax", SYSFS_DIR + sda_path + "/queue/zoned",
+	SYSFS_DIR + sda_path + "/queue/logical_block_size", SYSFS_DIR + sda_path + "/queue/optimal_io_size",
+	SYSFS_DIR + sda1_path + "/size", SYSFS_DIR + sda1_path + "/ro", SYSFS_DIR + sda1_path + "/alignment_offset"
+    };
+
+    for (const string& file : files)
+    {
+	BOOST_CHECK_MESSAGE(Mockup::has_file(file), "missing file " << file);
+	Mockup::erase_file(file);
+    }
+
+    const vector<string> commands = {
+	LS_BIN " -1 --sort=none " SYSFS_DIR "/block",
+	LS_BIN " -1 --sort=none " SYSFS_DIR + sda_path + "/holders",
+	LS_BIN " -1 --sort=none " SYSFS_DIR + sda1_path + "/holders",
+	STAT_BIN " --format %f " DEV_DIR "/sda",
+	STAT_BIN " --format %f " DEV_DIR "/sda1",
+	UDEVADM_BIN " settle --timeout=20"
+    };
+
+    for (const string& command : commands)
+    {
+	BOOST_CHECK_MESSAGE(Mockup::has_command(command), "missing command " << command);
+	Mockup::erase_command(command);
+    }
+
+    // nothing else is left
+
+    const string filename = fake_sysfs.root + "/mockup.xml";
+
+    Mockup::save(filename);
+
+    ifstream s(filename);
+    const string content((istreambuf_iterator<char>(s)), istreambuf_iterator<char>());
+
+    BOOST_CHECK_MESSAGE(content.find("<name>") == string::npos, content);
+}
@@ -4,6 +4,7 @@
 
 #include <boost/test/unit_test.hpp>
 #include <boost/algorithm/string.hpp>
+#include <thread>
 
 #include "storage/SystemInfo/SystemInfoImpl.h"
 #include "storage/Utils/Mockup.h"
@@ -34,3 +35,50 @@ BOOST_AUTO_TEST_CASE(exception1)
 
     BOOST_CHECK_THROW({ system_info.getParted("/dev/sda"); }, ParseException);
 }
+
+
+BOOST_AUTO_TEST_CASE(concurrent1)
+{
+    // Check that several threads can use the cache at the same time and that
+    // all of them get the same object for a key.
+
+    Mockup::set_mode(Mockup::Mode::PLAYBACK);
+
+    vector<string> names;
+
+    for (int i = 0; i < 50; ++i)
+    {
+	string name = "/dev/vd" + to_string(i);
+	names.push_back(name);
+
+	Mockup::set_command({ STAT_BIN, "--format", "%f", name }, RemoteCommand({ "61b0" }, {}, 0));
+    }
+
+    SystemInfo::Impl system_info;
+
+    vector<vector<const CmdStat*>> results(8, vector<const CmdStat*>(names.size()));
+
+    vector<thread> threads;
+
+    for (size_t t = 0; t < results.size(); ++t)
+    {
+	threads.emplace_back([&system_info, &names, &results, t]() {
+	    for (size_t i = 0; i < names.size(); ++i)
+	    {
+		size_t j = (i + t * 7) % names.size();
+		results[t][j] = &system_info.getCmdStat(names[j]);
+	    }
+	});
+    }
+
+    for (thread& thread : threads)
+	thread.join();
+
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+	BOOST_CHECK(results[0][i]->is_blk());
+
+	for (size_t t = 1; t < results.size(); ++t)
+	    BOOST_CHECK_EQUAL(results[t][i], results[0][i]);
+    }
+}
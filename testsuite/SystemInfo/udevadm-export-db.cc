@@ -0,0 +1,85 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <boost/test/unit_test.hpp>
+#include <boost/algorithm/string.hpp>
+
+#include "storage/SystemInfo/CmdUdevadm.h"
+#include "storage/Utils/Mockup.h"
+#include "storage/Utils/SystemCmd.h"
+#include "storage/Utils/StorageDefines.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+void
+check(const vector<string>& input, const vector<string>& output)
+{
+    Mockup::set_mode(Mockup::Mode::PLAYBACK);
+    Mockup::set_command({ UDEVADM_BIN_SETTLE }, {});
+    Mockup::set_command({ UDEVADM_BIN, "info", "--export-db" }, input);
+
+    Udevadm udevadm;
+
+    CmdUdevadmExportDb cmd_udevadm_export_db(udevadm);
+
+    ostringstream parsed;
+    parsed.setf(std::ios::boolalpha);
+    for (const CmdUdevadmInfo& cmd_udevadm_info : cmd_udevadm_export_db.get_infos())
+	parsed << cmd_udevadm_info;
+
+    string lhs = parsed.str();
+    string rhs = boost::join(output, "\n") + "\n";
+
+    BOOST_CHECK_EQUAL(lhs, rhs);
+}
+
+
+BOOST_AUTO_TEST_CASE(parse1)
+{
+    vector<string> input = {
+	"P: /devices/LNXSYSTM:00/LNXPWRBN:00",
+	"E: DEVPATH=/devices/LNXSYSTM:00/LNXPWRBN:00",
+	"E: DRIVER=button",
+	"E: SUBSYSTEM=acpi",
+	"",
+	"P: /devices/pci0000:00/0000:00:1f.2/ata1/host0/target0:0:0/0:0:0:0/block/sda",
+	"N: sda",
+	"S: disk/by-id/wwn-0x50014ee203733bb5",
+	"S: disk/by-path/pci-0000:00:1f.2-ata-1",
+	"E: DEVNAME=/dev/sda",
+	"E: DEVTYPE=disk",
+	"E: MAJOR=8",
+	"E: MINOR=0",
+	"E: SUBSYSTEM=block",
+	"",
+	"P: /devices/pci0000:00/0000:00:1f.2/ata1/host0/target0:0:0/0:0:0:0/block/sda/sda1",
+	"N: sda1",
+	"S: disk/by-id/wwn-0x50014ee203733bb5-part1",
+	"S: disk/by-uuid/14875716-b8e3-4c83-ac86-48c20682b63a",
+	"E: DEVNAME=/dev/sda1",
+	"E: DEVTYPE=partition",
+	"E: MAJOR=8",
+	"E: MINOR=1",
+	"E: SUBSYSTEM=block",
+	"",
+	"P: /devices/virtual/bdi/8:0",
+	"E: SUBSYSTEM=bdi",
+	"",
+	"P: /devices/pci0000:00/0000:00:1f.2/ata1/host0/target0:0:0/0:0:0:0/bsg/0:0:0:0",
+	"N: bsg/0:0:0:0",
+	"E: MAJOR=250",
+	"E: MINOR=0",
+	"E: SUBSYSTEM=bsg",
+	""
+    };
+
+    vector<string> output = {
+	"file:/dev/sda path:/devices/pci0000:00/0000:00:1f.2/ata1/host0/target0:0:0/0:0:0:0/block/sda name:sda majorminor:8:0 device-type:disk by-path-links:<pci-0000:00:1f.2-ata-1> by-id-links:<wwn-0x50014ee203733bb5>",
+	"file:/dev/sda1 path:/devices/pci0000:00/0000:00:1f.2/ata1/host0/target0:0:0/0:0:0:0/block/sda/sda1 name:sda1 majorminor:8:1 device-type:partition by-id-links:<wwn-0x50014ee203733bb5-part1> by-uuid-links:<14875716-b8e3-4c83-ac86-48c20682b63a>"
+    };
+
+    check(input, output);
+}
@@ -0,0 +1,104 @@
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <boost/test/unit_test.hpp>
+
+#include <set>
+#include <boost/graph/adjacency_list.hpp>
+
+#include "storage/Utils/GraphUtils.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+typedef boost::adjacency_list<boost::listS, boost::listS, boost::bidirectionalS,
+			      boost::property<boost::vertex_index_t, size_t, int>> graph_t;
+
+typedef graph_t::vertex_descriptor vertex_descriptor;
+
+
+void
+check_dense(const graph_t& graph)
+{
+    set<size_t> indexes;
+
+    for (vertex_descriptor vertex : boost::make_iterator_range(boost::vertices(graph)))
+    {
+	size_t index = boost::get(boost::vertex_index, graph, vertex);
+	BOOST_CHECK_LT(index, boost::num_vertices(graph));
+	indexes.insert(index);
+    }
+
+    BOOST_CHECK_EQUAL(indexes.size(), boost::num_vertices(graph));
+}
+
+
+BOOST_AUTO_TEST_CASE(dense_vertex_index)
+{
+    graph_t graph;
+    DenseVertexIndex<graph_t> dense_vertex_index;
+
+    vector<vertex_descriptor> vertices;
+
+    for (int i = 0; i < 10; ++i)
+    {
+	vertex_descriptor vertex = boost::add_vertex(graph_t::vertex_property_type(0, i), graph);
+	dense_vertex_index.add(graph, vertex);
+	vertices.push_back(vertex);
+    }
+
+    check_dense(graph);
+
+    // remove the first, a middle and the last vertex
+
+    for (size_t i : { 0, 5, 9 })
+    {
+	dense_vertex_index.remove(graph, vertices[i]);
+	boost::remove_vertex(vertices[i], graph);
+
+	check_dense(graph);
+    }
+
+    BOOST_CHECK_EQUAL(boost::num_vertices(graph), 7);
+
+    vertex_descriptor vertex = boost::add_vertex(graph_t::vertex_property_type(0, 10), graph);
+    dense_vertex_index.add(graph, vertex);
+
+    BOOST_CHECK_EQUAL(boost::get(boost::vertex_index, graph, vertex), 7);
+
+    check_dense(graph);
+}
+
+
+BOOST_AUTO_TEST_CASE(bfs_with_dense_vertex_index)
+{
+    graph_t graph;
+    DenseVertexIndex<graph_t> dense_vertex_index;
+
+    vector<vertex_descriptor> vertices;
+
+    for (int i = 0; i < 4; ++i)
+    {
+	vertex_descriptor vertex = boost::add_vertex(graph_t::vertex_property_type(0, i), graph);
+	dense_vertex_index.add(graph, vertex);
+	vertices.push_back(vertex);
+    }
+
+    boost::add_edge(vertices[0], vertices[1], graph);
+    boost::add_edge(vertices[1], vertices[2], graph);
+    boost::add_edge(vertices[1], vertices[3], graph);
+
+    dense_vertex_index.remove(graph, vertices[0]);
+    boost::clear_vertex(vertices[0], graph);
+    boost::remove_vertex(vertices[0], graph);
+
+    vector<vertex_descriptor> result;
+    VertexRecorder<vertex_descriptor> vertex_recorder(true, result);
+
+    boost::breadth_first_search(graph, vertices[1], boost::visitor(vertex_recorder));
+
+    BOOST_CHECK_EQUAL(result.size(), 2);
+}
@@ -49,6 +49,18 @@ BOOST_AUTO_TEST_CASE(good3)
 }
 
 
+BOOST_AUTO_TEST_CASE(good4)
+{
+    string_view data = "{\n  \"device\" : \"/dev/sda\"\n}\n";
+
+    JsonFile json_file(data);
+
+    string tmp;
+    BOOST_CHECK(get_child_value(json_file.get_root(), "device", tmp));
+    BOOST_CHECK_EQUAL(tmp, "/dev/sda");
+}
+
+
 BOOST_AUTO_TEST_CASE(bad1)
 {
     vector<string> lines = {
@@ -3,6 +3,10 @@
 #define BOOST_TEST_MODULE libstorage
 
 #include <boost/test/unit_test.hpp>
+#include <boost/algorithm/string.hpp>
+#include <fstream>
+#include <iomanip>
+#include <unistd.h>
 
 #include "storage/Utils/LoggerImpl.h"
 
@@ -56,7 +60,7 @@ BOOST_AUTO_TEST_CASE(logger1)
 
     BOOST_CHECK(recorder.entries[0].log_level == LogLevel::MILESTONE);
     BOOST_CHECK_EQUAL(recorder.entries[0].file, "logger.cc");
-    BOOST_CHECK_EQUAL(recorder.entries[0].line, 53);
+    BOOST_CHECK_EQUAL(recorder.entries[0].line, 57);
     BOOST_CHECK_EQUAL(recorder.entries[0].content, "milestone");
 }
 
@@ -157,3 +161,54 @@ BOOST_AUTO_TEST_CASE(conditional_expansion)
     BOOST_CHECK_EQUAL(n_mil, 1);
     BOOST_CHECK_EQUAL(n_deb, 0);
 }
+
+
+BOOST_AUTO_TEST_CASE(stream_reuse)
+{
+    Recorder recorder;
+
+    set_logger(&recorder);
+
+    y2mil(std::hex << 255 << " " << std::setw(5) << std::setfill('*') << 1);
+    y2mil(255 << " " << std::setw(3) << 1 << " " << true);
+
+    BOOST_REQUIRE_EQUAL(recorder.entries.size(), 2);
+
+    BOOST_CHECK_EQUAL(recorder.entries[0].content, "0xff **0x1");
+    BOOST_CHECK_EQUAL(recorder.entries[1].content, "255   1 true");
+}
+
+
+BOOST_AUTO_TEST_CASE(buffered_logfile)
+{
+    char filename[] = "/tmp/logger-XXXXXX";
+    int fd = mkstemp(filename);
+    BOOST_REQUIRE(fd >= 0);
+    close(fd);
+
+    set_logger(get_buffered_logfile_logger(filename));
+
+    y2mil("hello");
+    y2war("world\nagain");
+
+    flush_logger();
+
+    set_logger(nullptr);
+
+    vector<string> lines;
+
+    ifstream s(filename);
+    string line;
+    while (getline(s, line))
+	lines.push_back(line);
+
+    BOOST_REQUIRE_EQUAL(lines.size(), 3);
+
+    BOOST_CHECK(boost::contains(lines[0], " <1> [libstorage] logger.cc("));
+    BOOST_CHECK(boost::ends_with(lines[0], " hello"));
+    BOOST_CHECK(boost::contains(lines[1], " <2> [libstorage] logger.cc("));
+    BOOST_CHECK(boost::ends_with(lines[1], " world"));
+    BOOST_CHECK(boost::ends_with(lines[2], " again"));
+
+    unlink(filename);
+}
@@ -86,6 +86,38 @@ BOOST_AUTO_TEST_CASE(hello_huge_stdout_args)
 }
 
 
+BOOST_AUTO_TEST_CASE(hello_contiguous_stdout_args)
+{
+    SystemCmd::Options cmd_options({ "../helpers/echoargs", "hello world", "stdout" });
+    cmd_options.contiguous_stdout = true;
+
+    SystemCmd cmd(cmd_options);
+
+    BOOST_CHECK(cmd.stdout().empty());
+    BOOST_CHECK_EQUAL(cmd.stdout_buffer(), "stdout #1: hello world\nstdout #2: stdout\n");
+
+    BOOST_REQUIRE_EQUAL(cmd.stdout_line_views().size(), 2);
+    BOOST_CHECK_EQUAL(cmd.stdout_line_views()[0], "stdout #1: hello world");
+    BOOST_CHECK_EQUAL(cmd.stdout_line_views()[1], "stdout #2: stdout");
+}
+
+
+BOOST_AUTO_TEST_CASE(hello_huge_contiguous_stdout_args)
+{
+    string stdout;
+    for (int i = 0; i < 1000000; ++i)
+	stdout += "Hello world, how are you?\n";
+
+    SystemCmd::Options cmd_options({ "../helpers/repeat", "1000000", "Hello world, how are you?" });
+    cmd_options.contiguous_stdout = true;
+
+    SystemCmd cmd(cmd_options);
+
+    BOOST_CHECK(cmd.stdout_buffer() == stdout);
+    BOOST_CHECK_EQUAL(cmd.stdout_line_views().size(), 1000000);
+}
+
+
 BOOST_AUTO_TEST_CASE(hello_stderr)
 {
     vector<string> stderr = {
@@ -373,3 +405,75 @@ BOOST_AUTO_TEST_CASE(fault_poll)
 
 #endif
 }
+
+
+class PosixSpawnGuard
+{
+public:
+
+    PosixSpawnGuard() { setenv("LIBSTORAGE_POSIX_SPAWN", "yes", 1); }
+    ~PosixSpawnGuard() { unsetenv("LIBSTORAGE_POSIX_SPAWN"); }
+
+};
+
+
+BOOST_AUTO_TEST_CASE(posix_spawn_hello)
+{
+    PosixSpawnGuard posix_spawn_guard;
+
+    vector<string> stdout = {
+	"stdout #1: hello world",
+	"stdout #2: stdout"
+    };
+
+    SystemCmd cmd1("../helpers/echoargs 'hello world' stdout");
+
+    BOOST_CHECK_EQUAL(join(cmd1.stdout()), join(stdout));
+    BOOST_CHECK_EQUAL(cmd1.retcode(), 0);
+
+    SystemCmd cmd2({ "../helpers/echoargs", "hello world", "stdout" });
+
+    BOOST_CHECK_EQUAL(join(cmd2.stdout()), join(stdout));
+    BOOST_CHECK_EQUAL(cmd2.retcode(), 0);
+
+    SystemCmd cmd3({ "../helpers/retcode", "42" });
+
+    BOOST_CHECK_EQUAL(cmd3.retcode(), 42);
+}
+
+
+BOOST_AUTO_TEST_CASE(posix_spawn_non_existent)
+{
+    PosixSpawnGuard posix_spawn_guard;
+
+    BOOST_CHECK_NO_THROW({
+	SystemCmd cmd({ "/bin/wrglbrmpf" }, SystemCmd::ThrowBehaviour::NoThrow);
+	BOOST_CHECK_EQUAL(cmd.retcode(), 127);
+    });
+
+    BOOST_CHECK_THROW({ SystemCmd cmd({ "/bin/wrglbrmpf" }, SystemCmd::ThrowBehaviour::DoThrow); },
+		      CommandNotFoundException);
+}
+
+
+BOOST_AUTO_TEST_CASE(posix_spawn_close_fds)
+{
+    PosixSpawnGuard posix_spawn_guard;
+
+    const int n = num_open_fds();
+
+    // a file descriptor without CLOEXEC must not be passed to the child
+    int fd = open("/dev/null", O_RDONLY);
+    BOOST_REQUIRE(fd >= 0);
+
+    SystemCmd cmd({ LS_BIN, "-1", "/proc/self/fd/" });
+
+    close(fd);
+
+    BOOST_CHECK_EQUAL(cmd.retcode(), 0);
+
+    // stdin, stdout, stderr and an fd resulting from the opendir in ls
+    BOOST_CHECK_EQUAL(cmd.stdout().size(), 4);
+
+    BOOST_CHECK_EQUAL(num_open_fds(), n);
+}
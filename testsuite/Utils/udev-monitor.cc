@@ -0,0 +1,220 @@
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <boost/test/unit_test.hpp>
+
+#include <unistd.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <string.h>
+
+#include "storage/Utils/Udev.h"
+#include "storage/Utils/Stopwatch.h"
+#include "storage/Utils/LoggerImpl.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+/**
+ * UdevMonitor reading from one end of a socket pair so that no messages
+ * arrive. The messages are fed to process() directly.
+ */
+class TestUdevMonitor : public UdevMonitor
+{
+public:
+
+    TestUdevMonitor(chrono::milliseconds timeout)
+	: TestUdevMonitor(make_sockets(), timeout)
+    {
+    }
+
+    ~TestUdevMonitor()
+    {
+	close(other);
+    }
+
+    void
+    process(const string& message, bool from_kernel)
+    {
+	UdevMonitor::process(message.data(), message.size(), from_kernel);
+    }
+
+    using UdevMonitor::wait;
+    using UdevMonitor::pending;
+
+private:
+
+    TestUdevMonitor(pair<int, int> fds, chrono::milliseconds timeout)
+	: UdevMonitor(fds.first, timeout), other(fds.second)
+    {
+    }
+
+    static pair<int, int>
+    make_sockets()
+    {
+	int fds[2];
+	if (socketpair(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, fds) != 0)
+	    throw runtime_error("socketpair failed");
+
+	return make_pair(fds[0], fds[1]);
+    }
+
+    const int other;
+
+};
+
+
+const string sda = "/devices/pci0000:00/0000:00:1f.2/ata1/host0/target0:0:0/0:0:0:0/block/sda";
+const string sdb = "/devices/pci0000:00/0000:00:1f.2/ata2/host1/target1:0:0/1:0:0:0/block/sdb";
+
+
+string
+properties(const string& devpath, unsigned long long seqnum)
+{
+    return string("ACTION=change") + '\0' + "DEVPATH=" + devpath + '\0' + "SUBSYSTEM=block" + '\0' +
+	"SEQNUM=" + to_string(seqnum) + '\0';
+}
+
+
+string
+kernel_message(const string& devpath, unsigned long long seqnum)
+{
+    return "change@" + devpath + '\0' + properties(devpath, seqnum);
+}
+
+
+/**
+ * Message as sent by udev, see monitor_netlink_header in systemd.
+ */
+string
+udev_message(const string& devpath, unsigned long long seqnum, uint32_t magic = 0xfeedcafe)
+{
+    const string tmp = properties(devpath, seqnum);
+
+    uint32_t header[10] = {};
+    memcpy(header, "libudev", 8);
+    header[2] = htonl(magic);
+    header[3] = sizeof(header);
+    header[4] = sizeof(header);
+    header[5] = tmp.size();
+
+    return string((const char*)(header), sizeof(header)) + tmp;
+}
+
+
+BOOST_AUTO_TEST_CASE(valid)
+{
+    set_logger(get_stdout_logger());
+
+    TestUdevMonitor udev_monitor(chrono::milliseconds(100));
+
+    udev_monitor.process(kernel_message(sda, 10), true);
+    udev_monitor.process(kernel_message(sdb, 11), true);
+
+    BOOST_CHECK_EQUAL(udev_monitor.pending.size(), 2);
+    BOOST_CHECK_EQUAL(udev_monitor.pending[10], sda);
+
+    udev_monitor.process(udev_message(sda, 10), false);
+
+    BOOST_CHECK_EQUAL(udev_monitor.pending.size(), 1);
+    BOOST_CHECK_EQUAL(udev_monitor.pending.count(11), 1);
+}
+
+
+BOOST_AUTO_TEST_CASE(truncated)
+{
+    set_logger(get_stdout_logger());
+
+    TestUdevMonitor udev_monitor(chrono::milliseconds(100));
+
+    udev_monitor.process(kernel_message(sda, 10), true);
+
+    const string message = udev_message(sda, 10);
+
+    // shorter than the header
+
+    udev_monitor.process(message.substr(0, 20), false);
+
+    BOOST_CHECK_EQUAL(udev_monitor.pending.size(), 1);
+
+    // properties exceed the message
+
+    udev_monitor.process(message.substr(0, message.size() - 5), false);
+
+    BOOST_CHECK_EQUAL(udev_monitor.pending.size(), 1);
+
+    // kernel message without properties and without '@'
+
+    udev_monitor.process("change", true);
+
+    BOOST_CHECK_EQUAL(udev_monitor.pending.size(), 1);
+}
+
+
+BOOST_AUTO_TEST_CASE(wrong_magic)
+{
+    set_logger(get_stdout_logger());
+
+    TestUdevMonitor udev_monitor(chrono::milliseconds(100));
+
+    udev_monitor.process(kernel_message(sda, 10), true);
+
+    udev_monitor.process(udev_message(sda, 10, 0xcafefeed), false);
+
+    BOOST_CHECK_EQUAL(udev_monitor.pending.size(), 1);
+
+    string message = udev_message(sda, 10);
+    message[0] = 'x';
+    udev_monitor.process(message, false);
+
+    BOOST_CHECK_EQUAL(udev_monitor.pending.size(), 1);
+}
+
+
+BOOST_AUTO_TEST_CASE(foreign_devpath)
+{
+    set_logger(get_stdout_logger());
+
+    TestUdevMonitor udev_monitor(chrono::milliseconds(10000));
+
+    // sdb and its partition are pending but only sda is waited for
+
+    udev_monitor.process(kernel_message(sdb, 10), true);
+    udev_monitor.process(kernel_message(sdb + "/sdb1", 11), true);
+    udev_monitor.process(kernel_message(sda + "b", 12), true);
+
+    Stopwatch stopwatch;
+
+    BOOST_CHECK(udev_monitor.wait({ sda }, false));
+
+    BOOST_CHECK_LT(stopwatch.read(), 1.0);
+
+    BOOST_CHECK_EQUAL(udev_monitor.pending.size(), 3);
+}
+
+
+BOOST_AUTO_TEST_CASE(timeout)
+{
+    set_logger(get_stdout_logger());
+
+    TestUdevMonitor udev_monitor(chrono::milliseconds(100));
+
+    udev_monitor.process(kernel_message(sda, 10), true);
+    udev_monitor.process(kernel_message(sda + "/sda1", 11), true);
+    udev_monitor.process(kernel_message(sdb, 12), true);
+
+    Stopwatch stopwatch;
+
+    // udev never answers so the wait gives up after the timeout and forgets
+    // the events waited for
+
+    BOOST_CHECK(udev_monitor.wait({ sda }, false));
+
+    BOOST_CHECK_GT(stopwatch.read(), 0.09);
+
+    BOOST_CHECK_EQUAL(udev_monitor.pending.size(), 1);
+    BOOST_CHECK_EQUAL(udev_monitor.pending.count(12), 1);
+}
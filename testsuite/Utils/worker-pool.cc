@@ -0,0 +1,38 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+
+#include "storage/Utils/WorkerPool.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+BOOST_AUTO_TEST_CASE(test_no_tasks)
+{
+    run_in_worker_pool({}, 4);
+}
+
+
+BOOST_AUTO_TEST_CASE(test_all_tasks_run_once)
+{
+    for (int max_threads : { -1, 0, 1, 2, 8, 200 })
+    {
+	vector<atomic<int>> counters(100);
+	for (atomic<int>& counter : counters)
+	    counter = 0;
+
+	vector<std::function<void()>> tasks;
+	for (atomic<int>& counter : counters)
+	    tasks.push_back([&counter]() { ++counter; });
+
+	run_in_worker_pool(tasks, max_threads);
+
+	for (const atomic<int>& counter : counters)
+	    BOOST_CHECK_EQUAL(counter, 1);
+    }
+}
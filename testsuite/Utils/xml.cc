@@ -4,7 +4,11 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <stdlib.h>
+#include <unistd.h>
+
 #include "storage/Utils/XmlFile.h"
+#include "storage/Utils/BinaryXmlFile.h"
 
 
 using namespace storage;
@@ -32,3 +36,78 @@ BOOST_AUTO_TEST_CASE(load1)
     BOOST_CHECK_EQUAL(bs[2], "two");
     BOOST_CHECK_EQUAL(bs[3], "");
 }
+
+
+BOOST_AUTO_TEST_CASE(binary1)
+{
+    XmlFile xml("xml.xml");
+
+    char filename[] = "/tmp/binary-xml-XXXXXX";
+    int fd = mkstemp(filename);
+    BOOST_REQUIRE(fd >= 0);
+    close(fd);
+
+    BOOST_CHECK(!BinaryXmlFile::is_binary_xml_file("xml.xml"));
+
+    BinaryXmlFile::save_to_file(xml.getRootElement(), filename);
+
+    BOOST_CHECK(BinaryXmlFile::is_binary_xml_file(filename));
+
+    {
+	BinaryXmlFile binary_xml(filename);
+
+	const xmlNode* root_node = binary_xml.getRootElement();
+	BOOST_CHECK(root_node);
+
+	const xmlNode* a_node = getChildNode(root_node, "a");
+	BOOST_CHECK(a_node);
+
+	BOOST_CHECK_EQUAL(getChildNodes(a_node).size(), 5);
+	BOOST_CHECK_EQUAL(getChildNodes(a_node, "b").size(), 4);
+	BOOST_CHECK_EQUAL(getChildNodes(a_node, "c").size(), 1);
+
+	vector<string> bs;
+	getChildValue(a_node, "b", bs);
+	BOOST_CHECK_EQUAL(bs.size(), 4);
+	BOOST_CHECK_EQUAL(bs[0], "one");
+	BOOST_CHECK_EQUAL(bs[1], "");
+	BOOST_CHECK_EQUAL(bs[2], "two");
+	BOOST_CHECK_EQUAL(bs[3], "");
+
+	string c;
+	BOOST_CHECK(getChildValue(a_node, "c", c));
+	BOOST_CHECK_EQUAL(c, "three");
+    }
+
+    unlink(filename);
+}
+
+
+BOOST_AUTO_TEST_CASE(integers)
+{
+    XmlFile xml;
+
+    xmlNode* root_node = xmlNewNode("root");
+    xml.setRootElement(root_node);
+
+    setChildValue(root_node, "a", 1234567890123ULL);
+    setChildValue(root_node, "b", -42);
+    setChildValue(root_node, "c", "0x83");
+    setChildValue(root_node, "d", "010");
+
+    unsigned long long a = 0;
+    BOOST_CHECK(getChildValue(root_node->children, "a", a));
+    BOOST_CHECK_EQUAL(a, 1234567890123ULL);
+
+    int b = 0;
+    BOOST_CHECK(getChildValue(root_node->children, "b", b));
+    BOOST_CHECK_EQUAL(b, -42);
+
+    unsigned int c = 0;
+    BOOST_CHECK(getChildValue(root_node->children, "c", c));
+    BOOST_CHECK_EQUAL(c, 0x83);
+
+    unsigned int d = 0;
+    BOOST_CHECK(getChildValue(root_node->children, "d", d));
+    BOOST_CHECK_EQUAL(d, 010);
+}
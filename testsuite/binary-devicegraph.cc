@@ -0,0 +1,84 @@
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <boost/test/unit_test.hpp>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "storage/Environment.h"
+#include "storage/Storage.h"
+#include "storage/Devicegraph.h"
+
+#include "testsuite/helpers/TsCmp.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+BOOST_AUTO_TEST_CASE(round_trip)
+{
+    set_logger(get_stdout_logger());
+
+    char filename[] = "/tmp/binary-devicegraph-XXXXXX";
+    int fd = mkstemp(filename);
+    BOOST_REQUIRE(fd >= 0);
+    close(fd);
+
+    for (const char* name : { "bcache1", "btrfs1", "dasd1", "disk-zoned1", "external-journal",
+	    "lvm-cache+thin1", "lvm-raid1", "md-imsm1", "md1", "multipath+luks1", "nfs1",
+	    "plain-encryption1", "swap1", "tmpfs1" })
+    {
+	Environment environment(true, ProbeMode::NONE, TargetMode::DIRECT);
+
+	Storage storage(environment);
+
+	Devicegraph* xml = storage.create_devicegraph("xml");
+	xml->load(string("probe/") + name + "-devicegraph.xml", true);
+	xml->save(filename, DevicegraphFormat::BINARY);
+
+	Devicegraph* binary = storage.create_devicegraph("binary");
+	binary->load(filename, true);
+	binary->check();
+
+	TsCmpDevicegraph cmp(*xml, *binary);
+	BOOST_CHECK_MESSAGE(cmp.ok(), name << " " << cmp);
+    }
+
+    unlink(filename);
+}
+
+
+BOOST_AUTO_TEST_CASE(read_devicegraph)
+{
+    char filename[] = "/tmp/binary-devicegraph-XXXXXX";
+    int fd = mkstemp(filename);
+    BOOST_REQUIRE(fd >= 0);
+    close(fd);
+
+    {
+	Environment environment(true, ProbeMode::READ_DEVICEGRAPH, TargetMode::DIRECT);
+	environment.set_devicegraph_filename("probe/md1-devicegraph.xml");
+
+	Storage storage(environment);
+	storage.probe();
+
+	storage.get_probed()->save(filename, DevicegraphFormat::BINARY);
+    }
+
+    Environment environment(true, ProbeMode::READ_DEVICEGRAPH, TargetMode::DIRECT);
+    environment.set_devicegraph_filename(filename);
+
+    Storage storage(environment);
+    storage.probe();
+
+    Devicegraph* staging = storage.get_staging();
+    staging->load("probe/md1-devicegraph.xml", true);
+
+    TsCmpDevicegraph cmp(*storage.get_probed(), *staging);
+    BOOST_CHECK_MESSAGE(cmp.ok(), cmp);
+
+    unlink(filename);
+}
@@ -0,0 +1,152 @@
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <boost/test/unit_test.hpp>
+
+#include "storage/Devices/Disk.h"
+#include "storage/Filesystems/Btrfs.h"
+#include "storage/Filesystems/BtrfsSubvolume.h"
+#include "storage/Actions/CreateImpl.h"
+#include "storage/Actions/SetNocowImpl.h"
+#include "storage/Utils/Remote.h"
+#include "storage/Utils/StorageDefines.h"
+#include "storage/Utils/Logger.h"
+#include "storage/Environment.h"
+#include "storage/Storage.h"
+#include "storage/Actiongraph.h"
+#include "storage/ActiongraphImpl.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+/**
+ * Counts the mount commands. All commands succeed without output.
+ */
+class MountCounter : public RemoteCallbacksV2
+{
+public:
+
+    virtual RemoteCommand get_command(const string& name) const override { return RemoteCommand(); }
+
+    virtual RemoteFile get_file(const string& name) const override { return RemoteFile(); }
+
+    virtual RemoteCommand get_command_v2(const vector<string>& args) const override
+    {
+	if (args.front() == MOUNT_BIN)
+	    ++mounts;
+
+	return RemoteCommand();
+    }
+
+    mutable int mounts = 0;
+
+};
+
+
+/**
+ * Sets up an existing btrfs on which three subvolumes are created, one with
+ * nocow, and a new ext4 on another disk. Devices that exist are used so that
+ * waiting for the devices returns immediately.
+ */
+const Actiongraph*
+setup(Storage& storage)
+{
+    Devicegraph* staging = storage.get_staging();
+
+    Disk* sda = Disk::create(staging, "/dev/null", Region(0, 2097152, 512));
+    Btrfs* btrfs = to_btrfs(sda->create_blk_filesystem(FsType::BTRFS));
+
+    Disk::create(staging, "/dev/zero", Region(0, 2097152, 512));
+
+    storage.remove_devicegraph("system");
+    storage.copy_devicegraph("staging", "system");
+
+    BtrfsSubvolume* top_level = btrfs->get_top_level_btrfs_subvolume();
+
+    top_level->create_btrfs_subvolume("a");
+    top_level->create_btrfs_subvolume("b");
+    top_level->create_btrfs_subvolume("c")->set_nocow(true);
+
+    Disk::find_by_name(staging, "/dev/zero")->create_blk_filesystem(FsType::EXT4);
+
+    return storage.calculate_actiongraph();
+}
+
+
+BOOST_AUTO_TEST_CASE(btrfs_subvolume_action)
+{
+    set_logger(get_stdout_logger());
+
+    Environment environment(true, ProbeMode::NONE, TargetMode::DIRECT);
+
+    Storage storage(environment);
+
+    const Actiongraph* actiongraph = setup(storage);
+    const Actiongraph::Impl& impl = actiongraph->get_impl();
+
+    // The create actions of the three subvolumes and the set nocow action
+    // are btrfs subvolume actions, creating the ext4 is not.
+
+    size_t num_btrfs_subvolume_actions = 0;
+
+    for (Actiongraph::Impl::vertex_descriptor vertex : impl.vertices())
+    {
+	const Action::Base* action = impl[vertex];
+
+	if (impl.is_btrfs_subvolume_action(action))
+	{
+	    ++num_btrfs_subvolume_actions;
+
+	    BOOST_CHECK(is_action_of_type<const Action::Create>(action) ||
+			is_action_of_type<const Action::SetNocow>(action));
+	}
+    }
+
+    BOOST_CHECK_EQUAL(num_btrfs_subvolume_actions, 4);
+    BOOST_CHECK_LT(num_btrfs_subvolume_actions, impl.num_actions());
+}
+
+
+BOOST_AUTO_TEST_CASE(shared_btrfs_mount)
+{
+    set_logger(get_stdout_logger());
+
+    Environment environment(true, ProbeMode::NONE, TargetMode::DIRECT);
+
+    Storage storage(environment);
+
+    const Actiongraph* actiongraph = setup(storage);
+    const Actiongraph::Impl& impl = actiongraph->get_impl();
+
+    const Disk* sda = Disk::find_by_name(storage.get_staging(), "/dev/null");
+    const BtrfsSubvolume* top_level = to_btrfs(sda->get_blk_filesystem())->get_top_level_btrfs_subvolume();
+
+    MountCounter mount_counter;
+    set_remote_callbacks(&mount_counter);
+
+    {
+	CommitData commit_data(impl, Tense::SIMPLE_PRESENT);
+
+	// Creating the three subvolumes uses one mount.
+
+	string mount_point = commit_data.get_btrfs_mount_point(top_level);
+
+	BOOST_CHECK_EQUAL(commit_data.get_btrfs_mount_point(top_level), mount_point);
+	BOOST_CHECK_EQUAL(commit_data.get_btrfs_mount_point(top_level), mount_point);
+
+	BOOST_CHECK_EQUAL(mount_counter.mounts, 1);
+
+	// After releasing the mount a new one is needed.
+
+	commit_data.release_btrfs_mount();
+
+	commit_data.get_btrfs_mount_point(top_level);
+
+	BOOST_CHECK_EQUAL(mount_counter.mounts, 2);
+    }
+
+    set_remote_callbacks(nullptr);
+}
@@ -0,0 +1,266 @@
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <boost/test/unit_test.hpp>
+
+#include "storage/Devices/Disk.h"
+#include "storage/Devices/Gpt.h"
+#include "storage/Devices/Partition.h"
+#include "storage/Actions/BaseImpl.h"
+#include "storage/Environment.h"
+#include "storage/Storage.h"
+#include "storage/CommitOptions.h"
+#include "storage/Actiongraph.h"
+#include "storage/ActiongraphImpl.h"
+#include "storage/Utils/Mockup.h"
+#include "storage/Utils/StorageDefines.h"
+#include "storage/Utils/Exception.h"
+#include "storage/Utils/Logger.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+/**
+ * Records the begin and end of the actions and the errors in the order
+ * they happen. The callbacks are serialized by the commit.
+ */
+class Recorder : public CommitCallbacksV2
+{
+public:
+
+    enum Type { BEGIN, END, ERROR };
+
+    struct Event
+    {
+	Type type;
+	const Action::Base* action;
+    };
+
+    Recorder(bool abort) : abort(abort) {}
+
+    virtual void message(const string& message) const override {}
+
+    virtual bool error(const string& message, const string& what) const override
+    {
+	events.push_back({ ERROR, nullptr });
+	return !abort;
+    }
+
+    virtual void begin_action(const Action::Base* action) const override
+    {
+	events.push_back({ BEGIN, action });
+    }
+
+    virtual void end_action(const Action::Base* action) const override
+    {
+	events.push_back({ END, action });
+    }
+
+    const bool abort;
+
+    mutable vector<Event> events;
+
+};
+
+
+/**
+ * Sets up two disks each with a new GPT and two partitions. The actions on
+ * one disk exclude each other while the actions on different disks can run
+ * concurrently.
+ */
+const Actiongraph*
+setup(Storage& storage)
+{
+    Devicegraph* staging = storage.get_staging();
+
+    Disk* sda = Disk::create(staging, "/dev/sda", Region(0, 10000000, 512));
+    Disk* sdb = Disk::create(staging, "/dev/sdb", Region(0, 10000000, 512));
+
+    storage.remove_devicegraph("probed");
+    storage.copy_devicegraph("staging", "probed");
+
+    storage.remove_devicegraph("system");
+    storage.copy_devicegraph("staging", "system");
+
+    for (Disk* disk : { sda, sdb })
+    {
+	Gpt* gpt = to_gpt(disk->create_partition_table(PtType::GPT));
+
+	gpt->create_partition(disk->get_name() + "1", Region(2048, 2097152, 512), PartitionType::PRIMARY);
+	gpt->create_partition(disk->get_name() + "2", Region(2099200, 2097152, 512), PartitionType::PRIMARY);
+    }
+
+    return storage.calculate_actiongraph();
+}
+
+
+void
+set_commands()
+{
+    Mockup::set_mode(Mockup::Mode::PLAYBACK);
+
+    for (const string& name : vector<string>({ "/dev/sda", "/dev/sdb" }))
+    {
+	Mockup::set_command(BLKDISCARD_BIN " --verbose " + name, RemoteCommand());
+	Mockup::set_command(PARTED_BIN " --script " + name + " mklabel gpt", RemoteCommand());
+	Mockup::set_command(PARTED_BIN " --script " + name + " unit s mkpart '' ext2 2048 2099199", RemoteCommand());
+	Mockup::set_command(PARTED_BIN " --script " + name + " unit s mkpart '' ext2 2099200 4196351", RemoteCommand());
+	Mockup::set_command(PARTED_BIN " --script " + name + " unit s print", RemoteCommand());
+	Mockup::set_command(BLKDISCARD_BIN " --verbose " + name + "1", RemoteCommand());
+	Mockup::set_command(BLKDISCARD_BIN " --verbose " + name + "2", RemoteCommand());
+	Mockup::set_command(WIPEFS_BIN " --all " + name + "1", RemoteCommand());
+	Mockup::set_command(WIPEFS_BIN " --all " + name + "2", RemoteCommand());
+
+	for (const string& number : vector<string>({ "1", "2" }))
+	{
+	    Mockup::set_command(UDEVADM_BIN " info " + name + number, RemoteCommand({
+		"P: /devices/virtual/block/" + name.substr(5) + "/" + name.substr(5) + number,
+		"N: " + name.substr(5) + number,
+		"E: DEVNAME=" + name + number
+	    }, {}, 0));
+	}
+    }
+
+    Mockup::set_command({ UDEVADM_BIN_SETTLE }, RemoteCommand());
+}
+
+
+/**
+ * Returns the positions of the begin and end of the actions in the events.
+ */
+map<const Action::Base*, pair<size_t, size_t>>
+get_intervals(const vector<Recorder::Event>& events)
+{
+    map<const Action::Base*, pair<size_t, size_t>> intervals;
+
+    for (size_t i = 0; i < events.size(); ++i)
+    {
+	const Recorder::Event& event = events[i];
+
+	if (event.type == Recorder::BEGIN)
+	    intervals[event.action] = make_pair(i, events.size());
+	else if (event.type == Recorder::END)
+	    intervals[event.action].second = i;
+    }
+
+    return intervals;
+}
+
+
+BOOST_AUTO_TEST_CASE(parallel_commit)
+{
+    setenv("LIBSTORAGE_COMMIT_THREADS", "4", 1);
+
+    set_logger(get_stdout_logger());
+
+    set_commands();
+
+    Environment environment(true, ProbeMode::NONE, TargetMode::DIRECT);
+
+    Storage storage(environment);
+
+    const Actiongraph* actiongraph = setup(storage);
+    const Actiongraph::Impl& impl = actiongraph->get_impl();
+
+    Recorder recorder(false);
+
+    CommitOptions commit_options(false);
+    storage.commit(commit_options, &recorder);
+
+    BOOST_CHECK(none_of(recorder.events.begin(), recorder.events.end(), [](const Recorder::Event& event) {
+	return event.type == Recorder::ERROR;
+    }));
+
+    map<const Action::Base*, pair<size_t, size_t>> intervals = get_intervals(recorder.events);
+
+    BOOST_REQUIRE_EQUAL(intervals.size(), impl.num_actions());
+
+    for (Actiongraph::Impl::vertex_descriptor vertex : impl.vertices())
+    {
+	const Action::Base* action = impl[vertex];
+
+	// Every action has finished.
+
+	BOOST_CHECK_LT(intervals[action].second, recorder.events.size());
+
+	// An action only starts once all its parents have finished.
+
+	for (Actiongraph::Impl::vertex_descriptor parent : impl.parents(vertex))
+	    BOOST_CHECK_LT(intervals[impl[parent]].second, intervals[action].first);
+    }
+
+    // Actions that overlap are both concurrent and do not share a root
+    // device.
+
+    for (const auto& lhs : intervals)
+    {
+	for (const auto& rhs : intervals)
+	{
+	    if (lhs.first == rhs.first)
+		continue;
+
+	    if (lhs.second.first > rhs.second.second || rhs.second.first > lhs.second.second)
+		continue;
+
+	    BOOST_CHECK(impl.is_concurrent(lhs.first));
+	    BOOST_CHECK(impl.is_concurrent(rhs.first));
+
+	    set<sid_t> common;
+	    set<sid_t> lhs_sids = impl.exclusive_sids(lhs.first);
+	    set<sid_t> rhs_sids = impl.exclusive_sids(rhs.first);
+	    set_intersection(lhs_sids.begin(), lhs_sids.end(), rhs_sids.begin(), rhs_sids.end(),
+			     inserter(common, common.end()));
+	    BOOST_CHECK(common.empty());
+	}
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(parallel_commit_aborted)
+{
+    setenv("LIBSTORAGE_COMMIT_THREADS", "4", 1);
+
+    set_logger(get_stdout_logger());
+
+    set_commands();
+
+    // Creating the partition /dev/sda1 fails and the user aborts.
+
+    Mockup::erase_command(PARTED_BIN " --script /dev/sda unit s mkpart '' ext2 2048 2099199");
+
+    Environment environment(true, ProbeMode::NONE, TargetMode::DIRECT);
+
+    Storage storage(environment);
+
+    const Actiongraph* actiongraph = setup(storage);
+    const Actiongraph::Impl& impl = actiongraph->get_impl();
+
+    Recorder recorder(true);
+
+    CommitOptions commit_options(false);
+    BOOST_CHECK_THROW(storage.commit(commit_options, &recorder), Aborted);
+
+    // No action is started after the error and the running actions have
+    // finished.
+
+    size_t errors = 0;
+    for (const Recorder::Event& event : recorder.events)
+    {
+	if (event.type == Recorder::ERROR)
+	    ++errors;
+	else if (event.type == Recorder::BEGIN)
+	    BOOST_CHECK_EQUAL(errors, 0);
+    }
+
+    BOOST_CHECK_EQUAL(errors, 1);
+
+    map<const Action::Base*, pair<size_t, size_t>> intervals = get_intervals(recorder.events);
+
+    for (const auto& interval : intervals)
+	BOOST_CHECK_LT(interval.second.second, recorder.events.size());
+
+    BOOST_CHECK_LT(intervals.size(), impl.num_actions());
+}
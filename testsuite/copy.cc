@@ -17,6 +17,7 @@
 #include "storage/Environment.h"
 #include "storage/Storage.h"
 #include "storage/Devicegraph.h"
+#include "storage/DevicegraphImpl.h"
 
 
 using namespace storage;
@@ -59,3 +60,152 @@ BOOST_AUTO_TEST_CASE(copy)
 
     devicegraph_copy->check();
 }
+
+
+BOOST_AUTO_TEST_CASE(copy_on_write)
+{
+    Environment environment(true, ProbeMode::NONE, TargetMode::DIRECT);
+
+    Storage storage(environment);
+
+    Devicegraph* devicegraph = storage.get_staging();
+
+    Disk* sda = Disk::create(devicegraph, "/dev/sda", Region(0, 1000000, 512));
+    Ext4::create(devicegraph);
+
+    Devicegraph* copy1 = storage.copy_devicegraph("staging", "copy1");
+    Devicegraph* copy2 = storage.copy_devicegraph("staging", "copy2");
+
+    // modifying a device of the source must not change the copies
+
+    sda->set_region(Region(0, 2000000, 512));
+
+    BOOST_CHECK_EQUAL(Disk::find_by_name(copy1, "/dev/sda")->get_region().get_length(), 1000000);
+    BOOST_CHECK_EQUAL(Disk::find_by_name(copy2, "/dev/sda")->get_region().get_length(), 1000000);
+
+    // modifying a copy must not change the source or the other copy
+
+    Disk::create(copy1, "/dev/sdb");
+
+    BOOST_CHECK_EQUAL(copy1->num_devices(), 3);
+    BOOST_CHECK_EQUAL(copy2->num_devices(), 2);
+    BOOST_CHECK_EQUAL(devicegraph->num_devices(), 2);
+
+    // removing the source must keep the copies
+
+    Devicegraph* copy3 = storage.copy_devicegraph("copy1", "copy3");
+    storage.remove_devicegraph("copy1");
+
+    BOOST_CHECK_EQUAL(copy3->num_devices(), 3);
+
+    devicegraph->check();
+    copy2->check();
+    copy3->check();
+}
+
+
+BOOST_AUTO_TEST_CASE(const_access_makes_copy)
+{
+    Environment environment(true, ProbeMode::NONE, TargetMode::DIRECT);
+
+    Storage storage(environment);
+
+    Devicegraph* source = storage.create_devicegraph("source");
+
+    Disk::create(source, "/dev/sda", Region(0, 1000000, 512));
+    Ext4::create(source);
+
+    storage.copy_devicegraph("source", "copy");
+
+    const Devicegraph* copy = storage.get_devicegraph("copy");
+
+    BOOST_CHECK(Devicegraph::Impl::is_deferred_copy(*copy));
+
+    // devices found in the copy belong to the copy
+
+    const Disk* sda = Disk::find_by_name(copy, "/dev/sda");
+
+    BOOST_CHECK(!Devicegraph::Impl::is_deferred_copy(*copy));
+
+    BOOST_CHECK_EQUAL(sda->get_devicegraph(), copy);
+    BOOST_CHECK_NE(sda, Disk::find_by_name(source, "/dev/sda"));
+
+    // modifying the source does not affect the copy
+
+    Disk::find_by_name(source, "/dev/sda")->set_region(Region(0, 2000000, 512));
+
+    BOOST_CHECK_EQUAL(sda->get_region().get_length(), 1000000);
+
+    copy->check();
+}
+
+
+BOOST_AUTO_TEST_CASE(remove_source_of_deferred_copy)
+{
+    Environment environment(true, ProbeMode::NONE, TargetMode::DIRECT);
+
+    Storage storage(environment);
+
+    Devicegraph* source = storage.create_devicegraph("source");
+
+    Disk::create(source, "/dev/sda", Region(0, 1000000, 512));
+    Ext4::create(source);
+
+    storage.copy_devicegraph("source", "copy");
+
+    const Devicegraph* copy = storage.get_devicegraph("copy");
+
+    // removing the source hands its content over to the copy
+
+    storage.remove_devicegraph("source");
+
+    BOOST_CHECK(!Devicegraph::Impl::is_deferred_copy(*copy));
+
+    const Disk* sda = Disk::find_by_name(copy, "/dev/sda");
+
+    BOOST_CHECK_EQUAL(sda->get_devicegraph(), copy);
+    BOOST_CHECK_EQUAL(sda->get_region().get_length(), 1000000);
+    BOOST_CHECK_EQUAL(copy->num_devices(), 2);
+
+    copy->check();
+}
+
+
+BOOST_AUTO_TEST_CASE(probed_and_system)
+{
+    Environment environment(true, ProbeMode::NONE, TargetMode::DIRECT);
+
+    Storage storage(environment);
+
+    Devicegraph* system = storage.get_system();
+
+    Disk::create(system, "/dev/sda", Region(0, 1000000, 512));
+    Ext4::create(system);
+
+    storage.remove_devicegraph("probed");
+    storage.copy_devicegraph("system", "probed");
+
+    const Devicegraph* probed = storage.get_probed();
+
+    const Disk* sda = Disk::find_by_name(probed, "/dev/sda");
+
+    BOOST_CHECK_EQUAL(sda->get_devicegraph(), probed);
+
+    BOOST_CHECK(sda->get_devicegraph()->get_impl().is_probed());
+    BOOST_CHECK(!sda->get_devicegraph()->get_impl().is_system());
+
+    BOOST_CHECK(probed->get_impl().is_probed());
+    BOOST_CHECK(!probed->get_impl().is_system());
+
+    // pointers obtained from probed stay valid and unchanged when system
+    // is modified
+
+    Disk::find_by_name(system, "/dev/sda")->set_region(Region(0, 2000000, 512));
+
+    BOOST_CHECK_EQUAL(sda->get_devicegraph(), probed);
+    BOOST_CHECK_EQUAL(sda->get_region().get_length(), 1000000);
+    BOOST_CHECK_EQUAL(Disk::find_by_name(system, "/dev/sda")->get_region().get_length(), 2000000);
+
+    probed->check();
+    system->check();
+}
@@ -9,6 +9,8 @@
 #include "storage/Filesystems/Ext4.h"
 #include "storage/Filesystems/Nfs.h"
 #include "storage/Filesystems/MountableImpl.h"
+#include "storage/Utils/Remote.h"
+#include "storage/Utils/StorageDefines.h"
 #include "storage/Environment.h"
 #include "storage/Storage.h"
 
@@ -111,3 +113,103 @@ BOOST_AUTO_TEST_CASE(find_vertex)
 	BOOST_CHECK_EQUAL(ensure_mounted.get_any_mount_point(), "/test3");
     }
 }
+
+
+/**
+ * Counts the mount commands. All commands succeed without output.
+ */
+class MountCounter : public RemoteCallbacksV2
+{
+public:
+
+    virtual RemoteCommand get_command(const string& name) const override { return RemoteCommand(); }
+
+    virtual RemoteFile get_file(const string& name) const override { return RemoteFile(); }
+
+    virtual RemoteCommand get_command_v2(const vector<string>& args) const override
+    {
+	if (args.front() == MOUNT_BIN)
+	    ++mounts;
+
+	return RemoteCommand();
+    }
+
+    mutable int mounts = 0;
+
+};
+
+
+BOOST_AUTO_TEST_CASE(shared_tmp_mount)
+{
+    set_logger(get_stdout_logger());
+
+    Environment environment(true, ProbeMode::NONE, TargetMode::DIRECT);
+
+    Storage storage(environment);
+
+    Devicegraph* staging = storage.get_staging();
+
+    // A device that exists so that waiting for the device returns
+    // immediately.
+
+    Disk* disk = Disk::create(staging, "/dev/null", Region(0, 2097152, 512));
+    BlkFilesystem* blk_filesystem = disk->create_blk_filesystem(FsType::EXT4);
+
+    storage.remove_devicegraph("system");
+    storage.copy_devicegraph("staging", "system");
+
+    MountCounter mount_counter;
+    set_remote_callbacks(&mount_counter);
+
+    {
+	EnsureMounted ensure_mounted1(blk_filesystem);
+
+	BOOST_CHECK_EQUAL(mount_counter.mounts, 1);
+
+	{
+	    // The read-only mount is reused for read-only.
+
+	    EnsureMounted ensure_mounted2(blk_filesystem);
+
+	    BOOST_CHECK_EQUAL(mount_counter.mounts, 1);
+	    BOOST_CHECK_EQUAL(ensure_mounted2.get_any_mount_point(), ensure_mounted1.get_any_mount_point());
+	}
+
+	{
+	    // The read-only mount is not reused for read-write.
+
+	    EnsureMounted ensure_mounted2(blk_filesystem, false);
+
+	    BOOST_CHECK_EQUAL(mount_counter.mounts, 2);
+	    BOOST_CHECK_NE(ensure_mounted2.get_any_mount_point(), ensure_mounted1.get_any_mount_point());
+	}
+
+	{
+	    // The read-write mount did not replace the read-only mount.
+
+	    EnsureMounted ensure_mounted2(blk_filesystem);
+
+	    BOOST_CHECK_EQUAL(mount_counter.mounts, 2);
+	    BOOST_CHECK_EQUAL(ensure_mounted2.get_any_mount_point(), ensure_mounted1.get_any_mount_point());
+	}
+    }
+
+    {
+	// The destructor removed the shared mount so a new one is needed.
+
+	EnsureMounted ensure_mounted1(blk_filesystem, false);
+
+	BOOST_CHECK_EQUAL(mount_counter.mounts, 3);
+
+	{
+	    // The read-write mount is reused for read-only.
+
+	    EnsureMounted ensure_mounted2(blk_filesystem);
+
+	    BOOST_CHECK_EQUAL(mount_counter.mounts, 3);
+	    BOOST_CHECK_EQUAL(ensure_mounted2.get_any_mount_point(), ensure_mounted1.get_any_mount_point());
+	}
+    }
+
+    set_remote_callbacks(nullptr);
+}
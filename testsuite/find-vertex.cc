@@ -7,6 +7,7 @@
 #include "storage/Devices/DiskImpl.h"
 #include "storage/Devices/Gpt.h"
 #include "storage/Devices/PartitionImpl.h"
+#include "storage/Devices/LvmPvImpl.h"
 #include "storage/Holders/Subdevice.h"
 #include "storage/Environment.h"
 #include "storage/Storage.h"
@@ -93,3 +94,145 @@ BOOST_AUTO_TEST_CASE(find_vertex)
 
     BOOST_CHECK_THROW(BlkDevice::find_by_any_name(system, "/dev/does-not-exist", system_info), DeviceNotFound);
 }
+
+
+BOOST_AUTO_TEST_CASE(find_vertex_after_modifications)
+{
+    set_logger(get_stdout_logger());
+
+    Environment environment(true, ProbeMode::NONE, TargetMode::DIRECT);
+
+    Storage storage(environment);
+
+    Devicegraph* staging = storage.get_staging();
+
+    Disk* sda = Disk::create(staging, "/dev/sda");
+    Disk* sdb = Disk::create(staging, "/dev/sdb");
+
+    Gpt* gpt = to_gpt(sda->create_partition_table(PtType::GPT));
+    Partition* sda1 = gpt->create_partition("/dev/sda1", Region(2048, 1000000, 512), PartitionType::PRIMARY);
+
+    const sid_t sda_sid = sda->get_sid();
+    const sid_t sdb_sid = sdb->get_sid();
+    const sid_t gpt_sid = gpt->get_sid();
+    const sid_t sda1_sid = sda1->get_sid();
+
+    BOOST_CHECK(staging->holder_exists(sda_sid, gpt_sid));
+    BOOST_CHECK(!staging->holder_exists(sdb_sid, gpt_sid));
+
+    // Moving a holder updates the holder lookup.
+
+    staging->find_holder(sda_sid, gpt_sid)->set_source(sdb);
+
+    BOOST_CHECK(!staging->holder_exists(sda_sid, gpt_sid));
+    BOOST_CHECK(staging->holder_exists(sdb_sid, gpt_sid));
+    BOOST_CHECK_EQUAL(staging->find_holders(sdb_sid, gpt_sid).size(), 1);
+
+    // Copies have their own lookup.
+
+    storage.copy_devicegraph("staging", "copy");
+    Devicegraph* copy = storage.get_devicegraph("copy");
+
+    BOOST_CHECK_EQUAL(copy->find_device(sda1_sid)->get_sid(), sda1_sid);
+    BOOST_CHECK_NE(copy->find_device(sda1_sid), sda1);
+    BOOST_CHECK(copy->holder_exists(gpt_sid, sda1_sid));
+
+    // Removing a device removes the device and its holders from the lookup.
+
+    staging->remove_device(gpt);
+
+    BOOST_CHECK(!staging->device_exists(gpt_sid));
+    BOOST_CHECK_THROW(staging->find_device(gpt_sid), DeviceNotFound);
+    BOOST_CHECK(!staging->holder_exists(sdb_sid, gpt_sid));
+    BOOST_CHECK(!staging->holder_exists(gpt_sid, sda1_sid));
+    BOOST_CHECK(staging->device_exists(sda1_sid));
+
+    BOOST_CHECK(copy->device_exists(gpt_sid));
+    BOOST_CHECK(copy->holder_exists(sdb_sid, gpt_sid));
+
+    // Clearing removes everything from the lookup.
+
+    copy->clear();
+
+    BOOST_CHECK(!copy->device_exists(sda_sid));
+    BOOST_CHECK(!copy->holder_exists(gpt_sid, sda1_sid));
+}
+
+
+BOOST_AUTO_TEST_CASE(find_by_name_after_modifications)
+{
+    set_logger(get_stdout_logger());
+
+    Environment environment(true, ProbeMode::NONE, TargetMode::DIRECT);
+
+    Storage storage(environment);
+
+    Devicegraph* staging = storage.get_staging();
+
+    Disk* sda = Disk::create(staging, "/dev/sda");
+    Disk* sdb = Disk::create(staging, "/dev/sdb");
+
+    BOOST_CHECK_EQUAL(BlkDevice::find_by_name(staging, "/dev/sda"), sda);
+    BOOST_CHECK_THROW(BlkDevice::find_by_name(staging, "/dev/sdc"), DeviceNotFound);
+
+    // Devices created after a lookup are found.
+
+    Gpt* gpt = to_gpt(sda->create_partition_table(PtType::GPT));
+    Partition* sda1 = gpt->create_partition("/dev/sda1", Region(2048, 1000000, 512), PartitionType::PRIMARY);
+
+    BOOST_CHECK_EQUAL(BlkDevice::find_by_name(staging, "/dev/sda1"), sda1);
+
+    // Renamed devices are found by the new name only.
+
+    sda->set_name("/dev/sdc");
+
+    BOOST_CHECK_EQUAL(BlkDevice::find_by_name(staging, "/dev/sdc"), sda);
+    BOOST_CHECK_THROW(BlkDevice::find_by_name(staging, "/dev/sda"), DeviceNotFound);
+
+    // Moving the partition table renames the partitions.
+
+    staging->find_holder(sda->get_sid(), gpt->get_sid())->set_source(sdb);
+
+    BOOST_CHECK_EQUAL(BlkDevice::find_by_name(staging, "/dev/sdb1"), sda1);
+    BOOST_CHECK_THROW(BlkDevice::find_by_name(staging, "/dev/sda1"), DeviceNotFound);
+
+    // Removed devices are not found.
+
+    staging->remove_device(sdb);
+
+    BOOST_CHECK_THROW(BlkDevice::find_by_name(staging, "/dev/sdb"), DeviceNotFound);
+    BOOST_CHECK_EQUAL(BlkDevice::find_by_name(staging, "/dev/sdb1"), sda1);
+}
+
+
+BOOST_AUTO_TEST_CASE(find_by_uuid_in_graph_order)
+{
+    set_logger(get_stdout_logger());
+
+    Environment environment(true, ProbeMode::NONE, TargetMode::DIRECT);
+
+    Storage storage(environment);
+
+    Devicegraph* staging = storage.get_staging();
+
+    LvmPv* lvm_pv1 = LvmPv::create(staging);
+    LvmPv* lvm_pv2 = LvmPv::create(staging);
+    LvmPv* lvm_pv3 = LvmPv::create(staging);
+
+    // Build the index before setting the UUIDs.
+
+    BOOST_CHECK_THROW(LvmPv::Impl::find_by_uuid(staging, "same"), DeviceNotFound);
+
+    // The first device in the graph is found no matter in which order the
+    // devices got the UUID.
+
+    lvm_pv3->get_impl().set_uuid("same");
+    lvm_pv2->get_impl().set_uuid("same");
+    lvm_pv1->get_impl().set_uuid("same");
+
+    BOOST_CHECK_EQUAL(LvmPv::Impl::find_by_uuid(staging, "same"), lvm_pv1);
+
+    lvm_pv1->get_impl().set_uuid("other");
+
+    BOOST_CHECK_EQUAL(LvmPv::Impl::find_by_uuid(staging, "same"), lvm_pv2);
+}
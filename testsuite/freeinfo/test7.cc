@@ -0,0 +1,51 @@
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <boost/test/unit_test.hpp>
+
+#include "storage/Utils/HumanString.h"
+#include "storage/Utils/Logger.h"
+#include "storage/Environment.h"
+#include "storage/Storage.h"
+#include "storage/Devicegraph.h"
+#include "storage/Filesystems/BlkFilesystem.h"
+#include "storage/Devices/Partition.h"
+#include "storage/FreeInfo.h"
+
+
+using namespace storage;
+
+
+/**
+ * Check that detecting all infos at once keeps the cached Resize- and
+ * ContentInfo and does not need to access the disk for them.
+ */
+BOOST_AUTO_TEST_CASE(detect_all)
+{
+    set_logger(get_stdout_logger());
+
+    Environment environment(true, ProbeMode::READ_DEVICEGRAPH, TargetMode::DIRECT);
+    environment.set_devicegraph_filename("test1-devicegraph.xml");
+
+    Storage storage(environment);
+    storage.probe();
+    storage.check();
+
+    const Devicegraph* staging = storage.get_staging();
+
+    BOOST_CHECK_NO_THROW(BlkFilesystem::detect_all_infos(staging, DI_RESIZE_INFO | DI_CONTENT_INFO));
+
+    const Partition* partition = Partition::find_by_name(staging, "/dev/sdb1");
+    const BlkFilesystem* blk_filesystem = partition->get_blk_filesystem();
+
+    ResizeInfo resize_info = blk_filesystem->detect_resize_info();
+    BOOST_CHECK_EQUAL(resize_info.resize_ok, true);
+    BOOST_CHECK_EQUAL(resize_info.min_size, 1 * MiB);
+    BOOST_CHECK_EQUAL(resize_info.max_size, 2000000 * KiB);
+
+    ContentInfo content_info = blk_filesystem->detect_content_info();
+    BOOST_CHECK_EQUAL(content_info.is_windows, true);
+    BOOST_CHECK_EQUAL(content_info.is_efi, true);
+    BOOST_CHECK_EQUAL(content_info.num_homes, 2);
+}
@@ -0,0 +1,94 @@
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <boost/test/unit_test.hpp>
+
+#include <mutex>
+#include <set>
+
+#include "storage/Utils/Logger.h"
+#include "storage/Utils/Remote.h"
+#include "storage/Utils/StorageDefines.h"
+#include "storage/Environment.h"
+#include "storage/Storage.h"
+#include "storage/Devicegraph.h"
+#include "storage/Devices/Disk.h"
+#include "storage/Filesystems/BlkFilesystem.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+/**
+ * Records the mount commands. All commands succeed without output.
+ */
+class MountRecorder : public RemoteCallbacksV2
+{
+public:
+
+    virtual RemoteCommand get_command(const string& name) const override { return RemoteCommand(); }
+
+    virtual RemoteFile get_file(const string& name) const override { return RemoteFile(); }
+
+    virtual RemoteCommand get_command_v2(const vector<string>& args) const override
+    {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (args.front() == MOUNT_BIN)
+	    mounts.push_back(args);
+
+	return RemoteCommand();
+    }
+
+    mutable std::mutex mutex;
+
+    mutable vector<vector<string>> mounts;
+
+};
+
+
+/**
+ * Check that detecting all infos mounts each filesystem only once.
+ */
+BOOST_AUTO_TEST_CASE(detect_all_mount_once)
+{
+    set_logger(get_stdout_logger());
+
+    Environment environment(true, ProbeMode::NONE, TargetMode::DIRECT);
+
+    Storage storage(environment);
+
+    Devicegraph* staging = storage.get_staging();
+
+    // Devices that exist so that waiting for the devices returns
+    // immediately.
+
+    for (const char* name : { "/dev/null", "/dev/zero" })
+    {
+	Disk* disk = Disk::create(staging, name, Region(0, 2097152, 512));
+	disk->create_blk_filesystem(FsType::EXT4);
+    }
+
+    storage.remove_devicegraph("system");
+    storage.copy_devicegraph("staging", "system");
+
+    MountRecorder mount_recorder;
+    set_remote_callbacks(&mount_recorder);
+
+    BlkFilesystem::detect_all_infos(staging, DI_RESIZE_INFO | DI_CONTENT_INFO | DI_SPACE_INFO);
+
+    set_remote_callbacks(nullptr);
+
+    BOOST_REQUIRE_EQUAL(mount_recorder.mounts.size(), 2);
+
+    set<string> names;
+    for (const vector<string>& mount : mount_recorder.mounts)
+    {
+	BOOST_CHECK(find(mount.begin(), mount.end(), "--read-only") != mount.end());
+	names.insert(mount[mount.size() - 2]);
+    }
+
+    BOOST_CHECK(names == set<string>({ "/dev/null", "/dev/zero" }));
+}
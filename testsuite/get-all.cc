@@ -0,0 +1,87 @@
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <boost/test/unit_test.hpp>
+
+#include "storage/Devices/Disk.h"
+#include "storage/Devices/Gpt.h"
+#include "storage/Devices/Md.h"
+#include "storage/Devices/Partitionable.h"
+#include "storage/Devices/BlkDevice.h"
+#include "storage/Environment.h"
+#include "storage/Storage.h"
+#include "storage/Devicegraph.h"
+#include "storage/Utils/HumanString.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+vector<string>
+names(const vector<const Partitionable*>& partitionables)
+{
+    vector<string> ret;
+
+    for (const Partitionable* partitionable : partitionables)
+	ret.push_back(partitionable->get_name());
+
+    return ret;
+}
+
+
+BOOST_AUTO_TEST_CASE(class_hierarchy)
+{
+    set_logger(get_stdout_logger());
+
+    Environment environment(true, ProbeMode::NONE, TargetMode::DIRECT);
+
+    Storage storage(environment);
+
+    Devicegraph* staging = storage.get_staging();
+
+    Disk* sda = Disk::create(staging, "/dev/sda", 16 * GiB);
+    Md::create(staging, "/dev/md0");
+    Disk::create(staging, "/dev/sdb", 16 * GiB);
+
+    // the type index is built here
+
+    BOOST_CHECK_EQUAL(Disk::get_all(staging).size(), 2);
+    BOOST_CHECK_EQUAL(Md::get_all(staging).size(), 1);
+    BOOST_CHECK_EQUAL(Gpt::get_all(staging).size(), 0);
+    BOOST_CHECK_EQUAL(BlkDevice::get_all(staging).size(), 3);
+
+    const Devicegraph* tmp = staging;
+    BOOST_CHECK(names(Partitionable::get_all(tmp)) == vector<string>({ "/dev/sda", "/dev/md0", "/dev/sdb" }));
+
+    // and maintained here
+
+    Gpt* gpt = to_gpt(sda->create_partition_table(PtType::GPT));
+    gpt->create_partition("/dev/sda1", Region(2048, 1000000, 512), PartitionType::PRIMARY);
+    gpt->create_partition("/dev/sda2", Region(1002048, 1000000, 512), PartitionType::PRIMARY);
+
+    Disk::create(staging, "/dev/sdc", 16 * GiB);
+
+    BOOST_CHECK_EQUAL(Gpt::get_all(staging).size(), 1);
+    BOOST_CHECK_EQUAL(BlkDevice::get_all(staging).size(), 6);
+    BOOST_CHECK(names(Partitionable::get_all(tmp)) == vector<string>({ "/dev/sda", "/dev/md0", "/dev/sdb",
+		"/dev/sdc" }));
+
+    staging->remove_device(Md::find_by_name(staging, "/dev/md0"));
+    sda->remove_descendants(View::REMOVE);
+
+    BOOST_CHECK_EQUAL(Gpt::get_all(staging).size(), 0);
+    BOOST_CHECK_EQUAL(BlkDevice::get_all(staging).size(), 3);
+    BOOST_CHECK(names(Partitionable::get_all(tmp)) == vector<string>({ "/dev/sda", "/dev/sdb", "/dev/sdc" }));
+
+    // copies have their own type index
+
+    Devicegraph copy(&storage);
+    staging->copy(copy);
+
+    Disk::create(staging, "/dev/sdd", 16 * GiB);
+
+    BOOST_CHECK_EQUAL(Disk::get_all(staging).size(), 4);
+    BOOST_CHECK_EQUAL(Disk::get_all(&copy).size(), 3);
+}
@@ -0,0 +1,82 @@
+
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <string.h>
+#include <algorithm>
+#include <stdexcept>
+
+#include "testsuite/helpers/Image.h"
+
+
+namespace storage
+{
+
+    Image::Image(const string& prefix, unsigned long long size)
+	: size(size)
+    {
+	string tmp = "/tmp/" + prefix + "-XXXXXX";
+
+	int fd = mkstemp(&tmp[0]);
+	if (fd < 0)
+	    throw runtime_error("mkstemp failed");
+
+	close(fd);
+
+	name = tmp;
+    }
+
+
+    Image::~Image()
+    {
+	unlink(name.c_str());
+    }
+
+
+    uint8_t*
+    Image::at(unsigned long long offset, size_t length)
+    {
+	const unsigned long long chunk = offset / chunk_size;
+
+	if (offset + length > size || (offset + length - 1) / chunk_size != chunk)
+	    throw runtime_error("invalid range for image");
+
+	vector<uint8_t>& data = chunks[chunk];
+	data.resize(chunk_size);
+
+	return data.data() + offset % chunk_size;
+    }
+
+
+    void
+    Image::put(unsigned long long offset, const char* s, size_t length)
+    {
+	memcpy(at(offset, length), s, length);
+    }
+
+
+    void
+    Image::write() const
+    {
+	int fd = open(name.c_str(), O_WRONLY | O_TRUNC | O_CLOEXEC);
+	if (fd < 0)
+	    throw runtime_error("open failed");
+
+	bool ok = ftruncate(fd, size) == 0;
+
+	for (const map<unsigned long long, vector<uint8_t>>::value_type& tmp : chunks)
+	{
+	    const unsigned long long offset = tmp.first * chunk_size;
+	    const size_t length = min(chunk_size, size - offset);
+
+	    ok = ok && pwrite(fd, tmp.second.data(), length, offset) == (ssize_t)(length);
+	}
+
+	close(fd);
+
+	if (!ok)
+	    throw runtime_error("write failed");
+    }
+
+}
@@ -0,0 +1,77 @@
+
+
+#include <string>
+#include <vector>
+#include <map>
+#include <stdint.h>
+
+
+namespace storage
+{
+    using namespace std;
+
+
+    /*
+     * A disk image in a temporary file for testing code that reads from
+     * block devices. Only the touched chunks of the image are kept in memory,
+     * the rest reads as zeros. The file is written by write() and removed
+     * by the destructor.
+     */
+    class Image
+    {
+    public:
+
+	Image(const string& prefix, unsigned long long size);
+	~Image();
+
+	const string& get_name() const { return name; }
+
+	/*
+	 * Returns a pointer to length bytes at offset. The range must not
+	 * cross a multiple of chunk_size.
+	 */
+	uint8_t* at(unsigned long long offset, size_t length);
+
+	uint8_t* sector(unsigned long long n) { return at(n * 512, 512); }
+
+	void put(unsigned long long offset, const char* s, size_t length);
+	void put(unsigned long long offset, const string& s) { put(offset, s.data(), s.size()); }
+
+	void write() const;
+
+	static constexpr unsigned long long chunk_size = 1024 * 1024;
+
+    private:
+
+	string name;
+
+	const unsigned long long size;
+
+	map<unsigned long long, vector<uint8_t>> chunks;
+
+    };
+
+
+    /*
+     * Store the lowest bytes of v at p in little respectively big endian.
+     */
+
+    inline void
+    put_le(uint8_t* p, uint64_t v, int bytes)
+    {
+	for (int i = 0; i < bytes; ++i)
+	    p[i] = v >> (8 * i);
+    }
+
+    inline void
+    put_be(uint8_t* p, uint64_t v, int bytes)
+    {
+	for (int i = 0; i < bytes; ++i)
+	    p[i] = v >> (8 * (bytes - 1 - i));
+    }
+
+    inline void put_le16(uint8_t* p, uint16_t v) { put_le(p, v, 2); }
+    inline void put_le32(uint8_t* p, uint32_t v) { put_le(p, v, 4); }
+    inline void put_le64(uint8_t* p, uint64_t v) { put_le(p, v, 8); }
+
+}
@@ -0,0 +1,729 @@
+
+// Benchmark for probing, copying, comparing, saving and loading
+// devicegraphs and for calculating actiongraphs with large synthetic
+// devicegraphs.
+//
+// The results are printed and, with --output, written to a json file
+// so that they can be compared across releases.
+
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <string.h>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <functional>
+#include <memory>
+#include <boost/algorithm/string/join.hpp>
+
+#include "storage/Devices/Disk.h"
+#include "storage/Devices/PartitionTable.h"
+#include "storage/Devices/Partition.h"
+#include "storage/Devices/Multipath.h"
+#include "storage/Devices/Md.h"
+#include "storage/Devices/LvmVg.h"
+#include "storage/Devices/LvmLv.h"
+#include "storage/Filesystems/BlkFilesystem.h"
+#include "storage/Filesystems/MountPoint.h"
+#include "storage/Filesystems/Btrfs.h"
+#include "storage/Filesystems/BtrfsSubvolume.h"
+#include "storage/Holders/User.h"
+#include "storage/Devicegraph.h"
+#include "storage/Actiongraph.h"
+#include "storage/Storage.h"
+#include "storage/Environment.h"
+#include "storage/Version.h"
+#include "storage/Utils/Mockup.h"
+#include "storage/Utils/StorageDefines.h"
+#include "storage/Utils/Format.h"
+#include "storage/Utils/HumanString.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+double scale = 1.0;
+string only;
+string output;
+
+
+struct Result
+{
+    Result(const string& scenario, const string& operation, size_t devices, double seconds)
+	: scenario(scenario), operation(operation), devices(devices), seconds(seconds) {}
+
+    string scenario;
+    string operation;
+    size_t devices;
+    double seconds;
+};
+
+
+vector<Result> results;
+
+
+void
+measure(const string& scenario, const string& operation, size_t devices, const std::function<void()>& func)
+{
+    const chrono::steady_clock::time_point t1 = chrono::steady_clock::now();
+
+    func();
+
+    const chrono::steady_clock::time_point t2 = chrono::steady_clock::now();
+
+    double seconds = chrono::duration<double>(t2 - t1).count();
+
+    cout << sformat("%-10s %-22s %8zu %10.3f s", scenario, operation, devices, seconds) << endl;
+
+    results.emplace_back(scenario, operation, devices, seconds);
+}
+
+
+int
+scaled(int n)
+{
+    return max(1, (int)(n * scale));
+}
+
+
+/**
+ * Kernel name of the i-th SCSI disk, e.g. sda, sdz, sdaa.
+ */
+string
+sd_name(int i)
+{
+    string ret;
+
+    for (++i; i > 0; i = (i - 1) / 26)
+	ret.insert(ret.begin(), 'a' + (i - 1) % 26);
+
+    return "sd" + ret;
+}
+
+
+Disk*
+add_disk(Devicegraph* devicegraph, int i, unsigned long long size)
+{
+    Disk* disk = Disk::create(devicegraph, "/dev/" + sd_name(i));
+    disk->set_size(size);
+
+    return disk;
+}
+
+
+/**
+ * Base class for scenarios with synthetic devicegraphs. The base
+ * devicegraph plays the role of the probed devicegraph and the target
+ * devicegraph the role of the staging devicegraph.
+ */
+class Scenario
+{
+public:
+
+    virtual ~Scenario() = default;
+
+    virtual string name() const = 0;
+
+    virtual void build_base(Devicegraph* devicegraph) const = 0;
+    virtual void build_target(Devicegraph* devicegraph) const = 0;
+
+};
+
+
+/**
+ * Disks each with four partitions with ext4.
+ */
+class DisksScenario : public Scenario
+{
+public:
+
+    virtual string name() const override { return "disks"; }
+
+    virtual void
+    build_base(Devicegraph* devicegraph) const override
+    {
+	for (int i = 0; i < scaled(1000); ++i)
+	    add_disk(devicegraph, i, 16 * GiB);
+    }
+
+    virtual void
+    build_target(Devicegraph* devicegraph) const override
+    {
+	for (Disk* disk : Disk::get_all(devicegraph))
+	{
+	    PartitionTable* gpt = disk->create_partition_table(PtType::GPT);
+
+	    for (int j = 1; j <= 4; ++j)
+	    {
+		Partition* partition = gpt->create_partition(disk->get_name() + to_string(j),
+							     Region(j * 4096, 4096, 512), PartitionType::PRIMARY);
+		partition->create_blk_filesystem(FsType::EXT4);
+	    }
+	}
+    }
+
+};
+
+
+/**
+ * Multipath devices each with four paths and with two partitions
+ * with xfs.
+ */
+class MultipathScenario : public Scenario
+{
+public:
+
+    virtual string name() const override { return "multipath"; }
+
+    virtual void
+    build_base(Devicegraph* devicegraph) const override
+    {
+	for (int i = 0; i < scaled(250); ++i)
+	{
+	    Multipath* multipath = Multipath::create(devicegraph, sformat("/dev/mapper/mpath%d", i),
+						     Region(0, 33554432, 512));
+
+	    for (int j = 0; j < 4; ++j)
+		User::create(devicegraph, add_disk(devicegraph, 4 * i + j, 16 * GiB), multipath);
+	}
+    }
+
+    virtual void
+    build_target(Devicegraph* devicegraph) const override
+    {
+	for (Multipath* multipath : Multipath::get_all(devicegraph))
+	{
+	    PartitionTable* gpt = multipath->create_partition_table(PtType::GPT);
+
+	    for (int j = 1; j <= 2; ++j)
+	    {
+		Partition* partition = gpt->create_partition(multipath->get_name() + "-part" + to_string(j),
+							     Region(j * 4096, 4096, 512), PartitionType::PRIMARY);
+		partition->create_blk_filesystem(FsType::XFS);
+	    }
+	}
+    }
+
+};
+
+
+/**
+ * RAID1 MDs each on partitions of two disks with ext4.
+ */
+class MdScenario : public Scenario
+{
+public:
+
+    virtual string name() const override { return "md"; }
+
+    virtual void
+    build_base(Devicegraph* devicegraph) const override
+    {
+	for (int i = 0; i < 2 * scaled(250); ++i)
+	{
+	    Disk* disk = add_disk(devicegraph, i, 16 * GiB);
+
+	    PartitionTable* gpt = disk->create_partition_table(PtType::GPT);
+	    gpt->create_partition(disk->get_name() + "1", Region(2048, 32768, 512), PartitionType::PRIMARY);
+	}
+    }
+
+    virtual void
+    build_target(Devicegraph* devicegraph) const override
+    {
+	for (int i = 0; i < scaled(250); ++i)
+	{
+	    Md* md = Md::create(devicegraph, sformat("/dev/md%d", i));
+	    md->set_md_level(MdLevel::RAID1);
+
+	    for (int j = 0; j < 2; ++j)
+		md->add_device(Partition::find_by_name(devicegraph, "/dev/" + sd_name(2 * i + j) + "1"));
+
+	    md->create_blk_filesystem(FsType::EXT4);
+	}
+    }
+
+};
+
+
+/**
+ * One volume group on 16 disks with thousands of logical volumes
+ * with ext4.
+ */
+class LvmScenario : public Scenario
+{
+public:
+
+    virtual string name() const override { return "lvm"; }
+
+    virtual void
+    build_base(Devicegraph* devicegraph) const override
+    {
+	for (int i = 0; i < 16; ++i)
+	    add_disk(devicegraph, i, 4 * TiB);
+    }
+
+    virtual void
+    build_target(Devicegraph* devicegraph) const override
+    {
+	LvmVg* lvm_vg = LvmVg::create(devicegraph, "benchmark");
+
+	for (Disk* disk : Disk::get_all(devicegraph))
+	    lvm_vg->add_lvm_pv(disk);
+
+	for (int i = 0; i < scaled(4000); ++i)
+	{
+	    LvmLv* lvm_lv = lvm_vg->create_lvm_lv(sformat("lv%d", i), LvType::NORMAL, 1 * GiB);
+	    lvm_lv->create_blk_filesystem(FsType::EXT4);
+	}
+    }
+
+};
+
+
+/**
+ * One btrfs with thousands of subvolumes.
+ */
+class BtrfsScenario : public Scenario
+{
+public:
+
+    virtual string name() const override { return "btrfs"; }
+
+    virtual void
+    build_base(Devicegraph* devicegraph) const override
+    {
+	add_disk(devicegraph, 0, 1 * TiB)->create_blk_filesystem(FsType::BTRFS);
+    }
+
+    virtual void
+    build_target(Devicegraph* devicegraph) const override
+    {
+	Btrfs* btrfs = Btrfs::get_all(devicegraph).front();
+	BtrfsSubvolume* top_level = btrfs->get_top_level_btrfs_subvolume();
+
+	for (int i = 0; i < scaled(4000); ++i)
+	    top_level->create_btrfs_subvolume(sformat("subvol%d", i));
+    }
+
+};
+
+
+void
+run_scenario(const Scenario& scenario)
+{
+    const string name = scenario.name();
+
+    Environment environment(true, ProbeMode::NONE, TargetMode::DIRECT);
+
+    Storage storage(environment);
+
+    Devicegraph* lhs = storage.create_devicegraph("lhs");
+    scenario.build_base(lhs);
+
+    Devicegraph* rhs = nullptr;
+
+    measure(name, "build", 0, [&storage, &scenario, &rhs]() {
+	rhs = storage.copy_devicegraph("lhs", "rhs");
+	scenario.build_target(rhs);
+    });
+
+    const size_t devices = rhs->num_devices();
+
+    measure(name, "copy_devicegraph", devices, [&storage]() {
+	Devicegraph* copy = storage.copy_devicegraph("rhs", "copy");
+
+	// Copies are deferred until either side is accessed, so access
+	// the copy to include the real work in the measurement.
+	copy->get_impl();
+    });
+
+    bool equal = false;
+
+    measure(name, "equal_devicegraph", devices, [&storage, &equal]() {
+	equal = storage.equal_devicegraph("rhs", "copy");
+    });
+
+    if (!equal)
+	throw runtime_error("copied devicegraph not equal");
+
+    unique_ptr<Actiongraph> actiongraph;
+
+    measure(name, "calculate_actiongraph", devices, [&storage, &lhs, &rhs, &actiongraph]() {
+	actiongraph.reset(new Actiongraph(storage, lhs, rhs));
+    });
+
+    measure(name, "compound_actions", devices, [&actiongraph]() {
+	actiongraph->generate_compound_actions();
+	actiongraph->get_compound_actions();
+    });
+
+    const string filename = sformat("benchmark-%s-devicegraph.xml", name);
+
+    measure(name, "save", devices, [&rhs, &filename]() {
+	rhs->save(filename);
+    });
+
+    measure(name, "load", devices, [&storage, &filename]() {
+	storage.create_devicegraph("loaded")->load(filename);
+    });
+
+    unlink(filename.c_str());
+}
+
+
+/**
+ * Calculates the actiongraph for n disks getting a partition table with
+ * two partitions each. The first partition gets ext4 mounted below /data,
+ * for every tenth disk the second partition gets swap. Returns the number
+ * of devices and the time in seconds.
+ */
+pair<size_t, double>
+calculate_scaling(int n)
+{
+    Environment environment(true, ProbeMode::NONE, TargetMode::DIRECT);
+
+    Storage storage(environment);
+
+    Devicegraph* lhs = storage.create_devicegraph("lhs");
+
+    for (int i = 0; i < n; ++i)
+	add_disk(lhs, i, 16 * GiB);
+
+    Devicegraph* rhs = storage.copy_devicegraph("lhs", "rhs");
+
+    for (int i = 0; i < n; ++i)
+    {
+	Disk* disk = Disk::find_by_name(rhs, "/dev/" + sd_name(i));
+
+	PartitionTable* gpt = disk->create_partition_table(PtType::GPT);
+
+	Partition* partition1 = gpt->create_partition(disk->get_name() + "1", Region(2048, 32768, 512),
+						      PartitionType::PRIMARY);
+	BlkFilesystem* ext4 = partition1->create_blk_filesystem(FsType::EXT4);
+	ext4->create_mount_point("/data/" + sd_name(i));
+
+	Partition* partition2 = gpt->create_partition(disk->get_name() + "2", Region(34816, 32768, 512),
+						      PartitionType::PRIMARY);
+	if (i % 10 == 0)
+	{
+	    BlkFilesystem* swap = partition2->create_blk_filesystem(FsType::SWAP);
+	    swap->create_mount_point("swap");
+	}
+    }
+
+    const size_t devices = rhs->num_devices();
+
+    measure("scaling", "calculate_actiongraph", devices, [&storage, &lhs, &rhs]() {
+	Actiongraph actiongraph(storage, lhs, rhs);
+    });
+
+    return make_pair(devices, results.back().seconds);
+}
+
+
+/**
+ * Calculates actiongraphs for four times the devices and reports whether
+ * the time grows roughly linearly.
+ */
+void
+run_scaling()
+{
+    const pair<size_t, double> small = calculate_scaling(scaled(500));
+    const pair<size_t, double> large = calculate_scaling(scaled(2000));
+
+    const double device_ratio = (double)(large.first) / small.first;
+    const double time_ratio = large.second / small.second;
+
+    cout << sformat("%-10s %-22s %8.1f %10.1f x", "scaling", "ratio", device_ratio, time_ratio) << endl;
+
+    // The time may grow at most twice as fast as the number of devices,
+    // quadratic growth would be four times as fast. Only reported since
+    // timings depend on the machine.
+
+    if (large.second > 2.0 * device_ratio * small.second + 0.05)
+	cerr << "warning: calculating the actiongraph does not scale linearly" << endl;
+}
+
+
+vector<string> mockup_commands;
+vector<string> mockup_files;
+
+
+void
+set_command(const vector<string>& name, const vector<string>& stdout, const vector<string>& stderr = {},
+	    int exit_code = 0)
+{
+    Mockup::set_command(name, Mockup::Command(stdout, stderr, exit_code));
+    mockup_commands.push_back(boost::join(name, " "));
+}
+
+
+void
+set_file(const string& name, const vector<string>& content)
+{
+    Mockup::set_file(name, Mockup::File(content));
+    mockup_files.push_back(name);
+}
+
+
+/**
+ * Creates a mockup for disks each with a GPT with four partitions
+ * without filesystems.
+ */
+void
+create_probe_mockup(const string& filename, int n)
+{
+    const int partitions = 4;
+
+    vector<string> sys_block;
+    vector<string> lsscsi;
+
+    for (int i = 0; i < n; ++i)
+    {
+	const string name = sd_name(i);
+	const string sysfs_path = sformat("/devices/pci0000:00/0000:00:1f.2/host0/target0:0:%d/0:0:%d:0/block/%s",
+					  i, i, name);
+
+	sys_block.push_back(name);
+	lsscsi.push_back(sformat("[0:0:%d:0]    disk    sata:                           /dev/%s ", i, name));
+
+	set_command({ UDEVADM_BIN, "info", "/dev/" + name }, {
+	    "P: " + sysfs_path, "N: " + name, "S: disk/by-id/ata-BENCHMARK_" + name,
+	    "E: DEVNAME=/dev/" + name, "E: DEVPATH=" + sysfs_path, "E: DEVTYPE=disk",
+	    "E: SUBSYSTEM=block"
+	});
+
+	set_command({ STAT_BIN, "--format", "%f", "/dev/" + name }, { "61b0" });
+
+	vector<string> parted = {
+	    "{", "   \"disk\": {", "      \"path\": \"/dev/" + name + "\",", "      \"size\": \"33554432s\",",
+	    "      \"model\": \"ATA BENCHMARK\",", "      \"transport\": \"scsi\",",
+	    "      \"logical-sector-size\": 512,", "      \"physical-sector-size\": 512,",
+	    "      \"label\": \"gpt\",", "      \"max-partitions\": 128,", "      \"partitions\": ["
+	};
+
+	for (int j = 1; j <= partitions; ++j)
+	{
+	    const string partition_name = name + to_string(j);
+
+	    set_command({ UDEVADM_BIN, "info", "/dev/" + partition_name }, {
+		"P: " + sysfs_path + "/" + partition_name, "N: " + partition_name,
+		"S: disk/by-id/ata-BENCHMARK_" + name + "-part" + to_string(j),
+		"E: DEVNAME=/dev/" + partition_name, "E: DEVPATH=" + sysfs_path + "/" + partition_name,
+		"E: DEVTYPE=partition", "E: SUBSYSTEM=block"
+	    });
+
+	    set_file(SYSFS_DIR + sysfs_path + "/" + partition_name + "/alignment_offset", { "0" });
+	    set_file(SYSFS_DIR + sysfs_path + "/" + partition_name + "/ro", { "0" });
+
+	    const unsigned long long start = 2048 + (j - 1) * 2097152;
+
+	    parted.insert(parted.end(), {
+		j == 1 ? "         {" : "         },{",
+		sformat("            \"number\": %d,", j),
+		sformat("            \"start\": \"%llus\",", start),
+		sformat("            \"end\": \"%llus\",", start + 2097152 - 1),
+		"            \"size\": \"2097152s\",",
+		"            \"type\": \"primary\",",
+		"            \"type-uuid\": \"0fc63daf-8483-4772-8e79-3d69d8477de4\",",
+		"            \"name\": \"\""
+	    });
+	}
+
+	parted.insert(parted.end(), { "         }", "      ]", "   }", "}" });
+
+	set_command({ PARTED_BIN, "--script", "--json", "/dev/" + name, "unit", "s", "print" }, parted);
+
+	set_file(SYSFS_DIR + sysfs_path + "/size", { "33554432" });
+	set_file(SYSFS_DIR + sysfs_path + "/ext_range", { "256" });
+	set_file(SYSFS_DIR + sysfs_path + "/ro", { "0" });
+	set_file(SYSFS_DIR + sysfs_path + "/alignment_offset", { "0" });
+	set_file(SYSFS_DIR + sysfs_path + "/queue/rotational", { "0" });
+	set_file(SYSFS_DIR + sysfs_path + "/queue/dax", { "0" });
+	set_file(SYSFS_DIR + sysfs_path + "/queue/zoned", { "none" });
+	set_file(SYSFS_DIR + sysfs_path + "/queue/logical_block_size", { "512" });
+	set_file(SYSFS_DIR + sysfs_path + "/queue/optimal_io_size", { "0" });
+    }
+
+    set_command({ LS_BIN, "-1", "--sort=none", SYSFS_DIR "/block" }, sys_block);
+    set_command({ BLKID_BIN, "--version" }, { "blkid from util-linux 2.41.3  (libblkid 2.41.3, 15-Dec-2025)" });
+    set_command({ BLKID_BIN, "--cache-file", DEV_NULL_FILE }, {});
+    set_command({ UDEVADM_BIN_SETTLE }, {});
+    set_command({ GETCONF_BIN, "PAGESIZE" }, { "4096" });
+    set_command({ LSSCSI_BIN, "--transport" }, lsscsi);
+    set_command({ LSSCSI_BIN, "--version" }, {}, { "release: 0.32  2021/05/05 [svn: r167]" });
+    set_command({ TEST_BIN, "-d", EFIVARS_DIR }, {});
+    set_command({ UNAME_BIN, "-m" }, { "x86_64" });
+    set_command({ PARTED_BIN, "--version" }, { "parted (GNU parted) 3.5" });
+    set_command({ MULTIPATH_BIN, "-d", "-v", "2", "-ll" }, {});
+    set_command({ DMRAID_BIN, "--sets=active", "-ccc" }, { "no raid disks" }, {}, 1);
+    set_command({ DMSETUP_BIN, "table" }, {});
+
+    set_file(ETC_DIR "/fstab", {});
+    set_file(ETC_DIR "/crypttab", {});
+    set_file(PROC_DIR "/mounts", {});
+    set_file(PROC_DIR "/swaps", { "Filename				Type		Size	Used	Priority" });
+
+    Mockup::save(filename);
+
+    // The mockup must be empty when it is loaded for probing.
+
+    for (const string& name : mockup_commands)
+	Mockup::erase_command(name);
+
+    for (const string& name : mockup_files)
+	Mockup::erase_file(name);
+}
+
+
+void
+run_probe()
+{
+    const int n = scaled(1000);
+
+    const string filename = "benchmark-probe-mockup.xml";
+
+    create_probe_mockup(filename, n);
+
+    Environment environment(true, ProbeMode::READ_MOCKUP, TargetMode::DIRECT);
+    environment.set_mockup_filename(filename);
+
+    Storage storage(environment);
+
+    measure("probe", "probe", 0, [&storage]() {
+	storage.probe();
+    });
+
+    const size_t devices = storage.get_probed()->num_devices();
+
+    if (devices != (size_t)(n * 6))
+	throw runtime_error(sformat("probed %zu instead of %d devices", devices, n * 6));
+
+    unlink(filename.c_str());
+}
+
+
+void
+write_results(const string& filename)
+{
+    ofstream s(filename);
+
+    s << "{\n";
+    s << "  \"version\": \"" << get_libversion_string() << "\",\n";
+    s << "  \"scale\": " << scale << ",\n";
+    s << "  \"results\": [";
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+	const Result& result = results[i];
+
+	s << (i == 0 ? "\n" : ",\n");
+	s << "    { \"scenario\": \"" << result.scenario << "\", \"operation\": \"" << result.operation
+	  << "\", \"devices\": " << result.devices << ", \"seconds\": " << result.seconds << " }";
+    }
+
+    s << "\n  ]\n";
+    s << "}\n";
+
+    if (!s.good())
+	throw runtime_error(sformat("writing '%s' failed", filename));
+}
+
+
+void
+doit()
+{
+    set_logger(nullptr);
+
+    vector<unique_ptr<Scenario>> scenarios;
+    scenarios.emplace_back(new DisksScenario());
+    scenarios.emplace_back(new MultipathScenario());
+    scenarios.emplace_back(new MdScenario());
+    scenarios.emplace_back(new LvmScenario());
+    scenarios.emplace_back(new BtrfsScenario());
+
+    for (const unique_ptr<Scenario>& scenario : scenarios)
+    {
+	if (only.empty() || only == scenario->name())
+	    run_scenario(*scenario);
+    }
+
+    if (only.empty() || only == "probe")
+	run_probe();
+
+    if (only.empty() || only == "scaling")
+	run_scaling();
+
+    if (!output.empty())
+	write_results(output);
+}
+
+
+void
+usage()
+{
+    cerr << "benchmark [--scale scale] [--only scenario] [--output filename]\n";
+    exit(EXIT_FAILURE);
+}
+
+
+int
+main(int argc, char **argv)
+{
+    const struct option options[] = {
+	{ "scale",			required_argument,	0,	1 },
+	{ "only",			required_argument,	0,	2 },
+	{ "output",			required_argument,	0,	3 },
+	{ 0, 0, 0, 0 }
+    };
+
+    while (true)
+    {
+	int option_index = 0;
+	int c = getopt_long(argc, argv, "", options, &option_index);
+	if (c == -1)
+	    break;
+
+	if (c == '?')
+	    usage();
+
+	switch (c)
+	{
+	    case 1:
+		scale = atof(optarg);
+		if (scale <= 0.0)
+		    usage();
+		break;
+
+	    case 2:
+		only = optarg;
+		break;
+
+	    case 3:
+		output = optarg;
+		break;
+
+	    default:
+		usage();
+	}
+    }
+
+    if (optind < argc)
+	usage();
+
+    try
+    {
+	doit();
+    }
+    catch (const exception& e)
+    {
+	cerr << "exception occurred: " << e.what() << '\n';
+	exit(EXIT_FAILURE);
+    }
+
+    exit(EXIT_SUCCESS);
+}